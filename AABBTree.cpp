@@ -0,0 +1,326 @@
+#include "AABBTree.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // how far ahead along the motion a moved proxy's fat box is extended
+    const float kDisplacementMultiplier = 2.0f;
+}
+
+bool Bounds3::RayHit(float ox, float oy, float oz, float invDx, float invDy, float invDz, float maxT, float& outT) const {
+    float t0 = 0.0f, t1 = maxT;
+    float o[3] = { ox, oy, oz };
+    float inv[3] = { invDx, invDy, invDz };
+    float lo[3] = { minX, minY, minZ };
+    float hi[3] = { maxX, maxY, maxZ };
+    for (int a = 0; a < 3; ++a) {
+        if (std::isinf(inv[a])) {
+            // parallel to this slab: must already be inside it
+            if (o[a] < lo[a] || o[a] > hi[a]) return false;
+            continue;
+        }
+        float tn = (lo[a] - o[a]) * inv[a];
+        float tf = (hi[a] - o[a]) * inv[a];
+        if (tn > tf) std::swap(tn, tf);
+        if (tn > t0) t0 = tn;
+        if (tf < t1) t1 = tf;
+        if (t0 > t1) return false;
+    }
+    outT = t0;
+    return true;
+}
+
+int AABBTree::AllocateNode() {
+    if (freeList_ == kNull) {
+        nodes_.emplace_back();
+        int id = (int)nodes_.size() - 1;
+        nodes_[id].height = 0;
+        return id;
+    }
+    int id = freeList_;
+    freeList_ = nodes_[id].parent;
+    nodes_[id] = Node();
+    nodes_[id].height = 0;
+    return id;
+}
+
+void AABBTree::FreeNode(int id) {
+    nodes_[id].parent = freeList_;
+    nodes_[id].height = -1;
+    nodes_[id].child1 = kNull;
+    nodes_[id].child2 = kNull;
+    nodes_[id].userData = nullptr;
+    freeList_ = id;
+}
+
+int AABBTree::CreateProxy(const Bounds3& bounds, void* userData) {
+    int id = AllocateNode();
+    Bounds3 fat = bounds;
+    fat.minX -= margin_; fat.minY -= margin_; fat.minZ -= margin_;
+    fat.maxX += margin_; fat.maxY += margin_; fat.maxZ += margin_;
+    nodes_[id].bounds = fat;
+    nodes_[id].userData = userData;
+    InsertLeaf(id);
+    ++proxyCount_;
+    return id;
+}
+
+void AABBTree::DestroyProxy(int proxyId) {
+    if (proxyId < 0 || proxyId >= (int)nodes_.size() || !nodes_[proxyId].IsLeaf() || nodes_[proxyId].height < 0) return;
+    RemoveLeaf(proxyId);
+    FreeNode(proxyId);
+    --proxyCount_;
+}
+
+bool AABBTree::MoveProxy(int proxyId, const Bounds3& bounds, float dx, float dy, float dz) {
+    if (nodes_[proxyId].bounds.Contains(bounds)) return false;
+
+    RemoveLeaf(proxyId);
+    Bounds3 fat = bounds;
+    fat.minX -= margin_; fat.minY -= margin_; fat.minZ -= margin_;
+    fat.maxX += margin_; fat.maxY += margin_; fat.maxZ += margin_;
+    // predict further motion in the same direction
+    float px = dx * kDisplacementMultiplier, py = dy * kDisplacementMultiplier, pz = dz * kDisplacementMultiplier;
+    if (px < 0) fat.minX += px; else fat.maxX += px;
+    if (py < 0) fat.minY += py; else fat.maxY += py;
+    if (pz < 0) fat.minZ += pz; else fat.maxZ += pz;
+    nodes_[proxyId].bounds = fat;
+    InsertLeaf(proxyId);
+    return true;
+}
+
+void AABBTree::InsertLeaf(int leaf) {
+    if (root_ == kNull) {
+        root_ = leaf;
+        nodes_[root_].parent = kNull;
+        return;
+    }
+
+    // descend towards the sibling with the lowest surface-area cost
+    Bounds3 leafBounds = nodes_[leaf].bounds;
+    int index = root_;
+    while (!nodes_[index].IsLeaf()) {
+        int c1 = nodes_[index].child1;
+        int c2 = nodes_[index].child2;
+        float area = nodes_[index].bounds.SurfaceArea();
+        float combinedArea = Bounds3::Union(nodes_[index].bounds, leafBounds).SurfaceArea();
+        float cost = 2.0f * combinedArea;
+        float inheritance = 2.0f * (combinedArea - area);
+
+        auto childCost = [&](int c) {
+            float u = Bounds3::Union(leafBounds, nodes_[c].bounds).SurfaceArea();
+            if (nodes_[c].IsLeaf()) return u + inheritance;
+            return (u - nodes_[c].bounds.SurfaceArea()) + inheritance;
+        };
+        float cost1 = childCost(c1);
+        float cost2 = childCost(c2);
+        if (cost < cost1 && cost < cost2) break;
+        index = cost1 < cost2 ? c1 : c2;
+    }
+
+    int sibling = index;
+    int oldParent = nodes_[sibling].parent;
+    int newParent = AllocateNode();
+    nodes_[newParent].parent = oldParent;
+    nodes_[newParent].bounds = Bounds3::Union(leafBounds, nodes_[sibling].bounds);
+    nodes_[newParent].height = nodes_[sibling].height + 1;
+    nodes_[newParent].child1 = sibling;
+    nodes_[newParent].child2 = leaf;
+    nodes_[sibling].parent = newParent;
+    nodes_[leaf].parent = newParent;
+    if (oldParent != kNull) {
+        if (nodes_[oldParent].child1 == sibling) nodes_[oldParent].child1 = newParent;
+        else nodes_[oldParent].child2 = newParent;
+    } else {
+        root_ = newParent;
+    }
+
+    // walk back up fixing heights and bounds
+    index = nodes_[leaf].parent;
+    while (index != kNull) {
+        index = Balance(index);
+        int c1 = nodes_[index].child1;
+        int c2 = nodes_[index].child2;
+        nodes_[index].height = 1 + std::max(nodes_[c1].height, nodes_[c2].height);
+        nodes_[index].bounds = Bounds3::Union(nodes_[c1].bounds, nodes_[c2].bounds);
+        index = nodes_[index].parent;
+    }
+}
+
+void AABBTree::RemoveLeaf(int leaf) {
+    if (leaf == root_) {
+        root_ = kNull;
+        return;
+    }
+    int parent = nodes_[leaf].parent;
+    int grandParent = nodes_[parent].parent;
+    int sibling = nodes_[parent].child1 == leaf ? nodes_[parent].child2 : nodes_[parent].child1;
+
+    if (grandParent != kNull) {
+        if (nodes_[grandParent].child1 == parent) nodes_[grandParent].child1 = sibling;
+        else nodes_[grandParent].child2 = sibling;
+        nodes_[sibling].parent = grandParent;
+        FreeNode(parent);
+
+        int index = grandParent;
+        while (index != kNull) {
+            index = Balance(index);
+            int c1 = nodes_[index].child1;
+            int c2 = nodes_[index].child2;
+            nodes_[index].bounds = Bounds3::Union(nodes_[c1].bounds, nodes_[c2].bounds);
+            nodes_[index].height = 1 + std::max(nodes_[c1].height, nodes_[c2].height);
+            index = nodes_[index].parent;
+        }
+    } else {
+        root_ = sibling;
+        nodes_[sibling].parent = kNull;
+        FreeNode(parent);
+    }
+}
+
+// Rotate node `a` if its subtrees differ in height by more than one; returns the new subtree root
+int AABBTree::Balance(int iA) {
+    Node& A = nodes_[iA];
+    if (A.IsLeaf() || A.height < 2) return iA;
+
+    int iB = A.child1;
+    int iC = A.child2;
+    int balance = nodes_[iC].height - nodes_[iB].height;
+
+    auto rotateUp = [&](int iUp, int iDown, bool upIsChild2) {
+        // iUp (child of A) becomes the subtree root; its taller child stays, the shorter one moves to A
+        Node& U = nodes_[iUp];
+        int iF = U.child1;
+        int iG = U.child2;
+        U.child1 = iA;
+        U.parent = A.parent;
+        A.parent = iUp;
+        if (U.parent != kNull) {
+            if (nodes_[U.parent].child1 == iA) nodes_[U.parent].child1 = iUp;
+            else nodes_[U.parent].child2 = iUp;
+        } else {
+            root_ = iUp;
+        }
+        int keep = iF, move = iG;
+        if (nodes_[iF].height <= nodes_[iG].height) { keep = iG; move = iF; }
+        U.child2 = keep;
+        if (upIsChild2) A.child2 = move; else A.child1 = move;
+        nodes_[move].parent = iA;
+        A.bounds = Bounds3::Union(nodes_[iDown].bounds, nodes_[move].bounds);
+        U.bounds = Bounds3::Union(A.bounds, nodes_[keep].bounds);
+        A.height = 1 + std::max(nodes_[iDown].height, nodes_[move].height);
+        U.height = 1 + std::max(A.height, nodes_[keep].height);
+        return iUp;
+    };
+
+    if (balance > 1) return rotateUp(iC, iB, true);   // C is taller: rotate C up
+    if (balance < -1) return rotateUp(iB, iC, false); // B is taller: rotate B up
+    return iA;
+}
+
+void AABBTree::Rebuild() {
+    std::vector<int> leaves;
+    leaves.reserve(proxyCount_);
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        if (nodes_[i].height < 0) continue;
+        if (nodes_[i].IsLeaf()) leaves.push_back((int)i);
+        else FreeNode((int)i);
+    }
+    root_ = leaves.empty() ? kNull : BuildRange(leaves, 0, leaves.size());
+    if (root_ != kNull) nodes_[root_].parent = kNull;
+}
+
+// Median split along the widest axis of the leaf centers
+int AABBTree::BuildRange(std::vector<int>& leaves, size_t begin, size_t end) {
+    if (end - begin == 1) return leaves[begin];
+    float lo[3] = { INFINITY, INFINITY, INFINITY }, hi[3] = { -INFINITY, -INFINITY, -INFINITY };
+    for (size_t k = begin; k < end; ++k) {
+        const Bounds3& b = nodes_[leaves[k]].bounds;
+        float c[3] = { b.minX + b.maxX, b.minY + b.maxY, b.minZ + b.maxZ };
+        for (int a = 0; a < 3; ++a) { lo[a] = std::min(lo[a], c[a]); hi[a] = std::max(hi[a], c[a]); }
+    }
+    int axis = 0;
+    if (hi[1] - lo[1] > hi[axis] - lo[axis]) axis = 1;
+    if (hi[2] - lo[2] > hi[axis] - lo[axis]) axis = 2;
+    auto center = [&](int id) {
+        const Bounds3& b = nodes_[id].bounds;
+        return axis == 0 ? b.minX + b.maxX : (axis == 1 ? b.minY + b.maxY : b.minZ + b.maxZ);
+    };
+    size_t mid = begin + (end - begin) / 2;
+    std::nth_element(leaves.begin() + begin, leaves.begin() + mid, leaves.begin() + end, [&](int a, int b) {
+        return center(a) < center(b);
+    });
+    int c1 = BuildRange(leaves, begin, mid);
+    int c2 = BuildRange(leaves, mid, end);
+    int id = AllocateNode();
+    nodes_[id].child1 = c1;
+    nodes_[id].child2 = c2;
+    nodes_[id].bounds = Bounds3::Union(nodes_[c1].bounds, nodes_[c2].bounds);
+    nodes_[id].height = 1 + std::max(nodes_[c1].height, nodes_[c2].height);
+    nodes_[c1].parent = id;
+    nodes_[c2].parent = id;
+    return id;
+}
+
+void AABBTree::QueryOverlap(const Bounds3& bounds, const std::function<bool(int)>& fn) const {
+    if (root_ == kNull) return;
+    int stackBuf[256];
+    std::vector<int> overflow;
+    int sp = 0;
+    stackBuf[sp++] = root_;
+    while (sp > 0 || !overflow.empty()) {
+        int id;
+        if (!overflow.empty()) { id = overflow.back(); overflow.pop_back(); }
+        else id = stackBuf[--sp];
+        const Node& n = nodes_[id];
+        if (!n.bounds.Overlaps(bounds)) continue;
+        if (n.IsLeaf()) {
+            if (!fn(id)) return;
+            continue;
+        }
+        if (sp + 2 <= 256) { stackBuf[sp++] = n.child1; stackBuf[sp++] = n.child2; }
+        else { overflow.push_back(n.child1); overflow.push_back(n.child2); }
+    }
+}
+
+void AABBTree::RaycastInflated(float ox, float oy, float oz, float dx, float dy, float dz,
+                               float hx, float hy, float hz, float maxT, const std::function<float(int, float)>& fn) const {
+    if (root_ == kNull) return;
+    const float inf = INFINITY;
+    float invX = dx != 0.0f ? 1.0f / dx : inf;
+    float invY = dy != 0.0f ? 1.0f / dy : inf;
+    float invZ = dz != 0.0f ? 1.0f / dz : inf;
+
+    std::vector<int> stack;
+    stack.reserve(64);
+    stack.push_back(root_);
+    while (!stack.empty()) {
+        int id = stack.back();
+        stack.pop_back();
+        const Node& n = nodes_[id];
+        Bounds3 b = n.bounds;
+        b.minX -= hx; b.minY -= hy; b.minZ -= hz;
+        b.maxX += hx; b.maxY += hy; b.maxZ += hz;
+        float tEnter;
+        if (!b.RayHit(ox, oy, oz, invX, invY, invZ, maxT, tEnter)) continue;
+        if (n.IsLeaf()) {
+            float r = fn(id, maxT);
+            if (r == 0.0f) return;
+            if (r > 0.0f && r < maxT) maxT = r;
+            continue;
+        }
+        stack.push_back(n.child1);
+        stack.push_back(n.child2);
+    }
+}
+
+void AABBTree::Raycast(float ox, float oy, float oz, float dx, float dy, float dz, float maxT,
+                       const std::function<float(int, float)>& fn) const {
+    RaycastInflated(ox, oy, oz, dx, dy, dz, 0.0f, 0.0f, 0.0f, maxT, fn);
+}
+
+void AABBTree::Sweep(float ox, float oy, float oz, float hx, float hy, float hz,
+                     float dx, float dy, float dz, float maxT, const std::function<float(int, float)>& fn) const {
+    // a moving box against a node box is a ray against the node grown by the box extents
+    RaycastInflated(ox, oy, oz, dx, dy, dz, hx, hy, hz, maxT, fn);
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <vector>
+#include <functional>
+
+// Axis-aligned 3D bounds (kept independent of DxLib so it can be used by tools/headless code)
+struct Bounds3 {
+    float minX = 0, minY = 0, minZ = 0;
+    float maxX = 0, maxY = 0, maxZ = 0;
+
+    bool Overlaps(const Bounds3& o) const {
+        return minX <= o.maxX && maxX >= o.minX && minY <= o.maxY && maxY >= o.minY && minZ <= o.maxZ && maxZ >= o.minZ;
+    }
+    bool Contains(const Bounds3& o) const {
+        return minX <= o.minX && minY <= o.minY && minZ <= o.minZ && maxX >= o.maxX && maxY >= o.maxY && maxZ >= o.maxZ;
+    }
+    float SurfaceArea() const {
+        float dx = maxX - minX, dy = maxY - minY, dz = maxZ - minZ;
+        return 2.0f * (dx * dy + dy * dz + dz * dx);
+    }
+    static Bounds3 Union(const Bounds3& a, const Bounds3& b) {
+        Bounds3 r;
+        r.minX = a.minX < b.minX ? a.minX : b.minX; r.maxX = a.maxX > b.maxX ? a.maxX : b.maxX;
+        r.minY = a.minY < b.minY ? a.minY : b.minY; r.maxY = a.maxY > b.maxY ? a.maxY : b.maxY;
+        r.minZ = a.minZ < b.minZ ? a.minZ : b.minZ; r.maxZ = a.maxZ > b.maxZ ? a.maxZ : b.maxZ;
+        return r;
+    }
+    // Slab test of the ray origin + dir * t, t in [0, maxT]. Returns entry t in outT.
+    bool RayHit(float ox, float oy, float oz, float invDx, float invDy, float invDz, float maxT, float& outT) const;
+};
+
+// AABBTree: dynamic bounding-volume hierarchy (balanced binary tree of fat AABBs).
+// Proxies are stored with a margin so small movements don't touch the tree; MoveProxy only
+// re-inserts a proxy once it leaves its fat box. Inserts pick the sibling by surface-area cost
+// and the tree is kept balanced with rotations, so queries are O(log n).
+class AABBTree {
+public:
+    explicit AABBTree(float margin = 4.0f) : margin_(margin) {}
+
+    int CreateProxy(const Bounds3& bounds, void* userData);
+    void DestroyProxy(int proxyId);
+
+    // Update a proxy after its object moved by (dx, dy, dz). Returns true if it was re-inserted.
+    bool MoveProxy(int proxyId, const Bounds3& bounds, float dx = 0.0f, float dy = 0.0f, float dz = 0.0f);
+
+    void* GetUserData(int proxyId) const { return nodes_[proxyId].userData; }
+    void SetUserData(int proxyId, void* userData) { nodes_[proxyId].userData = userData; }
+    const Bounds3& GetFatBounds(int proxyId) const { return nodes_[proxyId].bounds; }
+
+    // fn(proxyId) for every proxy whose fat box overlaps `bounds`; return false to stop
+    void QueryOverlap(const Bounds3& bounds, const std::function<bool(int)>& fn) const;
+
+    // Ray from origin along dir (not necessarily normalized) for t in [0, maxT].
+    // fn(proxyId, currentMaxT) returns the new maxT: a hit distance clips the ray,
+    // currentMaxT keeps it unchanged and 0 stops the query.
+    void Raycast(float ox, float oy, float oz, float dx, float dy, float dz, float maxT,
+                 const std::function<float(int, float)>& fn) const;
+
+    // Like Raycast, for a box with the given half extents moving from its center (ox, oy, oz)
+    void Sweep(float ox, float oy, float oz, float hx, float hy, float hz,
+               float dx, float dy, float dz, float maxT, const std::function<float(int, float)>& fn) const;
+
+    // Rebuild the hierarchy top-down over the current proxies (proxy ids stay valid).
+    // Incremental inserts give a usable tree; after bulk creation this gives a much tighter one.
+    void Rebuild();
+
+    int GetHeight() const { return root_ == kNull ? 0 : nodes_[root_].height; }
+    int GetProxyCount() const { return proxyCount_; }
+
+    static const int kNull = -1;
+
+private:
+    struct Node {
+        Bounds3 bounds;
+        void* userData = nullptr;
+        int parent = kNull; // doubles as next-free link while on the free list
+        int child1 = kNull;
+        int child2 = kNull;
+        int height = -1;    // leaf = 0, free node = -1
+        bool IsLeaf() const { return child1 == kNull; }
+    };
+
+    int AllocateNode();
+    void FreeNode(int id);
+    void InsertLeaf(int leaf);
+    void RemoveLeaf(int leaf);
+    int Balance(int a);
+    int BuildRange(std::vector<int>& leaves, size_t begin, size_t end);
+    void RaycastInflated(float ox, float oy, float oz, float dx, float dy, float dz,
+                         float hx, float hy, float hz, float maxT, const std::function<float(int, float)>& fn) const;
+
+    std::vector<Node> nodes_;
+    int root_ = kNull;
+    int freeList_ = kNull;
+    int proxyCount_ = 0;
+    float margin_;
+};
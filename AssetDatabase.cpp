@@ -1,6 +1,8 @@
 #include "AssetDatabase.h"
+#ifdef _WIN32
 #include <Windows.h>
 #include <shlwapi.h>
+#endif
 #include <fstream>
 #include <sstream>
 #include <iomanip>
@@ -9,8 +11,11 @@
 #include <thread>
 #include <chrono>
 
+#ifdef _WIN32
 #pragma comment(lib, "Shlwapi.lib")
+#endif
 
+#ifdef _WIN32
 static std::string Utf16ToUtf8(const std::wstring& w) {
     int req = WideCharToMultiByte(CP_UTF8, 0, w.c_str(), -1, NULL, 0, NULL, NULL);
     if (req <= 0) return std::string();
@@ -25,12 +30,14 @@ static std::wstring Utf8ToUtf16(const std::string& s) {
     MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, &out[0], req);
     return out;
 }
+#endif
 
 AssetDatabase& AssetDatabase::Instance() {
     static AssetDatabase inst;
     return inst;
 }
 
+#ifdef _WIN32
 bool AssetDatabase::Init() {
     // create folders if missing
     CreateDirectoryW(L"Assets", NULL);
@@ -39,6 +46,11 @@ bool AssetDatabase::Init() {
     ScanAssets();
     return true;
 }
+#else
+// The folder scan, watcher and import are Win32-only; elsewhere (headless tools) the database stays
+// empty and mesh artifacts are keyed by source path instead of GUID.
+bool AssetDatabase::Init() { return false; }
+#endif
 
 std::string AssetDatabase::MakeMetaPath(const std::string& assetPath) const {
     // e.g. Assets/foo.obj -> Assets/foo.obj.meta
@@ -95,6 +107,7 @@ std::string AssetDatabase::GenerateGUID() {
     return ss.str();
 }
 
+#ifdef _WIN32
 int AssetDatabase::ScanAssets() {
     std::lock_guard<std::mutex> lk(mutex_);
     metas_.clear(); guidToPath_.clear(); deps_.clear();
@@ -217,6 +230,9 @@ int AssetDatabase::ScanAssets() {
 
     return count;
 }
+#else
+int AssetDatabase::ScanAssets() { return 0; }
+#endif
 
 std::vector<std::string> AssetDatabase::GetAllAssetPaths() const {
     std::lock_guard<std::mutex> lk(mutex_);
@@ -226,6 +242,7 @@ std::vector<std::string> AssetDatabase::GetAllAssetPaths() const {
     return out;
 }
 
+#ifdef _WIN32
 // Simple polling watcher: check every second for new/removed files and rescan
 void AssetDatabase::StartWatching() {
     if (watching_) return;
@@ -328,6 +345,11 @@ std::string AssetDatabase::ImportAsset(const std::string& srcPath) {
     guidToPath_[m.guid] = rel;
     return rel;
 }
+#else
+void AssetDatabase::StartWatching() {}
+void AssetDatabase::StopWatching() {}
+std::string AssetDatabase::ImportAsset(const std::string&) { return std::string(); }
+#endif
 
 const AssetDatabase::Meta* AssetDatabase::GetMeta(const std::string& relativePath) const {
     auto it = metas_.find(relativePath);
@@ -6,7 +6,9 @@
 #include <mutex>
 #include <thread>
 #include <atomic>
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 
 // Simple Asset Database: watches/captures files under "Assets/" and writes/reads .meta files
 // This is a minimal, synchronous implementation intended as a starting point for the engine.
@@ -63,5 +65,7 @@ private:
     mutable std::mutex mutex_;
     std::atomic<bool> watching_{false};
     std::thread watchThread_;
+#ifdef _WIN32
     HANDLE dirHandle_ = INVALID_HANDLE_VALUE;
+#endif
 };
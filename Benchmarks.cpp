@@ -0,0 +1,399 @@
+#include "Benchmarks.h"
+#include "SimdAABB.h"
+#include "ObjLoader.h"
+#include "VertexTransform.h"
+#include "Scene.h"
+#include "SoftwareRasterizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+    double MsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // stdout plus bench.txt
+    struct Report {
+        FILE* file = fopen("bench.txt", "w");
+        ~Report() { if (file) fclose(file); }
+        void Print(const char* fmt, ...) {
+            va_list args;
+            va_start(args, fmt);
+            vprintf(fmt, args);
+            va_end(args);
+            if (!file) return;
+            va_start(args, fmt);
+            vfprintf(file, fmt, args);
+            va_end(args);
+        }
+    };
+
+    // Random boxes on a small integer grid, so shared edges (the inclusive case) come up often
+    void FillRandom(SimdAABB::AABBSoA& s, size_t n, std::mt19937& rng, float grid) {
+        std::uniform_int_distribution<int> pos(0, (int)grid), ext(0, 4);
+        s.Resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            float x = (float)pos(rng), y = (float)pos(rng);
+            s.Set(i, x, y, x + (float)ext(rng), y + (float)ext(rng));
+        }
+    }
+
+    // OverlapMask8 must match OverlapMask8Scalar for every batch start, including the last batches
+    // that run into the padding; padding lanes must never report a hit.
+    bool CheckAABB(Report& r) {
+        std::mt19937 rng(1234);
+        std::uniform_int_distribution<int> pos(-2, 34), ext(0, 6);
+        const float inf = std::numeric_limits<float>::infinity();
+        size_t checked = 0, mismatches = 0, paddingHits = 0;
+        for (size_t n = 0; n <= 37; ++n) {
+            SimdAABB::AABBSoA s;
+            FillRandom(s, n, rng, 32.0f);
+            for (int q = 0; q < 200; ++q) {
+                float qx = (float)pos(rng), qy = (float)pos(rng);
+                float qMaxX = qx + (float)ext(rng), qMaxY = qy + (float)ext(rng);
+                if (q == 0) { qx = qy = -inf; qMaxX = qMaxY = inf; } // everything, padding lanes included
+                for (size_t first = 0; first < n; ++first) {
+                    uint32_t simd = SimdAABB::OverlapMask8(s, first, qx, qy, qMaxX, qMaxY);
+                    uint32_t ref = SimdAABB::OverlapMask8Scalar(s, first, qx, qy, qMaxX, qMaxY);
+                    ++checked;
+                    if (simd != ref) ++mismatches;
+                    if (first + SimdAABB::kBatch > n && (simd >> (n - first)) != 0) ++paddingHits;
+                }
+            }
+        }
+        r.Print("aabb check: %zu batches, %zu mismatches, %zu padding hits\n", checked, mismatches, paddingHits);
+        return mismatches == 0 && paddingHits == 0;
+    }
+
+    // QueryPoint over many boxes, SIMD kernel vs. the scalar reference
+    void BenchAABB(Report& r) {
+        const size_t n = 1 << 16;
+        const int queries = 2000;
+        std::mt19937 rng(42);
+        SimdAABB::AABBSoA s;
+        FillRandom(s, n, rng, 4096.0f);
+        std::uniform_real_distribution<float> pos(0.0f, 4096.0f);
+        std::vector<float> px(queries), py(queries);
+        for (int q = 0; q < queries; ++q) { px[q] = pos(rng); py[q] = pos(rng); }
+
+        size_t hitsSimd = 0, hitsScalar = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int q = 0; q < queries; ++q) SimdAABB::QueryPoint(s, px[q], py[q], [&](size_t) { ++hitsSimd; });
+        double simdMs = MsSince(start);
+        start = std::chrono::steady_clock::now();
+        for (int q = 0; q < queries; ++q) {
+            for (size_t first = 0; first < n; first += SimdAABB::kBatch) {
+                uint32_t mask = SimdAABB::OverlapMask8Scalar(s, first, px[q], py[q], px[q], py[q]);
+                while (mask) { ++hitsScalar; mask &= mask - 1; }
+            }
+        }
+        double scalarMs = MsSince(start);
+        double tests = (double)n * queries;
+        r.Print("aabb QueryPoint: %zu boxes x %d points, simd %.2f ms (%.2f ns/box), scalar %.2f ms (%.2f ns/box), %.2fx, hits %zu/%zu\n",
+                n, queries, simdMs, simdMs * 1e6 / tests, scalarMs, scalarMs * 1e6 / tests,
+                simdMs > 0.0 ? scalarMs / simdMs : 0.0, hitsSimd, hitsScalar);
+    }
+
+    // Every SIMD kernel of VertexTransform must match its scalar reference bit for bit, for counts that
+    // leave every remainder and with zero, tiny and negative normals (the unlit / clamped cases)
+    bool CheckVertex(Report& r) {
+        std::mt19937 rng(99);
+        std::uniform_real_distribution<float> pos(-500.0f, 500.0f), unit(-1.0f, 1.0f);
+        std::uniform_int_distribution<int> special(0, 15), color(0, 0xFFFFFF);
+        size_t checked = 0, transformBad = 0, lightBad = 0, trianglesBad = 0, lerpBad = 0;
+        for (size_t count = 0; count <= 37; ++count) {
+            for (int rep = 0; rep < 20; ++rep) {
+                float m[3][4], n[3][3];
+                for (int i = 0; i < 3; ++i) {
+                    for (int j = 0; j < 4; ++j) m[i][j] = j == 3 ? pos(rng) : unit(rng) * 3.0f;
+                    for (int j = 0; j < 3; ++j) n[i][j] = unit(rng);
+                }
+                const VECTOR ldir = VGet(unit(rng), unit(rng), unit(rng));
+                const VertexTransform::Light l = VertexTransform::MakeLight(color(rng), ldir, 0.5f + unit(rng) * 0.5f, color(rng));
+                // exactly `count` elements, so a read past the last one would be an overrun
+                std::vector<VECTOR> points(count), normals(count), other(count);
+                for (size_t i = 0; i < count; ++i) {
+                    points[i] = VGet(pos(rng), pos(rng), pos(rng));
+                    other[i] = VGet(pos(rng), pos(rng), pos(rng));
+                    int kind = special(rng);
+                    normals[i] = kind == 0 ? VGet(0.0f, 0.0f, 0.0f) : kind == 1 ? VGet(1e-5f, 0.0f, 0.0f) : VGet(unit(rng), unit(rng), unit(rng));
+                }
+                std::vector<RenderVertex> simd(count), ref(count);
+                VertexTransform::TransformPositions(m, points.data(), count, simd.data());
+                VertexTransform::TransformPositionsScalar(m, points.data(), count, ref.data());
+                for (size_t i = 0; i < count; ++i) simd[i].color = ref[i].color = 0;
+                if (count && memcmp(simd.data(), ref.data(), count * sizeof(RenderVertex)) != 0) ++transformBad;
+
+                VertexTransform::LightVertices(l, n, normals.data(), count, simd.data());
+                VertexTransform::LightVerticesScalar(l, n, normals.data(), count, ref.data());
+                if (count && memcmp(simd.data(), ref.data(), count * sizeof(RenderVertex)) != 0) ++lightBad;
+
+                // `count` triangles from the transformed points, some degenerate
+                std::vector<RenderVertex> tris(count * 3);
+                for (size_t f = 0; f < count; ++f) {
+                    const bool degenerate = special(rng) == 0;
+                    for (size_t k = 0; k < 3; ++k) {
+                        const VECTOR& v = points[degenerate ? f : (f + k * 5 + 1) % count];
+                        tris[f * 3 + k] = { v.x, v.y, v.z, 0u };
+                    }
+                }
+                std::vector<RenderVertex> trisRef = tris;
+                VertexTransform::LightTriangles(l, tris.data(), count);
+                VertexTransform::LightTrianglesScalar(l, trisRef.data(), count);
+                if (count && memcmp(tris.data(), trisRef.data(), tris.size() * sizeof(RenderVertex)) != 0) ++trianglesBad;
+
+                const float t = (unit(rng) + 1.0f) * 0.5f;
+                std::vector<VECTOR> blended(count);
+                VertexTransform::LerpPositions(points.data(), other.data(), t, count, blended.data());
+                bool lerpSame = true;
+                for (size_t i = 0; i < count * 3; ++i) {
+                    const float a = (&points[0].x)[i], b = (&other[0].x)[i];
+                    const float e = a + (b - a) * t;
+                    lerpSame = lerpSame && memcmp(&e, &(&blended[0].x)[i], sizeof(float)) == 0;
+                }
+                if (!lerpSame) ++lerpBad;
+                ++checked;
+            }
+        }
+        r.Print("vertex check: %zu batches, mismatches TransformPositions %zu LightVertices %zu LightTriangles %zu LerpPositions %zu\n",
+                checked, transformBad, lightBad, trianglesBad, lerpBad);
+        return transformBad + lightBad + trianglesBad + lerpBad == 0;
+    }
+
+    // Bumpy (g x g)-quad grid with varying normals; g = 708 gives about 1M triangles
+    void BuildGrid(int g, std::vector<VECTOR>& vertices, std::vector<VECTOR>& normals, std::vector<int>& indices) {
+        vertices.clear(); normals.clear(); indices.clear();
+        for (int i = 0; i <= g; ++i) {
+            for (int j = 0; j <= g; ++j) {
+                float h = sinf(i * 0.1f) * cosf(j * 0.13f);
+                vertices.push_back(VGet(i - g / 2.0f, h * 5.0f, j - g / 2.0f));
+                normals.push_back(VGet(-cosf(i * 0.1f) * 0.5f * cosf(j * 0.13f), 1.0f, sinf(i * 0.1f) * sinf(j * 0.13f) * 0.65f));
+            }
+        }
+        indices.reserve((size_t)g * g * 6);
+        for (int i = 0; i < g; ++i) {
+            for (int j = 0; j < g; ++j) {
+                int a = i * (g + 1) + j, b = a + 1, c = a + g + 1, d = c + 1;
+                indices.insert(indices.end(), { a, c, b, b, c, d });
+            }
+        }
+    }
+
+    // The per-triangle path MeshRenderer used before DrawInstances3D: every corner of every triangle is
+    // transformed and lit on its own, on one thread
+    void ExpandPerTriangle(const InstanceData& inst, const VertexTransform::Light& l, const std::vector<VECTOR>& vertices,
+                           const std::vector<VECTOR>* normals, const std::vector<int>& indices, RenderVertex* out) {
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            RenderVertex* t = out + i;
+            for (int k = 0; k < 3; ++k) {
+                VertexTransform::TransformPositionsScalar(inst.model, &vertices[indices[i + k]], 1, t + k);
+                if (normals) VertexTransform::LightVerticesScalar(l, inst.normal, &(*normals)[indices[i + k]], 1, t + k);
+            }
+            if (!normals) VertexTransform::LightTrianglesScalar(l, t, 1);
+        }
+    }
+
+    // 1M-triangle mesh, per-triangle path vs. ExpandInstances (unique vertices once, SIMD, job pool)
+    bool BenchVertex(Report& r) {
+        std::vector<VECTOR> vertices, normals;
+        std::vector<int> indices;
+        BuildGrid(708, vertices, normals, indices);
+        Transform t;
+        t.x = 10.0f; t.y = -3.0f; t.z = 7.0f;
+        t.scaleX = t.scaleY = t.scaleZ = 2.5f; // unrotated, as the old path only translated and scaled
+        InstanceData inst;
+        t.GetMatrix3D(inst.model);
+        VertexTransform::NormalMatrix(t, inst.normal);
+        inst.color = 0xC0A080;
+        inst.pad[0] = inst.pad[1] = 0;
+        InstanceLight light = { 0.3f, -1.0f, 0.5f, 0.9f, 0x3050FF };
+        const VertexTransform::Light l = VertexTransform::MakeLight((int)inst.color, VGet(light.dirX, light.dirY, light.dirZ),
+                                                                    light.intensity, (int)light.color);
+        const size_t faces = indices.size() / 3;
+        std::vector<RenderVertex> perTriangle(faces * 3), batched(faces * 3);
+        r.Print("vertex: %zu triangles, %zu vertices, %d threads\n", faces, vertices.size(), JobSystem::Instance().GetThreadCount());
+        bool ok = true;
+        for (int lit = 1; lit >= 0; --lit) {
+            InstanceGeometry g;
+            g.positions = &vertices[0].x;
+            g.normals = lit ? &normals[0].x : nullptr;
+            g.vertexCount = vertices.size();
+            g.indices = indices.data();
+            g.indexCount = indices.size();
+            double oldMs = 1e30, newMs = 1e30;
+            for (int run = 0; run < 5; ++run) {
+                auto start = std::chrono::steady_clock::now();
+                ExpandPerTriangle(inst, l, vertices, lit ? &normals : nullptr, indices, perTriangle.data());
+                oldMs = std::min(oldMs, MsSince(start));
+                start = std::chrono::steady_clock::now();
+                VertexTransform::ExpandInstances(g, &inst, 1, light, batched.data());
+                newMs = std::min(newMs, MsSince(start));
+            }
+            bool identical = memcmp(perTriangle.data(), batched.data(), batched.size() * sizeof(RenderVertex)) == 0;
+            ok = ok && identical;
+            r.Print("vertex %s: per-triangle %.2f ms, batched %.2f ms (%.2fx), %.1f M triangles/s, identical=%d\n",
+                    lit ? "normals" : "face lighting", oldMs, newMs, newMs > 0.0 ? oldMs / newMs : 0.0,
+                    newMs > 0.0 ? faces / (newMs * 1000.0) : 0.0, (int)identical);
+        }
+        return ok;
+    }
+
+    // The `count` arguments after `flag` (quotes stripped); missing ones are empty
+    std::vector<std::string> ArgumentsAfter(const std::string& commandLine, size_t flag, size_t count) {
+        std::vector<std::string> args;
+        size_t p = commandLine.find(' ', flag);
+        while (args.size() < count) {
+            p = commandLine.find_first_not_of(' ', p);
+            if (p == std::string::npos) {
+                args.emplace_back();
+                continue;
+            }
+            size_t end;
+            if (commandLine[p] == '"') {
+                end = commandLine.find('"', p + 1);
+                args.push_back(commandLine.substr(p + 1, end == std::string::npos ? std::string::npos : end - p - 1));
+                if (end != std::string::npos) ++end;
+            } else {
+                end = commandLine.find(' ', p);
+                args.push_back(commandLine.substr(p, end == std::string::npos ? std::string::npos : end - p));
+            }
+            p = end;
+        }
+        return args;
+    }
+
+    bool BenchObj(Report& r, const std::string& path) {
+        if (path.empty()) {
+            r.Print("obj: usage -bench-obj <file.obj>\n");
+            return false;
+        }
+        ObjLoader::LoadStats s = ObjLoader::Benchmark(path);
+        if (s.bytes == 0) {
+            r.Print("obj: can't read %s\n", path.c_str());
+            return false;
+        }
+        r.Print("obj %s: %.1f MB, %zu vertices, %zu faces, %d chunks, best of 3 %.2f ms: %.1f MB/s, %.2f M vertices/s\n",
+                path.c_str(), s.bytes / (1024.0 * 1024.0), s.vertices, s.faces, s.chunks, s.parseMs,
+                s.MBPerSecond(), s.VerticesPerSecond() / 1e6);
+        return true;
+    }
+
+    // The checked-in reference for a scene: golden/cubes.scene -> golden/cubes.png
+    std::string ReferencePath(const std::string& scenePath) {
+        size_t dot = scenePath.find_last_of('.');
+        size_t slash = scenePath.find_last_of("/\\");
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) dot = scenePath.size();
+        return scenePath.substr(0, dot) + ".png";
+    }
+
+    // Renders a scene file with RenderToTarget3D through the SoftwareRasterizer, like the editor's 3D view
+    // with a fixed camera, and compares the frame with the scene's reference image. Passing the reference
+    // itself as <out.png> records a new one.
+    bool RenderHeadless(Report& r, const std::string& scenePath, const std::string& outPath) {
+        if (scenePath.empty() || outPath.empty()) {
+            r.Print("render: usage -render-headless <scene> <out.png>\n");
+            return false;
+        }
+        const int kWidth = 320, kHeight = 240;
+        const int kFrames = 20;
+        const int kTolerance = 8;             // per-channel difference still counted as equal
+        const double kMaxMismatch = 0.001;    // fraction of pixels allowed past the tolerance
+
+        SoftwareRasterizer sr;
+        RenderBackend::SetCurrent(&sr);
+        Scene scene;
+        if (!scene.Load(scenePath)) {
+            RenderBackend::SetCurrent(nullptr);
+            r.Print("render: can't read %s\n", scenePath.c_str());
+            return false;
+        }
+        scene.renderMode = Scene::RenderMode::Mode3D;
+        Scene::Camera3D cam;
+        cam.yaw = 45.0f;
+        cam.pitch = 30.0f;
+        cam.distance = 400.0f;
+
+        // one untimed warm-up frame: job threads start, caches and the render queue fill
+        scene.RenderToTarget3D(kWidth, kHeight, cam);
+        double totalMs = 0.0, bestMs = 1e30;
+        for (int i = 0; i < kFrames; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            scene.RenderToTarget3D(kWidth, kHeight, cam);
+            double ms = MsSince(start);
+            totalMs += ms;
+            bestMs = std::min(bestMs, ms);
+        }
+        RenderBackend::SetCurrent(nullptr);
+        const SoftwareRasterizer::Stats& st = sr.GetStats();
+        const Scene::RenderStats& rs = scene.GetRenderStats();
+        r.Print("render %s: %dx%d, %d meshes visible, %zu triangles, %zu lines, frame avg %.3f ms best %.3f ms "
+                "(rasterizer %.3f ms: setup %.3f, bin %.3f, raster %.3f)\n",
+                scenePath.c_str(), kWidth, kHeight, rs.meshesVisible, st.trianglesRasterized, st.lines,
+                totalMs / kFrames, bestMs, st.frameMs, st.setupMs, st.binMs, st.rasterMs);
+
+        if (!sr.SavePNG(outPath)) {
+            r.Print("render: can't write %s\n", outPath.c_str());
+            return false;
+        }
+        const std::string refPath = ReferencePath(scenePath);
+        if (refPath == outPath) {
+            r.Print("render: recorded reference %s\n", refPath.c_str());
+            return true;
+        }
+        int refWidth = 0, refHeight = 0;
+        std::vector<unsigned int> ref;
+        if (!SoftwareRasterizer::LoadPNG(refPath, refWidth, refHeight, ref)) {
+            r.Print("render: no reference image %s (run with it as <out.png> to record one)\n", refPath.c_str());
+            return false;
+        }
+        if (refWidth != kWidth || refHeight != kHeight) {
+            r.Print("render: reference is %dx%d, expected %dx%d\n", refWidth, refHeight, kWidth, kHeight);
+            return false;
+        }
+        const std::vector<unsigned int>& frame = sr.GetColorBuffer();
+        size_t mismatched = 0;
+        int maxDiff = 0;
+        for (size_t i = 0; i < frame.size(); ++i) {
+            int diff = 0;
+            for (int shift = 0; shift < 24; shift += 8)
+                diff = std::max(diff, std::abs((int)((frame[i] >> shift) & 0xFF) - (int)((ref[i] >> shift) & 0xFF)));
+            maxDiff = std::max(maxDiff, diff);
+            if (diff > kTolerance) ++mismatched;
+        }
+        const bool match = mismatched <= (size_t)(kMaxMismatch * frame.size());
+        r.Print("render: %s vs %s: %zu of %zu pixels differ (max channel difference %d): %s\n", outPath.c_str(),
+                refPath.c_str(), mismatched, frame.size(), maxDiff, match ? "ok" : "MISMATCH");
+        return match;
+    }
+}
+
+int Benchmarks::Run(const std::string& commandLine) {
+    const size_t aabb = commandLine.find("-bench-aabb");
+    const size_t obj = commandLine.find("-bench-obj");
+    const size_t vertex = commandLine.find("-bench-vertex");
+    const size_t render = commandLine.find("-render-headless");
+    if (aabb == std::string::npos && obj == std::string::npos && vertex == std::string::npos &&
+        render == std::string::npos) return -1;
+    Report r;
+    bool ok = true;
+    if (aabb != std::string::npos) {
+        ok = CheckAABB(r) && ok;
+        BenchAABB(r);
+    }
+    if (obj != std::string::npos) ok = BenchObj(r, ArgumentsAfter(commandLine, obj, 1)[0]) && ok;
+    if (vertex != std::string::npos) {
+        ok = CheckVertex(r) && ok;
+        ok = BenchVertex(r) && ok;
+    }
+    if (render != std::string::npos) {
+        std::vector<std::string> args = ArgumentsAfter(commandLine, render, 2);
+        ok = RenderHeadless(r, args[0], args[1]) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <string>
+
+// Benchmark / self-check drivers, run from the command line instead of the editor:
+//   -bench-aabb        check SimdAABB::OverlapMask8 against the scalar reference, then time QueryPoint
+//   -bench-obj <file>  ObjLoader::Benchmark on an .obj: parse throughput in MB/s and vertices/s
+//   -bench-vertex      check the VertexTransform SIMD kernels against their scalar references, then time
+//                      the old per-triangle expansion against ExpandInstances on a 1M-triangle mesh
+//   -render-headless <scene> <out.png>
+//                      render a scene with RenderToTarget3D through the SoftwareRasterizer (no DxLib needed),
+//                      report the frame time and compare the frame with the reference <scene>.png next to it
+// Results are printed to stdout and written to bench.txt (the WinMain build has no console).
+namespace Benchmarks {
+    // Process exit code (0 = all checks passed), or -1 when the command line has no benchmark flag
+    int Run(const std::string& commandLine);
+}
@@ -0,0 +1,128 @@
+#include "BroadPhase.h"
+#include "Collider.h"
+#include "GameObject.h"
+#include "JobSystem.h"
+#include <algorithm>
+
+namespace {
+    // below this many colliders the job dispatch costs more than the sweep itself
+    const size_t kMinSweepBatch = 256;
+}
+
+void BroadPhase2D::Reset(size_t count) {
+    bounds_.Resize(count);
+    sorted_.Resize(count);
+    order_.resize(count);
+    for (size_t i = 0; i < count; ++i) order_[i] = (uint32_t)i;
+    needsFullSort_ = true;
+}
+
+void BroadPhase2D::Update(const std::vector<Collider*>& colliders) {
+    if (bounds_.Size() != colliders.size()) Reset(colliders.size());
+    const float inf = std::numeric_limits<float>::infinity();
+
+    JobSystem::Instance().ParallelFor(colliders.size(), kMinSweepBatch * 4, [&](size_t begin, size_t end, int) {
+        for (size_t i = begin; i < end; ++i) {
+            const Collider* c = colliders[i];
+            // 3D colliders get an empty box here; their pairs come from the scene's AABBTree
+            if (c->Is3D()) { bounds_.Set(i, inf, inf, -inf, -inf); continue; }
+            const Transform& t = c->owner->ctransform();
+            bounds_.Set(i, t.x, t.y, t.x + c->width, t.y + c->height);
+        }
+    });
+
+    // ties broken by collider index so the order never depends on the previous frame
+    auto less = [this](uint32_t a, uint32_t b) {
+        float ka = bounds_.minX[a], kb = bounds_.minX[b];
+        return ka < kb || (ka == kb && a < b);
+    };
+    if (needsFullSort_) {
+        std::sort(order_.begin(), order_.end(), less);
+        needsFullSort_ = false;
+    } else {
+        // objects move little between steps, so the previous order is almost sorted
+        for (size_t i = 1; i < order_.size(); ++i) {
+            uint32_t v = order_[i];
+            size_t j = i;
+            while (j > 0 && less(v, order_[j - 1])) {
+                order_[j] = order_[j - 1];
+                --j;
+            }
+            order_[j] = v;
+        }
+    }
+
+    // lay the boxes out in sweep order so candidates are contiguous for the SIMD scan
+    maxWidth_ = 0.0f;
+    for (size_t s = 0; s < order_.size(); ++s) {
+        uint32_t i = order_[s];
+        sorted_.Set(s, bounds_.minX[i], bounds_.minY[i], bounds_.maxX[i], bounds_.maxY[i]);
+        float w = bounds_.maxX[i] - bounds_.minX[i];
+        if (w > maxWidth_) maxWidth_ = w;
+    }
+}
+
+void BroadPhase2D::QueryBox(float minX, float minY, float maxX, float maxY, std::vector<uint32_t>& out) const {
+    const size_t n = order_.size();
+    // first box that can still reach minX: starts no further left than minX - widest box
+    float from = minX - maxWidth_;
+    size_t lo = 0, hi = n;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (sorted_.minX[mid] < from) lo = mid + 1; else hi = mid;
+    }
+    for (size_t t = lo; t < n; t += SimdAABB::kBatch) {
+        uint32_t mask = SimdAABB::OverlapMask8(sorted_, t, minX, minY, maxX, maxY);
+        while (mask) {
+            unsigned k = SimdAABB::LowestBit(mask);
+            mask &= mask - 1;
+            out.push_back(order_[t + k]);
+        }
+        if (sorted_.minX[t + SimdAABB::kBatch - 1] > maxX) break;
+    }
+}
+
+void BroadPhase2D::SweepRange(size_t begin, size_t end, std::vector<ColliderPair>& out) const {
+    const size_t n = order_.size();
+    for (size_t s = begin; s < end; ++s) {
+        uint32_t ia = order_[s];
+        float qMinX = sorted_.minX[s], qMinY = sorted_.minY[s];
+        float qMaxX = sorted_.maxX[s], qMaxY = sorted_.maxY[s];
+        // padding boxes never overlap, so batches may run past n
+        for (size_t t = s + 1; t < n; t += SimdAABB::kBatch) {
+            uint32_t mask = SimdAABB::OverlapMask8(sorted_, t, qMinX, qMinY, qMaxX, qMaxY);
+            while (mask) {
+                unsigned k = SimdAABB::LowestBit(mask);
+                mask &= mask - 1;
+                uint32_t ib = order_[t + k];
+                out.push_back(ia < ib ? ColliderPair{ ia, ib } : ColliderPair{ ib, ia });
+            }
+            // sorted by minX: once the batch's last box starts past us nothing further can overlap
+            if (sorted_.minX[t + SimdAABB::kBatch - 1] > qMaxX) break;
+        }
+    }
+}
+
+void BroadPhase2D::FindOverlaps(std::vector<ColliderPair>& outPairs) {
+    outPairs.clear();
+    JobSystem& jobs = JobSystem::Instance();
+    int chunks = jobs.ChunkCount(order_.size(), kMinSweepBatch);
+    if (chunks == 0) return;
+    if ((int)chunkPairs_.size() < chunks) chunkPairs_.resize(chunks);
+    for (int c = 0; c < chunks; ++c) chunkPairs_[c].clear();
+
+    jobs.ParallelFor(order_.size(), kMinSweepBatch, [&](size_t begin, size_t end, int chunk) {
+        SweepRange(begin, end, chunkPairs_[chunk]);
+    });
+
+    size_t total = 0;
+    for (int c = 0; c < chunks; ++c) total += chunkPairs_[c].size();
+    outPairs.reserve(total);
+    for (int c = 0; c < chunks; ++c) {
+        outPairs.insert(outPairs.end(), chunkPairs_[c].begin(), chunkPairs_[c].end());
+    }
+    // sweep order depends on positions; event order must only depend on the collider list
+    std::sort(outPairs.begin(), outPairs.end(), [](const ColliderPair& x, const ColliderPair& y) {
+        return x.a < y.a || (x.a == y.a && x.b < y.b);
+    });
+}
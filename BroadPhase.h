@@ -0,0 +1,47 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "SimdAABB.h"
+
+struct Collider;
+
+// Candidate/overlap pair, stored as indices into the collider list given to Update (a < b)
+struct ColliderPair {
+    uint32_t a;
+    uint32_t b;
+};
+
+// BroadPhase2D: sweep-and-prune along X for the 2D AABB colliders.
+// The sorted order is kept between steps so the per-step sort is a near-linear insertion sort.
+// The sweep is split into intervals of the sorted list and run on the JobSystem; every
+// interval writes its own pair buffer and the buffers are merged in interval order.
+// Boxes are kept as SoA arrays so the sweep tests 8 candidates per SimdAABB batch.
+class BroadPhase2D {
+public:
+    // Reset after the collider list changed (forces a full sort on the next Update)
+    void Reset(size_t count);
+
+    // Gather world boxes for the colliders and re-sort the sweep axis
+    void Update(const std::vector<Collider*>& colliders);
+
+    // Find all overlapping pairs. Output is sorted by (a, b) so event order matches list order.
+    void FindOverlaps(std::vector<ColliderPair>& outPairs);
+
+    // Collect indices of colliders whose box overlaps the query box (valid after Update).
+    // Only the slice of the sweep axis that can reach the box is scanned.
+    void QueryBox(float minX, float minY, float maxX, float maxY, std::vector<uint32_t>& out) const;
+
+    // World boxes indexed by collider index (valid after Update)
+    const SimdAABB::AABBSoA& GetBounds() const { return bounds_; }
+
+private:
+    void SweepRange(size_t begin, size_t end, std::vector<ColliderPair>& out) const;
+
+    SimdAABB::AABBSoA bounds_;    // indexed by collider index
+    SimdAABB::AABBSoA sorted_;    // same boxes in sweep order
+    std::vector<uint32_t> order_; // collider indices sorted by minX
+    std::vector<std::vector<ColliderPair>> chunkPairs_;
+    float maxWidth_ = 0.0f;       // widest box, bounds how far left of a query a box may start
+    bool needsFullSort_ = true;
+};
@@ -1,6 +1,7 @@
 #pragma once
 #include "Component.h"
 #include <set>
+#include <vector>
 
 // Collider: ȈՓIAABBRC_
 struct Collider : public Component {
@@ -10,6 +11,24 @@ struct Collider : public Component {
     // ՓˊǗ: ݏՓ˂ĂRC_W
     std::set<Collider*> currentCollisions;
 
+    // Continuous collision detection: sweep the box from its previous step position so fast
+    // movers can't tunnel through thin colliders. Costs a broad-phase query per step, so only
+    // enable it on colliders that actually move fast.
+    bool continuous = false;
+
+    // Time of impact found by the sweep this step (time in [0,1] along the step's motion,
+    // normal points from `other` towards this collider)
+    struct SweepHit {
+        Collider* other;
+        float time;
+        float normalX;
+        float normalY;
+    };
+    std::vector<SweepHit> sweepHits;
+
+    // 3D colliders (Collider3D) live in the scene's AABBTree instead of the 2D sweep
+    virtual bool Is3D() const { return false; }
+
     Collider() {}
     Collider(float w, float h) : width(w), height(h) {}
 
@@ -18,7 +37,37 @@ struct Collider : public Component {
         return !(ax + aw < bx || bx + bw < ax || ay + ah < by || by + bh < ay);
     }
 
+    // Swept AABB: box a moves by (dx, dy) against static box b. Returns true when they first
+    // touch during the motion (not when already overlapping at the start).
+    bool SweepAABB(float ax, float ay, float aw, float ah, float dx, float dy,
+                   float bx, float by, float bw, float bh,
+                   float& outTime, float& outNormalX, float& outNormalY) const {
+        const float inf = 1e30f;
+        float enterX, exitX, enterY, exitY;
+        if (dx > 0.0f)      { enterX = (bx - (ax + aw)) / dx; exitX = ((bx + bw) - ax) / dx; }
+        else if (dx < 0.0f) { enterX = ((bx + bw) - ax) / dx; exitX = (bx - (ax + aw)) / dx; }
+        else {
+            if (ax + aw < bx || bx + bw < ax) return false;
+            enterX = -inf; exitX = inf;
+        }
+        if (dy > 0.0f)      { enterY = (by - (ay + ah)) / dy; exitY = ((by + bh) - ay) / dy; }
+        else if (dy < 0.0f) { enterY = ((by + bh) - ay) / dy; exitY = (by - (ay + ah)) / dy; }
+        else {
+            if (ay + ah < by || by + bh < ay) return false;
+            enterY = -inf; exitY = inf;
+        }
+        float enter = enterX > enterY ? enterX : enterY;
+        float exit = exitX < exitY ? exitX : exitY;
+        if (enter > exit || enter < 0.0f || enter > 1.0f) return false;
+        outTime = enter;
+        if (enterX > enterY) { outNormalX = dx > 0.0f ? -1.0f : 1.0f; outNormalY = 0.0f; }
+        else                 { outNormalX = 0.0f; outNormalY = dy > 0.0f ? -1.0f : 1.0f; }
+        return true;
+    }
+
     std::shared_ptr<Component> Clone() const override {
-        return std::make_shared<Collider>(width, height);
+        auto c = std::make_shared<Collider>(width, height);
+        c->continuous = continuous;
+        return c;
     }
 };
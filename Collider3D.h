@@ -0,0 +1,239 @@
+#pragma once
+#include "Collider.h"
+#include "GameObject.h"
+#include "AABBTree.h"
+#include <cmath>
+
+// Collider3D: box, sphere or oriented box centered on the owner's transform.
+// width/height/depth are full extents (scaled by the transform scale); radius is used by Sphere.
+// Box ignores rotation and stays axis aligned; OrientedBox follows rotationX/Y/Z.
+struct Collider3D : public Collider {
+    enum class Shape { Box, Sphere, OrientedBox };
+    Shape shape = Shape::Box;
+    float depth = 0;
+    float radius = 0;
+
+    Collider3D() {}
+    Collider3D(float w, float h, float d, Shape s = Shape::Box) : Collider(w, h), shape(s), depth(d) {}
+    explicit Collider3D(float r) : shape(Shape::Sphere), radius(r) {}
+
+    bool Is3D() const override { return true; }
+
+    void GetCenter(float& x, float& y, float& z) const {
+        const Transform& t = owner->ctransform();
+        x = t.x; y = t.y; z = t.z;
+    }
+
+    void GetHalfExtents(float h[3]) const {
+        const Transform& t = owner->ctransform();
+        h[0] = fabsf(width * t.scaleX) * 0.5f;
+        h[1] = fabsf(height * t.scaleY) * 0.5f;
+        h[2] = fabsf(depth * t.scaleZ) * 0.5f;
+    }
+
+    float GetScaledRadius() const {
+        const Transform& t = owner->ctransform();
+        float s = fabsf(t.scaleX);
+        if (fabsf(t.scaleY) > s) s = fabsf(t.scaleY);
+        if (fabsf(t.scaleZ) > s) s = fabsf(t.scaleZ);
+        return radius * s;
+    }
+
+    // Box axes in world space (identity unless OrientedBox)
+    void GetAxes(float axes[3][3]) const {
+        if (shape == Shape::OrientedBox) { owner->ctransform().GetAxes3D(axes); return; }
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j) axes[i][j] = i == j ? 1.0f : 0.0f;
+    }
+
+    // World-space AABB of the shape (what the broad phase stores)
+    Bounds3 ComputeBounds() const {
+        float c[3];
+        GetCenter(c[0], c[1], c[2]);
+        float e[3];
+        if (shape == Shape::Sphere) {
+            e[0] = e[1] = e[2] = GetScaledRadius();
+        } else {
+            float h[3], a[3][3];
+            GetHalfExtents(h);
+            GetAxes(a);
+            for (int j = 0; j < 3; ++j) e[j] = fabsf(a[0][j]) * h[0] + fabsf(a[1][j]) * h[1] + fabsf(a[2][j]) * h[2];
+        }
+        Bounds3 b;
+        b.minX = c[0] - e[0]; b.minY = c[1] - e[1]; b.minZ = c[2] - e[2];
+        b.maxX = c[0] + e[0]; b.maxY = c[1] + e[1]; b.maxZ = c[2] + e[2];
+        return b;
+    }
+
+    // Narrow phase against another 3D collider (touching counts, like TestAABB)
+    bool Overlaps(const Collider3D& o) const {
+        if (shape == Shape::Sphere && o.shape == Shape::Sphere) {
+            float a[3], b[3];
+            GetCenter(a[0], a[1], a[2]);
+            o.GetCenter(b[0], b[1], b[2]);
+            float dx = b[0] - a[0], dy = b[1] - a[1], dz = b[2] - a[2];
+            float r = GetScaledRadius() + o.GetScaledRadius();
+            return dx * dx + dy * dy + dz * dz <= r * r;
+        }
+        if (shape == Shape::Sphere) return o.BoxOverlapsSphere(*this);
+        if (o.shape == Shape::Sphere) return BoxOverlapsSphere(o);
+        if (shape == Shape::Box && o.shape == Shape::Box) return ComputeBounds().Overlaps(o.ComputeBounds());
+        return BoxOverlapsBox(o);
+    }
+
+    // Narrow phase against a world-space box (OverlapBox / OverlapPoint queries)
+    bool OverlapsBounds(const Bounds3& box) const {
+        if (shape == Shape::Sphere) {
+            float c[3];
+            GetCenter(c[0], c[1], c[2]);
+            float px = c[0] < box.minX ? box.minX : (c[0] > box.maxX ? box.maxX : c[0]);
+            float py = c[1] < box.minY ? box.minY : (c[1] > box.maxY ? box.maxY : c[1]);
+            float pz = c[2] < box.minZ ? box.minZ : (c[2] > box.maxZ ? box.maxZ : c[2]);
+            float dx = px - c[0], dy = py - c[1], dz = pz - c[2];
+            float r = GetScaledRadius();
+            return dx * dx + dy * dy + dz * dz <= r * r;
+        }
+        if (!ComputeBounds().Overlaps(box)) return false;
+        // unbounded query boxes (2D queries spanning all of Z) stop at the AABB test
+        if (shape == Shape::Box || !std::isfinite(box.maxX - box.minX) || !std::isfinite(box.maxY - box.minY) ||
+            !std::isfinite(box.maxZ - box.minZ)) return true;
+        float ca[3], ha[3], A[3][3];
+        GetCenter(ca[0], ca[1], ca[2]);
+        GetHalfExtents(ha);
+        GetAxes(A);
+        float cb[3] = { (box.minX + box.maxX) * 0.5f, (box.minY + box.maxY) * 0.5f, (box.minZ + box.maxZ) * 0.5f };
+        float hb[3] = { (box.maxX - box.minX) * 0.5f, (box.maxY - box.minY) * 0.5f, (box.maxZ - box.minZ) * 0.5f };
+        const float I[3][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+        return ObbOverlap(ca, ha, A, cb, hb, I);
+    }
+
+    // Ray origin + dir * t for t in [0, maxT]. On hit returns t and the surface normal.
+    bool Raycast(float ox, float oy, float oz, float dx, float dy, float dz, float maxT,
+                 float& outT, float& nx, float& ny, float& nz) const {
+        float c[3];
+        GetCenter(c[0], c[1], c[2]);
+        if (shape == Shape::Sphere) {
+            float r = GetScaledRadius();
+            float mx = ox - c[0], my = oy - c[1], mz = oz - c[2];
+            float a = dx * dx + dy * dy + dz * dz;
+            if (a <= 0.0f) return false;
+            float b = mx * dx + my * dy + mz * dz;
+            float cc = mx * mx + my * my + mz * mz - r * r;
+            if (cc > 0.0f && b > 0.0f) return false;
+            float disc = b * b - a * cc;
+            if (disc < 0.0f) return false;
+            float t = (-b - sqrtf(disc)) / a;
+            if (t < 0.0f) t = 0.0f; // origin inside
+            if (t > maxT) return false;
+            float hx = mx + dx * t, hy = my + dy * t, hz = mz + dz * t;
+            float len = sqrtf(hx * hx + hy * hy + hz * hz);
+            if (len > 0.0f) { nx = hx / len; ny = hy / len; nz = hz / len; }
+            else { nx = 0.0f; ny = 1.0f; nz = 0.0f; }
+            outT = t;
+            return true;
+        }
+        // slab test in the box's local frame
+        float h[3], ax[3][3];
+        GetHalfExtents(h);
+        GetAxes(ax);
+        float rel[3] = { ox - c[0], oy - c[1], oz - c[2] };
+        float dir[3] = { dx, dy, dz };
+        float t0 = 0.0f, t1 = maxT;
+        int hitAxis = -1;
+        float hitSign = 0.0f;
+        for (int i = 0; i < 3; ++i) {
+            float o = rel[0] * ax[i][0] + rel[1] * ax[i][1] + rel[2] * ax[i][2];
+            float d = dir[0] * ax[i][0] + dir[1] * ax[i][1] + dir[2] * ax[i][2];
+            if (fabsf(d) < 1e-12f) {
+                if (o < -h[i] || o > h[i]) return false;
+                continue;
+            }
+            float tn = (-h[i] - o) / d, tf = (h[i] - o) / d;
+            float sign = -1.0f;
+            if (tn > tf) { float s = tn; tn = tf; tf = s; sign = 1.0f; }
+            if (tn > t0) { t0 = tn; hitAxis = i; hitSign = sign; }
+            if (tf < t1) t1 = tf;
+            if (t0 > t1) return false;
+        }
+        outT = t0;
+        if (hitAxis < 0) { nx = -dx; ny = -dy; nz = -dz; } // origin inside the box
+        else { nx = ax[hitAxis][0] * hitSign; ny = ax[hitAxis][1] * hitSign; nz = ax[hitAxis][2] * hitSign; }
+        return true;
+    }
+
+    std::shared_ptr<Component> Clone() const override {
+        auto c = std::make_shared<Collider3D>(width, height, depth, shape);
+        c->radius = radius;
+        c->continuous = continuous;
+        return c;
+    }
+
+private:
+    bool BoxOverlapsSphere(const Collider3D& s) const {
+        float c[3], sc[3], h[3], ax[3][3];
+        GetCenter(c[0], c[1], c[2]);
+        s.GetCenter(sc[0], sc[1], sc[2]);
+        GetHalfExtents(h);
+        GetAxes(ax);
+        float rel[3] = { sc[0] - c[0], sc[1] - c[1], sc[2] - c[2] };
+        // distance from the sphere center to the closest point of the box, in box space
+        float dist2 = 0.0f;
+        for (int i = 0; i < 3; ++i) {
+            float p = rel[0] * ax[i][0] + rel[1] * ax[i][1] + rel[2] * ax[i][2];
+            float out = 0.0f;
+            if (p > h[i]) out = p - h[i];
+            else if (p < -h[i]) out = -h[i] - p;
+            dist2 += out * out;
+        }
+        float r = s.GetScaledRadius();
+        return dist2 <= r * r;
+    }
+
+    bool BoxOverlapsBox(const Collider3D& o) const {
+        float ca[3], cb[3], ha[3], hb[3], A[3][3], B[3][3];
+        GetCenter(ca[0], ca[1], ca[2]);
+        o.GetCenter(cb[0], cb[1], cb[2]);
+        GetHalfExtents(ha);
+        o.GetHalfExtents(hb);
+        GetAxes(A);
+        o.GetAxes(B);
+        return ObbOverlap(ca, ha, A, cb, hb, B);
+    }
+
+    // separating axis test for two oriented boxes (15 axes)
+    static bool ObbOverlap(const float ca[3], const float ha[3], const float A[3][3],
+                           const float cb[3], const float hb[3], const float B[3][3]) {
+        const float eps = 1e-6f; // keeps near-parallel edge axes from producing false separations
+        float R[3][3], AbsR[3][3];
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j) {
+                R[i][j] = A[i][0] * B[j][0] + A[i][1] * B[j][1] + A[i][2] * B[j][2];
+                AbsR[i][j] = fabsf(R[i][j]) + eps;
+            }
+        float d[3] = { cb[0] - ca[0], cb[1] - ca[1], cb[2] - ca[2] };
+        float t[3];
+        for (int i = 0; i < 3; ++i) t[i] = d[0] * A[i][0] + d[1] * A[i][1] + d[2] * A[i][2];
+
+        for (int i = 0; i < 3; ++i) {
+            float rb = hb[0] * AbsR[i][0] + hb[1] * AbsR[i][1] + hb[2] * AbsR[i][2];
+            if (fabsf(t[i]) > ha[i] + rb) return false;
+        }
+        for (int j = 0; j < 3; ++j) {
+            float ra = ha[0] * AbsR[0][j] + ha[1] * AbsR[1][j] + ha[2] * AbsR[2][j];
+            float tb = t[0] * R[0][j] + t[1] * R[1][j] + t[2] * R[2][j];
+            if (fabsf(tb) > ra + hb[j]) return false;
+        }
+        // cross products A_i x B_j
+        for (int i = 0; i < 3; ++i) {
+            int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+            for (int j = 0; j < 3; ++j) {
+                int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+                float ra = ha[i1] * AbsR[i2][j] + ha[i2] * AbsR[i1][j];
+                float rb = hb[j1] * AbsR[i][j2] + hb[j2] * AbsR[i][j1];
+                float tl = fabsf(t[i2] * R[i1][j] - t[i1] * R[i2][j]);
+                if (tl > ra + rb) return false;
+            }
+        }
+        return true;
+    }
+};
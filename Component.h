@@ -27,6 +27,8 @@ struct Component {
     // et[ɌĂ΂
     virtual void Update() {}
     virtual void Render() {}
+    // Called once per fixed physics step (Time::fixedDeltaTime) before collisions are resolved
+    virtual void FixedUpdate() {}
 
     // Փ˃CxgiColliderm̏ՓˎɌĂ΂j
     virtual void OnCollisionEnter(Collider* other) {}
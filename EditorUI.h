@@ -3,6 +3,7 @@
 #include <memory>
 #include <vector>
 #include <string>
+#include <cmath>
 #include "Scene.h"
 #include "GameObject.h"
 #include "UI.h"
@@ -13,7 +14,7 @@
 #include "MeshRenderer.h"
 #include "UnityPackageImporter.h"
 #include "LabelComponent.h"
-#include "third_party/ModelLoader.h"
+#include "MeshArtifact.h"
 #include "SkinnedMeshRenderer.h"
 #include "EffekseerComponent.h"
 #include "AssetDatabase.h"
@@ -166,9 +167,10 @@ inline void DrawEditor(Scene& scene, std::shared_ptr<GameObject> &selected, int
                             scene.AddRootObject(go);
                     } else if (ext == ".fbx" || ext == ".FBX") {
                             auto go = std::make_shared<GameObject>(name);
-                            // inspect model to decide skinned or static
-                            auto mesh = ModelLoader::LoadModel(full);
-                        if (mesh && (!mesh->boneNames.empty() || !mesh->animations.empty())) {
+                            // inspect the imported model's header to decide skinned or static; the renderer
+                            // then maps the same artifact instead of loading the FBX a second time
+                            MeshArtifact::Summary model;
+                        if (MeshArtifact::GetSummary(full, model) && (model.bones > 0 || model.animations > 0)) {
                             go->AddComponent<SkinnedMeshRenderer>(full);
                             go->AddComponent<LabelComponent>(name + " (Skinned)");
                         } else {
@@ -202,7 +204,7 @@ inline void DrawEditor(Scene& scene, std::shared_ptr<GameObject> &selected, int
                 size_t p = rel.find_last_of("/\\");
                 std::string fnUtf8 = (p == std::string::npos) ? rel : rel.substr(p+1);
                 std::string example = std::string("Assets/") + fnUtf8;
-                auto seq = ObjSequenceLoader::LoadSequence(example);
+                auto seq = ObjSequenceLoader::OpenSequence(example); // streamed: frames are read during playback
                 if (seq) {
                     auto go = std::make_shared<GameObject>(fnUtf8);
                     auto smr = std::make_shared<SkinnedMeshRenderer>();
@@ -243,8 +245,8 @@ inline void DrawEditor(Scene& scene, std::shared_ptr<GameObject> &selected, int
                             scene.AddRootObject(go);
                         } else if (ext == ".fbx" || ext == ".FBX") {
                             auto go = std::make_shared<GameObject>(fn);
-                            auto mesh = ModelLoader::LoadModel(full);
-                            if (mesh && (!mesh->boneNames.empty() || !mesh->animations.empty())) {
+                            MeshArtifact::Summary model;
+                            if (MeshArtifact::GetSummary(full, model) && (model.bones > 0 || model.animations > 0)) {
                                 go->AddComponent<SkinnedMeshRenderer>(full);
                                 go->AddComponent<LabelComponent>(fn + " (Skinned)");
                             } else {
@@ -282,30 +284,34 @@ inline void DrawEditor(Scene& scene, std::shared_ptr<GameObject> &selected, int
         float worldY = (float)(my - viewY - viewH/2) / scene.camera.zoom + scene.camera.y;
 
         if (mouseInViewport && leftNow && !leftPrev && !dragging) {
-            for (auto it = scene.GetRoots().rbegin(); it != scene.GetRoots().rend(); ++it) {
-                auto obj = *it;
-                bool hit = false;
+            // colliders containing the cursor or origins within 16px; the topmost root wins
+            const float pickRadius = 16.0f;
+            Bounds3 pickBox;
+            pickBox.minX = worldX - pickRadius; pickBox.maxX = worldX + pickRadius;
+            pickBox.minY = worldY - pickRadius; pickBox.maxY = worldY + pickRadius;
+            pickBox.minZ = -INFINITY; pickBox.maxZ = INFINITY;
+            static std::vector<GameObject*> candidates;
+            scene.OverlapBox(pickBox, candidates, Scene::kQueryColliders2D | Scene::kQueryPivots);
+
+            for (size_t k = candidates.size(); k-- > 0;) {
+                GameObject* obj = candidates[k];
+                const Transform& t = obj->ctransform();
+                float dx = t.x - worldX;
+                float dy = t.y - worldY;
+                bool hit = dx*dx + dy*dy < pickRadius*pickRadius;
                 for (auto& c : obj->GetAllComponents()) {
-                    auto colPtr = std::dynamic_pointer_cast<Collider>(c);
-                    if (colPtr) {
-                        float ox = obj->transform().x;
-                        float oy = obj->transform().y;
-                        float hw = colPtr->width * 0.5f;
-                        float hh = colPtr->height * 0.5f;
-                        if (worldX >= ox - hw && worldX <= ox + hw && worldY >= oy - hh && worldY <= oy + hh) { hit = true; break; }
+                    if (hit) break;
+                    auto colPtr = dynamic_cast<Collider*>(c.get());
+                    if (colPtr && !colPtr->Is3D()) {
+                        hit = worldX >= t.x && worldX <= t.x + colPtr->width && worldY >= t.y && worldY <= t.y + colPtr->height;
                     }
                 }
-                if (!hit) {
-                    float dx = obj->transform().x - worldX;
-                    float dy = obj->transform().y - worldY;
-                    if (dx*dx + dy*dy < 16*16) hit = true;
-                }
                 if (hit) {
                     dragging = true;
-                    dragObj = obj;
-                    dragOffsetX = obj->transform().x - worldX;
-                    dragOffsetY = obj->transform().y - worldY;
-                    selected = obj;
+                    dragObj = obj->shared_from_this();
+                    dragOffsetX = t.x - worldX;
+                    dragOffsetY = t.y - worldY;
+                    selected = dragObj;
                     break;
                 }
             }
@@ -322,11 +328,19 @@ inline void DrawEditor(Scene& scene, std::shared_ptr<GameObject> &selected, int
         }
     }
 
+    if (scene.renderMode == Scene::RenderMode::Mode3D && mouseInViewport && leftNow && !leftPrev) {
+        // pick the closest collider or mesh under the cursor
+        float ox, oy, oz, dx, dy, dz;
+        scene.ScreenPointToRay3D((float)(mx - viewX), (float)(my - viewY), viewW, viewH, scene.camera3D, ox, oy, oz, dx, dy, dz);
+        Scene::RaycastHit hit;
+        if (scene.Raycast(ox, oy, oz, dx, dy, dz, 100000.0f, hit)) selected = hit.object->shared_from_this();
+    }
+
     prevMouse = mouseNow;
 
     if (selected) {
-        float wx = selected->transform().x;
-        float wy = selected->transform().y;
+        float wx = selected->ctransform().x;
+        float wy = selected->ctransform().y;
         int gx = viewX + (int)((wx - scene.camera.x) * scene.camera.zoom + viewW/2.0f);
         int gy = viewY + (int)((wy - scene.camera.y) * scene.camera.zoom + viewH/2.0f);
         if (gx < viewX) gx = viewX + viewW/2;
@@ -411,7 +425,7 @@ inline void DrawEditor(Scene& scene, std::shared_ptr<GameObject> &selected, int
         if (selected) {
             DrawFormatString(rightX + 8, selY, GetColor(200,200,200), "Name: %s", selected->name().c_str());
             selY += 20;
-            DrawFormatString(rightX + 8, selY, GetColor(180,180,180), "Position: %.1f, %.1f", selected->transform().x, selected->transform().y);
+            DrawFormatString(rightX + 8, selY, GetColor(180,180,180), "Position: %.1f, %.1f", selected->ctransform().x, selected->ctransform().y);
             selY += 24;
             int ci = 0;
             for (auto& c : selected->GetAllComponents()) {
@@ -0,0 +1,208 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <limits>
+#include "AABBTree.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FRUSTUM_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_SSE 1
+#endif
+
+// FrustumCulling: camera matrices, view frustum planes and a kernel that tests 8 consecutive bounding volumes
+// (AABB center/extent + sphere radius around the same center, SoA) against all six planes.
+// A volume is culled when either its box or its sphere lies fully behind one plane.
+namespace FrustumCulling {
+
+const size_t kBatch = 8;
+
+// Left-handed look-at basis with Y up: forward, right and up unit vectors from eye towards target
+inline void CameraBasis(float eyeX, float eyeY, float eyeZ, float targetX, float targetY, float targetZ,
+                        float f[3], float r[3], float u[3]) {
+    f[0] = targetX - eyeX; f[1] = targetY - eyeY; f[2] = targetZ - eyeZ;
+    float fl = sqrtf(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+    if (fl <= 0.0f) { f[0] = 0; f[1] = 0; f[2] = 1; fl = 1; }
+    f[0] /= fl; f[1] /= fl; f[2] /= fl;
+    r[0] = f[2]; r[1] = 0.0f; r[2] = -f[0];
+    float rl = sqrtf(r[0] * r[0] + r[2] * r[2]);
+    if (rl <= 1e-6f) { r[0] = 1; r[2] = 0; rl = 1; }
+    r[0] /= rl; r[2] /= rl;
+    u[0] = f[1] * r[2] - f[2] * r[1]; u[1] = f[2] * r[0] - f[0] * r[2]; u[2] = f[0] * r[1] - f[1] * r[0];
+}
+
+// View-projection matrix (column vectors: clip = m * (x, y, z, 1)) matching SetupCamera_Perspective:
+// clip z is 0 at nearZ and w at farZ, so z / w is the [0, 1] depth the rasterizers store
+inline void BuildViewProjection(float m[4][4], float eyeX, float eyeY, float eyeZ, float targetX, float targetY, float targetZ,
+                                float fovY, float aspect, float nearZ, float farZ) {
+    float x[3], y[3], z[3];
+    CameraBasis(eyeX, eyeY, eyeZ, targetX, targetY, targetZ, z, x, y);
+    float eye[3] = { eyeX, eyeY, eyeZ };
+    float ys = 1.0f / tanf(fovY * 0.5f);
+    float xs = ys / aspect;
+    float q = farZ / (farZ - nearZ);
+    for (int j = 0; j < 3; ++j) {
+        m[0][j] = x[j] * xs;
+        m[1][j] = y[j] * ys;
+        m[2][j] = z[j] * q;
+        m[3][j] = z[j];
+    }
+    float ex = x[0] * eye[0] + x[1] * eye[1] + x[2] * eye[2];
+    float ey = y[0] * eye[0] + y[1] * eye[1] + y[2] * eye[2];
+    float ez = z[0] * eye[0] + z[1] * eye[1] + z[2] * eye[2];
+    m[0][3] = -ex * xs;
+    m[1][3] = -ey * ys;
+    m[2][3] = -ez * q - nearZ * q;
+    m[3][3] = -ez;
+}
+
+struct Frustum {
+    // inward normals: a point is inside when nx*x + ny*y + nz*z + d >= 0 for every plane
+    float nx[6], ny[6], nz[6], d[6];
+
+    // Perspective camera looking from eye at target (left-handed, Y up), vertical fov in radians
+    static Frustum FromCamera(float eyeX, float eyeY, float eyeZ, float targetX, float targetY, float targetZ,
+                              float fovY, float aspect, float nearZ, float farZ) {
+        float f[3], r[3], u[3];
+        CameraBasis(eyeX, eyeY, eyeZ, targetX, targetY, targetZ, f, r, u);
+
+        float th = tanf(fovY * 0.5f);
+        float tw = th * aspect;
+        Frustum fr;
+        float eye[3] = { eyeX, eyeY, eyeZ };
+        // side planes: view-space x <= z * tw etc., normalized so sphere radii compare directly
+        float sw = 1.0f / sqrtf(tw * tw + 1.0f), sh = 1.0f / sqrtf(th * th + 1.0f);
+        float n[6][3];
+        for (int k = 0; k < 3; ++k) {
+            n[0][k] = f[k];                        // near
+            n[1][k] = -f[k];                       // far
+            n[2][k] = (f[k] * tw + r[k]) * sw;     // left
+            n[3][k] = (f[k] * tw - r[k]) * sw;     // right
+            n[4][k] = (f[k] * th + u[k]) * sh;     // bottom
+            n[5][k] = (f[k] * th - u[k]) * sh;     // top
+        }
+        for (int p = 0; p < 6; ++p) {
+            fr.nx[p] = n[p][0]; fr.ny[p] = n[p][1]; fr.nz[p] = n[p][2];
+            fr.d[p] = -(n[p][0] * eye[0] + n[p][1] * eye[1] + n[p][2] * eye[2]);
+        }
+        fr.d[0] -= nearZ;
+        fr.d[1] += farZ;
+        return fr;
+    }
+
+    bool TestAABB(const Bounds3& b) const {
+        float c[3] = { (b.minX + b.maxX) * 0.5f, (b.minY + b.maxY) * 0.5f, (b.minZ + b.maxZ) * 0.5f };
+        float e[3] = { (b.maxX - b.minX) * 0.5f, (b.maxY - b.minY) * 0.5f, (b.maxZ - b.minZ) * 0.5f };
+        for (int p = 0; p < 6; ++p) {
+            float dist = nx[p] * c[0] + ny[p] * c[1] + nz[p] * c[2] + d[p];
+            float proj = fabsf(nx[p]) * e[0] + fabsf(ny[p]) * e[1] + fabsf(nz[p]) * e[2];
+            if (dist < -proj) return false;
+        }
+        return true;
+    }
+
+    bool TestSphere(float x, float y, float z, float radius) const {
+        for (int p = 0; p < 6; ++p)
+            if (nx[p] * x + ny[p] * y + nz[p] * z + d[p] < -radius) return false;
+        return true;
+    }
+};
+
+struct BoundsSoA {
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;
+    std::vector<float> radius;
+
+    size_t Size() const { return count_; }
+
+    // Resize to n volumes; padding slots (NaN centers) never test visible
+    void Resize(size_t n) {
+        count_ = n;
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        size_t padded = n + kBatch;
+        centerX.assign(padded, nan); centerY.assign(padded, nan); centerZ.assign(padded, nan);
+        extentX.assign(padded, 0.0f); extentY.assign(padded, 0.0f); extentZ.assign(padded, 0.0f);
+        radius.assign(padded, 0.0f);
+    }
+
+    // Box plus a sphere around the box center (pass a radius >= the half diagonal to ignore it)
+    void Set(size_t i, const Bounds3& b, float sphereRadius) {
+        centerX[i] = (b.minX + b.maxX) * 0.5f; centerY[i] = (b.minY + b.maxY) * 0.5f; centerZ[i] = (b.minZ + b.maxZ) * 0.5f;
+        extentX[i] = (b.maxX - b.minX) * 0.5f; extentY[i] = (b.maxY - b.minY) * 0.5f; extentZ[i] = (b.maxZ - b.minZ) * 0.5f;
+        radius[i] = sphereRadius;
+    }
+
+private:
+    size_t count_ = 0;
+};
+
+// Reference implementation, also used when no SIMD instruction set is available
+inline uint32_t VisibleMask8Scalar(const BoundsSoA& s, size_t first, const Frustum& f) {
+    uint32_t mask = 0;
+    for (size_t k = 0; k < kBatch; ++k) {
+        size_t i = first + k;
+        bool visible = true;
+        for (int p = 0; p < 6 && visible; ++p) {
+            float dist = f.nx[p] * s.centerX[i] + f.ny[p] * s.centerY[i] + f.nz[p] * s.centerZ[i] + f.d[p];
+            float proj = fabsf(f.nx[p]) * s.extentX[i] + fabsf(f.ny[p]) * s.extentY[i] + fabsf(f.nz[p]) * s.extentZ[i];
+            if (s.radius[i] < proj) proj = s.radius[i];
+            visible = dist >= -proj;
+        }
+        mask |= (uint32_t)visible << k;
+    }
+    return mask;
+}
+
+inline uint32_t VisibleMask8(const BoundsSoA& s, size_t first, const Frustum& f) {
+#if defined(FRUSTUM_AVX)
+    const __m256 cx = _mm256_loadu_ps(&s.centerX[first]), cy = _mm256_loadu_ps(&s.centerY[first]), cz = _mm256_loadu_ps(&s.centerZ[first]);
+    const __m256 ex = _mm256_loadu_ps(&s.extentX[first]), ey = _mm256_loadu_ps(&s.extentY[first]), ez = _mm256_loadu_ps(&s.extentZ[first]);
+    const __m256 r = _mm256_loadu_ps(&s.radius[first]);
+    __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (int p = 0; p < 6; ++p) {
+        __m256 dist = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(f.nx[p]), cx), _mm256_mul_ps(_mm256_set1_ps(f.ny[p]), cy)),
+                                    _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(f.nz[p]), cz), _mm256_set1_ps(f.d[p])));
+        __m256 proj = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(fabsf(f.nx[p])), ex), _mm256_mul_ps(_mm256_set1_ps(fabsf(f.ny[p])), ey)),
+                                    _mm256_mul_ps(_mm256_set1_ps(fabsf(f.nz[p])), ez));
+        proj = _mm256_min_ps(proj, r);
+        visible = _mm256_and_ps(visible, _mm256_cmp_ps(_mm256_add_ps(dist, proj), _mm256_setzero_ps(), _CMP_GE_OQ));
+    }
+    return (uint32_t)_mm256_movemask_ps(visible);
+#elif defined(FRUSTUM_SSE)
+    uint32_t mask = 0;
+    for (size_t h = 0; h < kBatch; h += 4) {
+        size_t i = first + h;
+        const __m128 cx = _mm_loadu_ps(&s.centerX[i]), cy = _mm_loadu_ps(&s.centerY[i]), cz = _mm_loadu_ps(&s.centerZ[i]);
+        const __m128 ex = _mm_loadu_ps(&s.extentX[i]), ey = _mm_loadu_ps(&s.extentY[i]), ez = _mm_loadu_ps(&s.extentZ[i]);
+        const __m128 r = _mm_loadu_ps(&s.radius[i]);
+        __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(f.nx[p]), cx), _mm_mul_ps(_mm_set1_ps(f.ny[p]), cy)),
+                                     _mm_add_ps(_mm_mul_ps(_mm_set1_ps(f.nz[p]), cz), _mm_set1_ps(f.d[p])));
+            __m128 proj = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(fabsf(f.nx[p])), ex), _mm_mul_ps(_mm_set1_ps(fabsf(f.ny[p])), ey)),
+                                     _mm_mul_ps(_mm_set1_ps(fabsf(f.nz[p])), ez));
+            proj = _mm_min_ps(proj, r);
+            visible = _mm_and_ps(visible, _mm_cmpge_ps(_mm_add_ps(dist, proj), _mm_setzero_ps()));
+        }
+        mask |= (uint32_t)_mm_movemask_ps(visible) << h;
+    }
+    return mask;
+#else
+    return VisibleMask8Scalar(s, first, f);
+#endif
+}
+
+// visible[i] = 1 when volume i intersects the frustum, for i in [begin, end); begin must be a multiple of kBatch
+inline void Cull(const BoundsSoA& s, const Frustum& f, size_t begin, size_t end, std::vector<uint8_t>& visible) {
+    for (size_t first = begin; first < end; first += kBatch) {
+        uint32_t mask = VisibleMask8(s, first, f);
+        size_t n = end - first < kBatch ? end - first : kBatch;
+        for (size_t k = 0; k < n; ++k) visible[first + k] = (uint8_t)((mask >> k) & 1u);
+    }
+}
+
+} // namespace FrustumCulling
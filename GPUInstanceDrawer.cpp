@@ -0,0 +1,72 @@
+#include "GPUInstanceDrawer.h"
+#include "GameObject.h"
+#include "MeshRenderer.h"
+#include "JobSystem.h"
+
+void GPUInstanceDrawer::Initialize(size_t instances) {
+    buffers_[0].reserve(instances);
+    buffers_[1].reserve(instances);
+    queued_.reserve(instances);
+    slots_.reserve(instances);
+    groupOf_.reserve(instances);
+}
+
+void GPUInstanceDrawer::Begin() {
+    current_ ^= 1;
+    queued_.clear();
+    slots_.clear();
+    groupOf_.clear();
+    groups_.clear();
+    groupIndex_.clear();
+    stats_ = Stats();
+}
+
+int GPUInstanceDrawer::Add(MeshRenderer& renderer) {
+    if (!renderer.owner || !renderer.mesh_ || renderer.alpha_ < 255) return -1;
+    Key key = { renderer.GetDrawMesh().get(), renderer.shader_.get(), renderer.layer_, renderer.wireframe_ };
+    auto it = groupIndex_.find(key);
+    size_t group;
+    if (it == groupIndex_.end()) {
+        group = groups_.size();
+        groupIndex_.emplace(key, group);
+        groups_.push_back({ key, &renderer, 0, 0 });
+    } else {
+        group = it->second;
+    }
+    // count for now; UploadInstanceData turns it into a slot
+    slots_.push_back(groups_[group].count++);
+    groupOf_.push_back(group);
+    queued_.push_back(&renderer);
+    return (int)group;
+}
+
+void GPUInstanceDrawer::UploadInstanceData() {
+    size_t start = 0;
+    for (Group& g : groups_) {
+        g.start = start;
+        start += g.count;
+    }
+    for (size_t i = 0; i < queued_.size(); ++i) slots_[i] += groups_[groupOf_[i]].start;
+    std::vector<InstanceData>& buffer = buffers_[current_];
+    buffer.resize(queued_.size());
+    JobSystem::Instance().ParallelFor(queued_.size(), 1024, [&](size_t begin, size_t end, int) {
+        for (size_t i = begin; i < end; ++i) queued_[i]->GetInstanceData(buffer[slots_[i]]);
+    });
+    stats_.instances = (int)queued_.size();
+    stats_.groups = (int)groups_.size();
+    stats_.instanceBytes = buffer.size() * sizeof(InstanceData);
+}
+
+void GPUInstanceDrawer::DrawInstances(RenderBackend& gfx, const InstanceLight& light) {
+    for (size_t i = 0; i < groups_.size(); ++i) {
+        groups_[i].first->BindShader();
+        DrawGroup(gfx, i, light);
+    }
+}
+
+void GPUInstanceDrawer::DrawGroup(RenderBackend& gfx, size_t group, const InstanceLight& light) {
+    const Group& g = groups_[group];
+    InstanceGeometry geometry;
+    g.first->GetInstanceGeometry(geometry);
+    gfx.DrawInstances3D(geometry, buffers_[current_].data() + g.start, g.count, light);
+}
@@ -1,12 +1,79 @@
 #pragma once
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <cstddef>
+#include "RenderBackend.h"
 
-// GPUInstanceDrawer stub: manage GPU-side instance data and indirect draw
+struct Mesh;
+struct MeshRenderer;
+class Shader;
+
+// GPUInstanceDrawer: automatic instancing for MeshRenderers. Renderers queued during a frame are grouped
+// by (drawn mesh or LOD level, material) - the material being shader, fill mode and render layer, the per-renderer draw
+// state the backends and the render queue see - and their transforms and colours are packed group by
+// group into one instance buffer. Each group is drawn with a single DrawInstances3D call. Two instance buffers alternate between frames so a GPU
+// backend can still read the previous frame while the next one is written; both keep their capacity.
 class GPUInstanceDrawer {
 public:
+    struct Stats {
+        int instances = 0;
+        int groups = 0;          // = draw calls
+        size_t instanceBytes = 0; // size of the packed instance stream
+    };
+
     GPUInstanceDrawer() {}
     ~GPUInstanceDrawer() {}
 
-    void Initialize() {}
-    void UploadInstanceData() {}
-    void DrawInstances() {}
+    // Reserve room for `instances` entries in both buffers
+    void Initialize(size_t instances = 1024);
+    // Start a frame: switch to the other instance buffer and drop the previous queue
+    void Begin();
+    // Queue a renderer for this frame; returns its group, or -1 when it cannot be instanced (no mesh, or
+    // blended: those need their own back-to-front place in the render queue) and has to draw itself.
+    int Add(MeshRenderer& renderer);
+    // Group the queue and fill the current instance buffer (groups in first-queued order)
+    void UploadInstanceData();
+    // One DrawInstances3D per group, each after binding its first renderer's shader
+    void DrawInstances(RenderBackend& gfx, const InstanceLight& light);
+    // A single group's DrawInstances3D, with the shader left to the caller
+    void DrawGroup(RenderBackend& gfx, size_t group, const InstanceLight& light);
+
+    size_t GetGroupCount() const { return groups_.size(); }
+    // First renderer queued into a group: its shader, layer and geometry stand for the whole group
+    MeshRenderer* GetGroupRenderer(size_t group) const { return groups_[group].first; }
+
+    const std::vector<InstanceData>& GetInstanceBuffer() const { return buffers_[current_]; }
+    const Stats& GetStats() const { return stats_; }
+
+private:
+    struct Key {
+        const Mesh* mesh;
+        const Shader* shader;
+        int layer;
+        bool wireframe;
+        bool operator==(const Key& o) const {
+            return mesh == o.mesh && shader == o.shader && layer == o.layer && wireframe == o.wireframe;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            return std::hash<const void*>()(k.mesh) ^ (std::hash<const void*>()(k.shader) * 31) ^
+                   ((size_t)k.layer << 1) ^ (size_t)k.wireframe;
+        }
+    };
+    struct Group {
+        Key key;
+        MeshRenderer* first;  // geometry and shader source for the whole group
+        size_t start, count;  // range in the instance buffer
+    };
+
+    std::vector<InstanceData> buffers_[2];
+    int current_ = 0;
+    std::vector<MeshRenderer*> queued_;
+    std::vector<size_t> slots_;  // instance buffer slot of each queued renderer
+    std::vector<size_t> groupOf_;
+    std::vector<Group> groups_;
+    std::unordered_map<Key, size_t, KeyHash> groupIndex_;
+    Stats stats_;
 };
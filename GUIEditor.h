@@ -15,8 +15,8 @@ namespace GUIEditor {
 inline void DrawInspector(std::shared_ptr<GameObject> obj) {
     if (!obj) return;
     GUI::Label(400, 10, (std::string("Inspector: ") + obj->name()).c_str());
-    float x = obj->transform().x;
-    float y = obj->transform().y;
+    float x = obj->ctransform().x;
+    float y = obj->ctransform().y;
     DrawFormatString(400, 40, GetColor(255,255,255), "Position: %.1f, %.1f", x, y);
 
     // hbOňړ: Inspector̃{^Ȃ}EX𓮂
@@ -1,10 +1,43 @@
 #include "GameObject.h"
 #include "Component.h"
+#include <mutex>
 
 int GameObject::nextId_ = 1;
+unsigned int GameObject::componentsVersion_ = 0;
+
+namespace {
+    struct MovedQueue {
+        std::mutex mutex;
+        std::vector<GameObject*> objects;
+    };
+    // never destroyed: objects owned by other statics still unregister themselves during exit
+    MovedQueue& Moved() {
+        static MovedQueue* queue = new MovedQueue;
+        return *queue;
+    }
+}
 
 GameObject::GameObject(const std::string& name) : name_(name), id_(nextId_++) {}
-GameObject::~GameObject() {}
+GameObject::~GameObject() {
+    if (!moveQueued_.load()) return;
+    MovedQueue& moved = Moved();
+    std::lock_guard<std::mutex> lk(moved.mutex);
+    moved.objects.erase(std::remove(moved.objects.begin(), moved.objects.end(), this), moved.objects.end());
+}
+
+void GameObject::QueueMoved() {
+    MovedQueue& moved = Moved();
+    std::lock_guard<std::mutex> lk(moved.mutex);
+    moved.objects.push_back(this);
+}
+
+void GameObject::TakeMoved(std::vector<GameObject*>& out) {
+    out.clear();
+    MovedQueue& moved = Moved();
+    std::lock_guard<std::mutex> lk(moved.mutex);
+    out.swap(moved.objects);
+    for (GameObject* o : out) o->moveQueued_.store(false);
+}
 
 void GameObject::Awake() {
     for (auto& c : components_) {
@@ -28,6 +61,14 @@ void GameObject::Update() {
     }
 }
 
+void GameObject::FixedUpdate() {
+    if (prefab_) return;
+    if (!started_) Start();
+    for (auto& c : components_) {
+        if (c->enabled) c->FixedUpdate();
+    }
+}
+
 void GameObject::Render() {
     if (prefab_) return; // prefabs don't render in scene
     for (auto& c : components_) {
@@ -81,6 +122,7 @@ std::shared_ptr<GameObject> GameObject::Clone() const {
 void GameObject::RemoveComponentAt(size_t index) {
     if (index >= components_.size()) return;
     components_.erase(components_.begin() + index);
+    ++componentsVersion_;
 }
 
 void GameObject::ApplyFrom(const GameObject& src) {
@@ -96,4 +138,5 @@ void GameObject::ApplyFrom(const GameObject& src) {
         }
     }
     for (auto& comp : components_) comp->owner = this;
+    ++componentsVersion_;
 }
@@ -3,6 +3,7 @@
 #include <memory>
 #include <string>
 #include <algorithm>
+#include <atomic>
 #include "Component.h"
 #include "Transform.h"
 
@@ -16,6 +17,7 @@ public:
     void Awake();
     void Start();
     void Update();
+    void FixedUpdate();
     void Render();
 
     // Component̒ǉ
@@ -25,6 +27,7 @@ public:
         auto comp = std::make_shared<T>(std::forward<Args>(args)...);
         comp->owner = this;
         components_.push_back(comp);
+        ++componentsVersion_;
         comp->Awake();
         return comp;
     }
@@ -50,7 +53,17 @@ public:
     void RemoveComponentAt(size_t index);
 
     // Transform擾
-    Transform& transform() { return transform_; }
+    Transform& transform() { MarkMoved(); return transform_; }
+    // Read-only access; unlike transform() it doesn't mark the object moved
+    const Transform& ctransform() const { return transform_; }
+
+    // Queue the object for the scene's query refit. transform() does this implicitly; call it
+    // after changing a collider's extents or a renderer's mesh from code.
+    void MarkMoved() {
+        if (!moveQueued_.load(std::memory_order_relaxed) && !moveQueued_.exchange(true)) QueueMoved();
+    }
+    // Hand over (and clear) the objects marked since the last call
+    static void TakeMoved(std::vector<GameObject*>& out);
 
     // eq֌W
     void SetParent(std::shared_ptr<GameObject> parent);
@@ -77,12 +90,22 @@ public:
     // ŗLID
     int id() const { return id_; }
 
+    // Bumped whenever any object's component list changes (scenes re-index colliders / renderers)
+    static unsigned int ComponentsVersion() { return componentsVersion_; }
+
     // Prefab flag: mark an object as prefab template (will be ignored from scene updates)
     void SetPrefab(bool v) { prefab_ = v; }
     bool IsPrefab() const { return prefab_; }
 
 private:
+    // render-time overrides (pose interpolation, 2D camera offset) are undone exactly, so the
+    // scene writes transform_ directly instead of marking every object moved each frame
+    friend class Scene;
+    void QueueMoved();
+
     static int nextId_;
+    static unsigned int componentsVersion_;
+    std::atomic<bool> moveQueued_{ false };
     int id_;
     std::string name_;
     Transform transform_;
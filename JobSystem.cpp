@@ -0,0 +1,99 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <memory>
+
+JobSystem& JobSystem::Instance() {
+    static JobSystem inst;
+    return inst;
+}
+
+JobSystem::JobSystem() {
+    unsigned int hw = std::thread::hardware_concurrency();
+    int workerCount = (hw > 1) ? (int)hw - 1 : 0;
+    for (int i = 0; i < workerCount; ++i) {
+        workers_.emplace_back([this]() { WorkerLoop(); });
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& t : workers_) {
+        if (t.joinable()) t.join();
+    }
+}
+
+int JobSystem::ChunkCount(size_t count, size_t minBatch) const {
+    if (count == 0) return 0;
+    if (minBatch == 0) minBatch = 1;
+    size_t byBatch = (count + minBatch - 1) / minBatch;
+    return (int)std::min<size_t>(byBatch, (size_t)GetThreadCount());
+}
+
+void JobSystem::WorkerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lk(mutex_);
+            cv_.wait(lk, [this]() { return stopping_ || !queue_.empty(); });
+            if (stopping_ && queue_.empty()) return;
+            task = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        task();
+    }
+}
+
+void JobSystem::ParallelFor(size_t count, size_t minBatch, const std::function<void(size_t, size_t, int)>& fn) {
+    int chunks = ChunkCount(count, minBatch);
+    if (chunks == 0) return;
+    if (chunks == 1) {
+        fn(0, count, 0);
+        return;
+    }
+
+    size_t per = count / chunks;
+    size_t rem = count % chunks;
+    auto chunkBegin = [per, rem](int c) { return (size_t)c * per + std::min<size_t>((size_t)c, rem); };
+
+    // Chunks are claimed from a per-call counter: the calling thread and the queued helpers only ever run
+    // chunks of this call (never unrelated queued work), and helpers that start after every chunk was
+    // claimed return without touching `fn`. The state is shared so a late helper never outlives it.
+    struct Batch {
+        std::atomic<int> next{ 0 };
+        int done = 0;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto batch = std::make_shared<Batch>();
+    const std::function<void(size_t, size_t, int)>* body = &fn;
+    auto runChunks = [batch, body, chunks, chunkBegin]() {
+        int c;
+        while ((c = batch->next.fetch_add(1)) < chunks) {
+            (*body)(chunkBegin(c), chunkBegin(c + 1), c);
+            std::lock_guard<std::mutex> lk(batch->mutex);
+            if (++batch->done == chunks) batch->finished.notify_all();
+        }
+    };
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        for (int c = 1; c < chunks; ++c) queue_.push_back(runChunks);
+    }
+    cv_.notify_all();
+
+    // the calling thread works through the chunks too, then waits for the ones still running
+    runChunks();
+    std::unique_lock<std::mutex> lk(batch->mutex);
+    batch->finished.wait(lk, [&]() { return batch->done == chunks; });
+}
+
+void JobSystem::Submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        queue_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+// JobSystem: fixed-size worker pool shared by engine subsystems (physics, loaders, culling).
+// ParallelFor splits a range into contiguous chunks; chunk indices are stable so callers can
+// keep one output buffer per chunk and merge them in order for deterministic results.
+class JobSystem {
+public:
+    static JobSystem& Instance();
+
+    // Threads that take part in ParallelFor (workers + the calling thread)
+    int GetThreadCount() const { return (int)workers_.size() + 1; }
+
+    // Number of chunks ParallelFor will use for `count` items with at least `minBatch` items each
+    int ChunkCount(size_t count, size_t minBatch) const;
+
+    // Run fn(begin, end, chunkIndex) over [0, count). Blocks until every chunk has finished.
+    // The calling thread executes chunks of this call too (and nothing else from the queue), so it is
+    // safe to call from inside a job.
+    void ParallelFor(size_t count, size_t minBatch, const std::function<void(size_t, size_t, int)>& fn);
+
+    // Queue a fire-and-forget task (background loading etc.)
+    void Submit(std::function<void()> task);
+
+private:
+    JobSystem();
+    ~JobSystem();
+
+    void WorkerLoop();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> queue_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+};
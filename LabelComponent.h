@@ -1,6 +1,6 @@
 #pragma once
 #include "Component.h"
-#include "DxLib.h"
+#include "VectorMath.h"
 #include <string>
 
 // LabelComponent: eLXg`悷ėpR|[lg
@@ -10,10 +10,12 @@ struct LabelComponent : public Component {
     LabelComponent() : text(""), color(GetColor(255,255,255)) {}
     LabelComponent(const std::string& t, int c = GetColor(255,255,255)) : text(t), color(c) {}
     void Render() override {
+#if ENGINE_DXLIB // wbhXrhł͕͕`悵Ȃ
         if (!owner) return;
-        int x = static_cast<int>(owner->transform().x);
-        int y = static_cast<int>(owner->transform().y);
+        int x = static_cast<int>(owner->ctransform().x);
+        int y = static_cast<int>(owner->ctransform().y);
         DrawString(x, y, text.c_str(), color);
+#endif
     }
     std::shared_ptr<Component> Clone() const override { return std::make_shared<LabelComponent>(text, color); }
 };
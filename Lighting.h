@@ -1,5 +1,5 @@
 #pragma once
-#include "DxLib.h"
+#include "VectorMath.h"
 
 namespace Lighting {
     void SetMainDirectionalLight(float dirX, float dirY, float dirZ, int color, float intensity);
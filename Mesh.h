@@ -2,7 +2,14 @@
 #include <vector>
 #include <string>
 #include <array>
-#include "DxLib.h"
+#include <memory>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include "VectorMath.h"
+#include "AABBTree.h"
+
+class MeshBVH;
 
 struct Mesh {
     // geometry
@@ -55,15 +62,100 @@ struct Mesh {
     };
     std::vector<Animation> animations;
 
-    void DrawWireframe(const MATRIX& world) const {
-        // transform and draw edges (triangle list)
-        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
-            VECTOR v0 = VTransform(vertices[indices[i + 0]], world);
-            VECTOR v1 = VTransform(vertices[indices[i + 1]], world);
-            VECTOR v2 = VTransform(vertices[indices[i + 2]], world);
-            DrawLine3D(v0, v1, GetColor(200,200,200));
-            DrawLine3D(v1, v2, GetColor(200,200,200));
-            DrawLine3D(v2, v0, GetColor(200,200,200));
+    // triangle BVH for ray picking, built on first use by Scene::SyncQueryIndex on the main thread. The one
+    // field filled in after load, so it stays mutable on the const meshes MeshCache hands out.
+    mutable std::shared_ptr<MeshBVH> bvh;
+
+    // local-space bounding box and a sphere around its center, filled by the loaders.
+    // Code that edits vertices afterwards calls ComputeBounds again.
+    Bounds3 bounds;
+    float boundsRadius = 0.0f;
+    bool hasBounds = false;
+
+    // unique undirected edges and the (up to two) triangles sharing each, for wireframe drawing.
+    // Filled by the loaders in first-use order; face1 is -1 on open borders, and edges shared by more
+    // than two triangles keep the first two. Code that changes indices afterwards calls BuildEdges again.
+    struct Edge { int v0, v1; int face0, face1; };
+    std::vector<Edge> edges;
+    bool hasEdges = false;
+
+    // compact drawing streams written by MeshPacking::Pack: positions as unorm16 relative to the bounds,
+    // octahedral normals and half-float UVs, with 16-bit indices and edges when the counts fit. A packed mesh
+    // may have released vertices/normals/uvs (and indices/edges when 16-bit copies exist): the renderer
+    // draws from these streams and CPU code reads through MeshPacking::GetPositions/GetIndices.
+    struct Packed {
+        std::vector<uint16_t> positions; // xyz per vertex; position = offset + q * scale
+        float offset[3] = { 0.0f, 0.0f, 0.0f };
+        float scale[3] = { 0.0f, 0.0f, 0.0f };
+        std::vector<uint32_t> normals;   // snorm16 x | y << 16 of the octahedral projection
+        std::vector<uint32_t> uvs;       // half u | half v << 16
+        std::vector<uint16_t> indices;   // empty when the vertex count needs 32-bit indices
+        std::vector<uint16_t> edges;     // v0, v1, face0, face1 per edge (0xFFFF on open borders), when they fit
+        std::vector<uint32_t> edgeVertices; // otherwise v0, v1 per edge for meshes with normals (faces unused)
+        size_t vertexCount = 0;
+        size_t indexCount = 0;
+    };
+    std::shared_ptr<Packed> packed;
+
+    size_t VertexCount() const { return !vertices.empty() || !packed ? vertices.size() : packed->vertexCount; }
+    size_t TriangleCount() const { return (!indices.empty() || !packed ? indices.size() : packed->indexCount) / 3; }
+
+    // post-transform vertex cache efficiency of the index list before and after MeshOptimizer ran at import
+    struct VertexCacheStats { float acmr = 0.0f; float atvr = 0.0f; };
+    VertexCacheStats cacheStatsBefore, cacheStatsAfter;
+
+    void ComputeBounds() {
+        bounds = Bounds3();
+        boundsRadius = 0.0f;
+        hasBounds = !vertices.empty();
+        if (!hasBounds) return;
+        bounds.minX = bounds.maxX = vertices[0].x;
+        bounds.minY = bounds.maxY = vertices[0].y;
+        bounds.minZ = bounds.maxZ = vertices[0].z;
+        for (const VECTOR& v : vertices) {
+            bounds.minX = std::min(bounds.minX, v.x); bounds.maxX = std::max(bounds.maxX, v.x);
+            bounds.minY = std::min(bounds.minY, v.y); bounds.maxY = std::max(bounds.maxY, v.y);
+            bounds.minZ = std::min(bounds.minZ, v.z); bounds.maxZ = std::max(bounds.maxZ, v.z);
+        }
+        float cx = (bounds.minX + bounds.maxX) * 0.5f, cy = (bounds.minY + bounds.maxY) * 0.5f, cz = (bounds.minZ + bounds.maxZ) * 0.5f;
+        float r2 = 0.0f;
+        for (const VECTOR& v : vertices) {
+            float dx = v.x - cx, dy = v.y - cy, dz = v.z - cz;
+            float d2 = dx * dx + dy * dy + dz * dz;
+            if (d2 > r2) r2 = d2;
+        }
+        boundsRadius = sqrtf(r2);
+    }
+
+    void BuildEdges() {
+        edges.clear();
+        hasEdges = true;
+        const size_t faces = indices.size() / 3;
+        if (faces == 0) return;
+        // open-addressing map from (min vertex, max vertex) to edge index, at most half full
+        size_t capacity = 16;
+        while (capacity < faces * 3 * 2) capacity <<= 1;
+        std::vector<uint64_t> keys(capacity);
+        std::vector<int> slots(capacity, -1);
+        const size_t mask = capacity - 1;
+        edges.reserve(faces * 3 / 2 + 1);
+        for (size_t f = 0; f < faces; ++f) {
+            for (int k = 0; k < 3; ++k) {
+                int a = indices[f * 3 + k], b = indices[f * 3 + (k + 1) % 3];
+                if (a == b) continue;
+                if (a > b) std::swap(a, b);
+                uint64_t key = ((uint64_t)(uint32_t)a << 32) | (uint32_t)b;
+                size_t h = (size_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+                while (slots[h] >= 0 && keys[h] != key) h = (h + 1) & mask;
+                if (slots[h] < 0) {
+                    keys[h] = key;
+                    slots[h] = (int)edges.size();
+                    edges.push_back({ a, b, (int)f, -1 });
+                } else {
+                    Edge& e = edges[slots[h]];
+                    if (e.face1 < 0 && e.face0 != (int)f) e.face1 = (int)f;
+                }
+            }
         }
     }
 };
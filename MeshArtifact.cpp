@@ -0,0 +1,400 @@
+#include "MeshArtifact.h"
+#include "ObjLoader.h"
+#include "third_party/ModelLoader.h"
+#include "MappedFile.h"
+#include "AssetDatabase.h"
+#include <fstream>
+#include <chrono>
+#include <cstring>
+#include <cstddef>
+#include <cstdio>
+#include <cctype>
+#include <sys/stat.h>
+
+namespace {
+    const uint32_t kMagic = 0x3148534D; // "MSH1"
+    const size_t kAlignment = 16;       // every stream starts 16-byte aligned in the file
+
+    enum Section { Positions, Normals, UVs, Indices, SubMeshes, Edges, BoneIndices, BoneWeights, BoneOffsets, Records, SectionCount };
+    enum Flags { HasBounds = 1, HasEdges = 2 };
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t sourceSize;
+        int64_t sourceTime;
+        uint64_t contentHash;
+        float bounds[6];
+        float boundsRadius;
+        uint32_t flags;
+        float cacheStats[4];            // ACMR, ATVR before and after MeshOptimizer
+        uint32_t boneCount;
+        uint32_t animationCount;
+        uint64_t offsets[SectionCount]; // from the start of the file
+        uint64_t counts[SectionCount];  // elements; bytes for Records
+    };
+
+    // SubMesh with a fixed layout (size_t differs between x86 and x64)
+    struct StoredSubMesh { uint64_t indexStart, indexCount; int32_t materialIndex, pad; };
+
+    const size_t kElementSize[SectionCount] = {
+        sizeof(VECTOR), sizeof(VECTOR), sizeof(VECTOR), sizeof(int), sizeof(StoredSubMesh), sizeof(Mesh::Edge),
+        sizeof(std::array<int, 4>), sizeof(std::array<float, 4>), sizeof(MATRIX), 1,
+    };
+
+    uint64_t Fnv1a(const void* data, size_t bytes, uint64_t h = 14695981039346656037ull) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < bytes; ++i) h = (h ^ p[i]) * 1099511628211ull;
+        return h;
+    }
+
+    bool StatSource(const std::string& path, uint64_t& size, int64_t& time) {
+#ifdef _WIN32
+        struct _stat64 st;
+        if (_stat64(path.c_str(), &st) != 0) return false;
+#else
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) return false;
+#endif
+        size = (uint64_t)st.st_size;
+        time = (int64_t)st.st_mtime;
+        return true;
+    }
+
+    double MsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Materials, bone names, nodes and animations: length-prefixed fields in one byte stream
+    class RecordWriter {
+    public:
+        template<typename T> void Pod(const T& v) { bytes.append(reinterpret_cast<const char*>(&v), sizeof(T)); }
+        void String(const std::string& s) {
+            Pod((uint32_t)s.size());
+            bytes.append(s);
+        }
+        template<typename T> void Array(const std::vector<T>& v) {
+            Pod((uint32_t)v.size());
+            if (!v.empty()) bytes.append(reinterpret_cast<const char*>(v.data()), sizeof(T) * v.size());
+        }
+        std::string bytes;
+    };
+
+    class RecordReader {
+    public:
+        RecordReader(const char* p, size_t size) : p_(p), end_(p + size) {}
+        template<typename T> bool Pod(T& v) {
+            if ((size_t)(end_ - p_) < sizeof(T)) return false;
+            memcpy(&v, p_, sizeof(T));
+            p_ += sizeof(T);
+            return true;
+        }
+        bool String(std::string& s) {
+            uint32_t n;
+            if (!Pod(n) || (size_t)(end_ - p_) < n) return false;
+            s.assign(p_, n);
+            p_ += n;
+            return true;
+        }
+        template<typename T> bool Array(std::vector<T>& v) {
+            uint32_t n;
+            if (!Pod(n) || (size_t)(end_ - p_) / sizeof(T) < n) return false;
+            v.resize(n);
+            if (n) memcpy(v.data(), p_, sizeof(T) * n);
+            p_ += sizeof(T) * n;
+            return true;
+        }
+    private:
+        const char* p_;
+        const char* end_;
+    };
+
+    std::string WriteRecords(const Mesh& mesh) {
+        RecordWriter w;
+        w.Pod((uint32_t)mesh.materials.size());
+        for (const Mesh::Material& m : mesh.materials) {
+            w.String(m.name);
+            w.Pod(m.diffuseColor);
+            w.String(m.diffuseTexture);
+        }
+        w.Pod((uint32_t)mesh.boneNames.size());
+        for (const std::string& name : mesh.boneNames) w.String(name);
+        w.Pod((uint32_t)mesh.nodes.size());
+        for (const Mesh::Node& n : mesh.nodes) {
+            w.String(n.name);
+            w.Pod(n.parent);
+            w.Pod(n.transform);
+            w.Array(n.children);
+        }
+        w.Pod((uint32_t)mesh.animations.size());
+        for (const Mesh::Animation& a : mesh.animations) {
+            w.String(a.name);
+            w.Pod(a.duration);
+            w.Pod(a.ticksPerSecond);
+            w.Pod((uint32_t)a.channels.size());
+            for (const Mesh::AnimChannel& c : a.channels) {
+                w.String(c.nodeName);
+                w.Array(c.positions);
+                w.Array(c.rotations);
+                w.Array(c.scales);
+            }
+        }
+        return w.bytes;
+    }
+
+    bool ReadRecords(const char* data, size_t size, Mesh& mesh) {
+        RecordReader r(data, size);
+        uint32_t count;
+        if (!r.Pod(count)) return false;
+        mesh.materials.resize(count);
+        for (Mesh::Material& m : mesh.materials)
+            if (!r.String(m.name) || !r.Pod(m.diffuseColor) || !r.String(m.diffuseTexture)) return false;
+        if (!r.Pod(count)) return false;
+        mesh.boneNames.resize(count);
+        for (std::string& name : mesh.boneNames)
+            if (!r.String(name)) return false;
+        if (!r.Pod(count)) return false;
+        mesh.nodes.resize(count);
+        for (Mesh::Node& n : mesh.nodes)
+            if (!r.String(n.name) || !r.Pod(n.parent) || !r.Pod(n.transform) || !r.Array(n.children)) return false;
+        if (!r.Pod(count)) return false;
+        mesh.animations.resize(count);
+        for (Mesh::Animation& a : mesh.animations) {
+            if (!r.String(a.name) || !r.Pod(a.duration) || !r.Pod(a.ticksPerSecond) || !r.Pod(count)) return false;
+            a.channels.resize(count);
+            for (Mesh::AnimChannel& c : a.channels)
+                if (!r.String(c.nodeName) || !r.Array(c.positions) || !r.Array(c.rotations) || !r.Array(c.scales)) return false;
+        }
+        return true;
+    }
+
+    template<typename T>
+    void CopyStream(const char* data, const Header& h, Section s, std::vector<T>& out) {
+        const T* p = reinterpret_cast<const T*>(data + h.offsets[s]);
+        out.assign(p, p + h.counts[s]);
+    }
+
+    // header of a mapped artifact, or nullptr when it isn't one this build can read
+    const Header* GetHeader(const MappedFile& file) {
+        if (!file.IsOpen() || file.Size() < sizeof(Header)) return nullptr;
+        const Header* h = reinterpret_cast<const Header*>(file.Data());
+        if (h->magic != kMagic || h->version != MeshArtifact::kImporterVersion) return nullptr;
+        return h;
+    }
+
+    enum class Freshness { Stale, Current, Touched };
+
+    // Whether an artifact still matches its source. A source with a new write time but the same bytes
+    // is Touched: the artifact is valid and only needs the new time recorded.
+    Freshness CheckSource(const Header& h, const std::string& sourcePath) {
+        uint64_t size;
+        int64_t time;
+        if (!StatSource(sourcePath, size, time)) return Freshness::Current; // shipped without sources
+        if (size != h.sourceSize) return Freshness::Stale;
+        if (time == h.sourceTime) return Freshness::Current;
+        MappedFile source(sourcePath);
+        if (!source.IsOpen() || MeshArtifact::HashContent(source.Data(), source.Size()) != h.contentHash) return Freshness::Stale;
+        return Freshness::Touched;
+    }
+
+    void RecordSourceTime(const std::string& artifactPath, const std::string& sourcePath) {
+        uint64_t size;
+        int64_t time;
+        if (!StatSource(sourcePath, size, time)) return;
+        std::fstream f(artifactPath, std::ios::binary | std::ios::in | std::ios::out);
+        if (!f) return;
+        f.seekp(offsetof(Header, sourceTime));
+        f.write(reinterpret_cast<const char*>(&time), sizeof(time));
+    }
+
+    std::shared_ptr<Mesh> Import(const std::string& sourcePath) {
+        std::string ext = sourcePath.size() >= 4 ? sourcePath.substr(sourcePath.size() - 4) : std::string();
+        for (auto& c : ext) c = (char)tolower((unsigned char)c);
+        if (ext == ".obj" || sourcePath.size() < 4) return ObjLoader::LoadObj(sourcePath);
+        return ModelLoader::LoadModel(sourcePath);
+    }
+}
+
+namespace MeshArtifact {
+
+uint64_t HashContent(const char* data, size_t size) {
+    // FNV-style mixing a word at a time; fast enough to run on every changed file
+    uint64_t h = 14695981039346656037ull ^ (uint64_t)size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t w;
+        memcpy(&w, data + i, 8);
+        h = (h ^ w) * 1099511628211ull;
+        h ^= h >> 32;
+    }
+    return Fnv1a(data + i, size - i, h);
+}
+
+std::string GetArtifactPath(const std::string& sourcePath, const char* extension) {
+    std::string guid = AssetDatabase::Instance().GetGUID(sourcePath);
+    if (guid.empty()) {
+        char hex[17];
+        snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)Fnv1a(sourcePath.data(), sourcePath.size()));
+        guid = hex;
+    }
+    return "Library/" + guid + extension;
+}
+
+bool Save(const std::string& path, const Mesh& mesh, uint64_t sourceSize, int64_t sourceTime, uint64_t contentHash) {
+    std::vector<StoredSubMesh> submeshes;
+    for (const Mesh::SubMesh& s : mesh.submeshes) submeshes.push_back({ s.indexStart, s.indexCount, s.materialIndex, 0 });
+    const std::string records = WriteRecords(mesh);
+    const void* streams[SectionCount] = {
+        mesh.vertices.data(), mesh.normals.data(), mesh.uvs.data(), mesh.indices.data(), submeshes.data(),
+        mesh.edges.data(), mesh.boneIndices.data(), mesh.boneWeights.data(), mesh.boneOffsetMatrices.data(), records.data(),
+    };
+
+    Header h = {};
+    h.magic = kMagic;
+    h.version = kImporterVersion;
+    h.sourceSize = sourceSize;
+    h.sourceTime = sourceTime;
+    h.contentHash = contentHash;
+    h.bounds[0] = mesh.bounds.minX; h.bounds[1] = mesh.bounds.minY; h.bounds[2] = mesh.bounds.minZ;
+    h.bounds[3] = mesh.bounds.maxX; h.bounds[4] = mesh.bounds.maxY; h.bounds[5] = mesh.bounds.maxZ;
+    h.boundsRadius = mesh.boundsRadius;
+    h.flags = (mesh.hasBounds ? HasBounds : 0) | (mesh.hasEdges ? HasEdges : 0);
+    h.cacheStats[0] = mesh.cacheStatsBefore.acmr; h.cacheStats[1] = mesh.cacheStatsBefore.atvr;
+    h.cacheStats[2] = mesh.cacheStatsAfter.acmr; h.cacheStats[3] = mesh.cacheStatsAfter.atvr;
+    h.boneCount = (uint32_t)mesh.boneNames.size();
+    h.animationCount = (uint32_t)mesh.animations.size();
+    h.counts[Positions] = mesh.vertices.size();
+    h.counts[Normals] = mesh.normals.size();
+    h.counts[UVs] = mesh.uvs.size();
+    h.counts[Indices] = mesh.indices.size();
+    h.counts[SubMeshes] = submeshes.size();
+    h.counts[Edges] = mesh.edges.size();
+    h.counts[BoneIndices] = mesh.boneIndices.size();
+    h.counts[BoneWeights] = mesh.boneWeights.size();
+    h.counts[BoneOffsets] = mesh.boneOffsetMatrices.size();
+    h.counts[Records] = records.size();
+    uint64_t offset = sizeof(Header);
+    for (int s = 0; s < SectionCount; ++s) {
+        offset = (offset + kAlignment - 1) & ~(uint64_t)(kAlignment - 1);
+        h.offsets[s] = offset;
+        offset += h.counts[s] * kElementSize[s];
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    uint64_t written = sizeof(Header);
+    const char zeros[kAlignment] = {};
+    for (int s = 0; s < SectionCount; ++s) {
+        out.write(zeros, (std::streamsize)(h.offsets[s] - written));
+        size_t bytes = (size_t)(h.counts[s] * kElementSize[s]);
+        if (bytes) out.write(static_cast<const char*>(streams[s]), bytes);
+        written = h.offsets[s] + bytes;
+    }
+    return (bool)out;
+}
+
+std::shared_ptr<Mesh> Read(const char* data, size_t size) {
+    if (size < sizeof(Header)) return nullptr;
+    Header h;
+    memcpy(&h, data, sizeof(h));
+    if (h.magic != kMagic || h.version != kImporterVersion) return nullptr;
+    for (int s = 0; s < SectionCount; ++s) {
+        if (h.offsets[s] > size || h.counts[s] > (size - h.offsets[s]) / kElementSize[s]) return nullptr;
+    }
+
+    auto mesh = std::make_shared<Mesh>();
+    CopyStream(data, h, Positions, mesh->vertices);
+    CopyStream(data, h, Normals, mesh->normals);
+    CopyStream(data, h, UVs, mesh->uvs);
+    CopyStream(data, h, Indices, mesh->indices);
+    CopyStream(data, h, Edges, mesh->edges);
+    CopyStream(data, h, BoneIndices, mesh->boneIndices);
+    CopyStream(data, h, BoneWeights, mesh->boneWeights);
+    CopyStream(data, h, BoneOffsets, mesh->boneOffsetMatrices);
+    std::vector<StoredSubMesh> submeshes;
+    CopyStream(data, h, SubMeshes, submeshes);
+    if (!ReadRecords(data + h.offsets[Records], (size_t)h.counts[Records], *mesh)) return nullptr;
+
+    const size_t vertexCount = mesh->vertices.size();
+    for (int index : mesh->indices)
+        if (index < 0 || (size_t)index >= vertexCount) return nullptr;
+    for (const Mesh::Edge& e : mesh->edges)
+        if (e.v0 < 0 || e.v1 < 0 || (size_t)e.v0 >= vertexCount || (size_t)e.v1 >= vertexCount) return nullptr;
+    for (const StoredSubMesh& s : submeshes)
+        mesh->submeshes.push_back({ (size_t)s.indexStart, (size_t)s.indexCount, s.materialIndex });
+
+    mesh->bounds.minX = h.bounds[0]; mesh->bounds.minY = h.bounds[1]; mesh->bounds.minZ = h.bounds[2];
+    mesh->bounds.maxX = h.bounds[3]; mesh->bounds.maxY = h.bounds[4]; mesh->bounds.maxZ = h.bounds[5];
+    mesh->boundsRadius = h.boundsRadius;
+    mesh->hasBounds = (h.flags & HasBounds) != 0;
+    mesh->hasEdges = (h.flags & HasEdges) != 0;
+    mesh->cacheStatsBefore.acmr = h.cacheStats[0]; mesh->cacheStatsBefore.atvr = h.cacheStats[1];
+    mesh->cacheStatsAfter.acmr = h.cacheStats[2]; mesh->cacheStatsAfter.atvr = h.cacheStats[3];
+    return mesh;
+}
+
+std::shared_ptr<Mesh> Load(const std::string& sourcePath, LoadInfo* info) {
+    auto start = std::chrono::steady_clock::now();
+    const std::string artifactPath = GetArtifactPath(sourcePath);
+    Freshness freshness = Freshness::Stale;
+    std::shared_ptr<Mesh> mesh;
+    size_t artifactBytes = 0;
+    {
+        MappedFile file(artifactPath);
+        const Header* h = GetHeader(file);
+        if (h) freshness = CheckSource(*h, sourcePath);
+        if (freshness != Freshness::Stale) mesh = Read(file.Data(), file.Size());
+        artifactBytes = file.Size();
+    }
+    if (mesh) {
+        // the mapping is closed: the artifact can be written now
+        if (freshness == Freshness::Touched) RecordSourceTime(artifactPath, sourcePath);
+        if (info) { info->imported = false; info->artifactBytes = artifactBytes; info->ms = MsSince(start); }
+        return mesh;
+    }
+
+    mesh = Import(sourcePath);
+    if (!mesh) return nullptr;
+    uint64_t size = 0;
+    int64_t time = 0;
+    uint64_t hash = 0;
+    if (StatSource(sourcePath, size, time)) {
+        MappedFile source(sourcePath);
+        if (source.IsOpen()) hash = HashContent(source.Data(), source.Size());
+        // best effort: without Library/ the model is imported again next time
+        Save(artifactPath, *mesh, size, time, hash);
+    }
+    if (info) {
+        info->imported = true;
+        MappedFile written(artifactPath);
+        info->artifactBytes = written.Size();
+        info->ms = MsSince(start);
+    }
+    return mesh;
+}
+
+bool GetSummary(const std::string& sourcePath, Summary& out) {
+    {
+        MappedFile file(GetArtifactPath(sourcePath));
+        const Header* h = GetHeader(file);
+        if (h && CheckSource(*h, sourcePath) != Freshness::Stale) {
+            out.vertices = (size_t)h->counts[Positions];
+            out.triangles = (size_t)h->counts[Indices] / 3;
+            out.submeshes = (size_t)h->counts[SubMeshes];
+            out.bones = h->boneCount;
+            out.animations = h->animationCount;
+            return true;
+        }
+    }
+    auto mesh = Load(sourcePath);
+    if (!mesh) return false;
+    out.vertices = mesh->vertices.size();
+    out.triangles = mesh->indices.size() / 3;
+    out.submeshes = mesh->submeshes.size();
+    out.bones = mesh->boneNames.size();
+    out.animations = mesh->animations.size();
+    return true;
+}
+
+} // namespace MeshArtifact
@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include "Mesh.h"
+
+// MeshArtifact: imported meshes cached as binary files in Library/, so a model is parsed from text (OBJ)
+// or through Assimp once and every later load maps the artifact and copies its streams out. An artifact
+// is named after the asset GUID and records the importer version and the source file's size, write time
+// and content hash; a source that was only touched keeps its artifact.
+namespace MeshArtifact {
+
+// Bump when an importer (ObjLoader, ModelLoader, MeshOptimizer) or the artifact layout changes;
+// older artifacts are reimported
+const uint32_t kImporterVersion = 1;
+
+struct LoadInfo {
+    bool imported = false;     // parsed from the source (and artifact written) rather than mapped
+    size_t artifactBytes = 0;
+    double ms = 0.0;
+};
+
+// What an artifact holds, readable without loading the mesh
+struct Summary {
+    size_t vertices = 0;
+    size_t triangles = 0;
+    size_t submeshes = 0;
+    size_t bones = 0;
+    size_t animations = 0;
+};
+
+// The mesh for a model file (.obj through ObjLoader, anything else through ModelLoader): from its
+// artifact when it is up to date, otherwise imported and written back. nullptr when the import fails.
+std::shared_ptr<Mesh> Load(const std::string& sourcePath, LoadInfo* info = nullptr);
+
+// Header of the model's artifact, importing it first when missing or stale
+bool GetSummary(const std::string& sourcePath, Summary& out);
+
+// Library/<asset guid><extension>, or a hash of the path for files outside the AssetDatabase
+std::string GetArtifactPath(const std::string& sourcePath, const char* extension = ".mesh");
+
+// Artifact I/O for a mesh imported from a source whose stamp (size, write time, content hash) is given
+bool Save(const std::string& path, const Mesh& mesh, uint64_t sourceSize, int64_t sourceTime, uint64_t contentHash);
+std::shared_ptr<Mesh> Read(const char* data, size_t size);
+
+// Change detection hash of a file's bytes
+uint64_t HashContent(const char* data, size_t size);
+
+} // namespace MeshArtifact
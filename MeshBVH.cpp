@@ -0,0 +1,224 @@
+#include "MeshBVH.h"
+#include "Mesh.h"
+#include "MeshPacking.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const int kBins = 12;
+    const int kMaxLeafTriangles = 4;
+
+    void Grow(Bounds3& b, const float p[3]) {
+        b.minX = std::min(b.minX, p[0]); b.maxX = std::max(b.maxX, p[0]);
+        b.minY = std::min(b.minY, p[1]); b.maxY = std::max(b.maxY, p[1]);
+        b.minZ = std::min(b.minZ, p[2]); b.maxZ = std::max(b.maxZ, p[2]);
+    }
+
+    Bounds3 EmptyBounds() {
+        Bounds3 b;
+        b.minX = b.minY = b.minZ = INFINITY;
+        b.maxX = b.maxY = b.maxZ = -INFINITY;
+        return b;
+    }
+
+    float HalfArea(const Bounds3& b) {
+        if (b.maxX < b.minX) return 0.0f;
+        float dx = b.maxX - b.minX, dy = b.maxY - b.minY, dz = b.maxZ - b.minZ;
+        return dx * dy + dy * dz + dz * dx;
+    }
+}
+
+void MeshBVH::Build(const Mesh& mesh) {
+    nodes_.clear();
+    triangles_.clear();
+    bounds_ = Bounds3();
+
+    // packed meshes (MeshPacking) are decoded for the build
+    ScratchArena& arena = ScratchArena::ForThread();
+    ScratchArena::Scope scope(arena);
+    const VECTOR* vertices = MeshPacking::GetPositions(mesh, arena);
+    const int* indices = MeshPacking::GetIndices(mesh, arena);
+    const size_t vcount = mesh.VertexCount();
+    const size_t icount = mesh.TriangleCount() * 3;
+    std::vector<Bounds3> triBounds;
+    std::vector<float> centroids;
+    for (size_t i = 0; i + 2 < icount; i += 3) {
+        int i0 = indices[i], i1 = indices[i + 1], i2 = indices[i + 2];
+        if (i0 < 0 || i1 < 0 || i2 < 0 || (size_t)i0 >= vcount || (size_t)i1 >= vcount || (size_t)i2 >= vcount) continue;
+        const VECTOR& a = vertices[i0];
+        const VECTOR& b = vertices[i1];
+        const VECTOR& c = vertices[i2];
+        Triangle t;
+        t.v0[0] = a.x; t.v0[1] = a.y; t.v0[2] = a.z;
+        t.e1[0] = b.x - a.x; t.e1[1] = b.y - a.y; t.e1[2] = b.z - a.z;
+        t.e2[0] = c.x - a.x; t.e2[1] = c.y - a.y; t.e2[2] = c.z - a.z;
+        t.index = (int)(i / 3);
+        triangles_.push_back(t);
+
+        Bounds3 tb = EmptyBounds();
+        float pa[3] = { a.x, a.y, a.z }, pb[3] = { b.x, b.y, b.z }, pc[3] = { c.x, c.y, c.z };
+        Grow(tb, pa); Grow(tb, pb); Grow(tb, pc);
+        triBounds.push_back(tb);
+        centroids.push_back((tb.minX + tb.maxX) * 0.5f);
+        centroids.push_back((tb.minY + tb.maxY) * 0.5f);
+        centroids.push_back((tb.minZ + tb.maxZ) * 0.5f);
+    }
+    if (triangles_.empty()) return;
+
+    // triangle order is permuted through `order`; nodes reference ranges of it
+    std::vector<int> order(triangles_.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = (int)i;
+    nodes_.reserve(triangles_.size() * 2);
+
+    struct Task { int node, first, count; };
+    std::vector<Task> stack;
+    nodes_.emplace_back();
+    stack.push_back({ 0, 0, (int)order.size() });
+    while (!stack.empty()) {
+        Task task = stack.back();
+        stack.pop_back();
+
+        Bounds3 nb = EmptyBounds(), cb = EmptyBounds();
+        for (int k = task.first; k < task.first + task.count; ++k) {
+            int t = order[k];
+            nb = Bounds3::Union(nb, triBounds[t]);
+            Grow(cb, &centroids[t * 3]);
+        }
+        nodes_[task.node].bounds = nb;
+
+        int axis = -1, split = -1;
+        if (task.count > kMaxLeafTriangles) {
+            // binned SAH over the widest centroid axis
+            float ext[3] = { cb.maxX - cb.minX, cb.maxY - cb.minY, cb.maxZ - cb.minZ };
+            float lo[3] = { cb.minX, cb.minY, cb.minZ };
+            axis = ext[0] > ext[1] ? (ext[0] > ext[2] ? 0 : 2) : (ext[1] > ext[2] ? 1 : 2);
+            if (ext[axis] > 0.0f) {
+                Bounds3 binBounds[kBins];
+                int binCount[kBins] = {};
+                for (int b = 0; b < kBins; ++b) binBounds[b] = EmptyBounds();
+                float scale = kBins / ext[axis];
+                for (int k = task.first; k < task.first + task.count; ++k) {
+                    int t = order[k];
+                    int b = std::min(kBins - 1, (int)((centroids[t * 3 + axis] - lo[axis]) * scale));
+                    binCount[b]++;
+                    binBounds[b] = Bounds3::Union(binBounds[b], triBounds[t]);
+                }
+                float rightArea[kBins];
+                int rightCount[kBins];
+                Bounds3 acc = EmptyBounds();
+                int n = 0;
+                for (int b = kBins - 1; b > 0; --b) {
+                    acc = Bounds3::Union(acc, binBounds[b]);
+                    n += binCount[b];
+                    rightArea[b] = HalfArea(acc);
+                    rightCount[b] = n;
+                }
+                float best = HalfArea(nb) * task.count; // cost of keeping a leaf
+                acc = EmptyBounds();
+                n = 0;
+                for (int b = 0; b < kBins - 1; ++b) {
+                    acc = Bounds3::Union(acc, binBounds[b]);
+                    n += binCount[b];
+                    float cost = HalfArea(acc) * n + rightArea[b + 1] * rightCount[b + 1];
+                    if (n > 0 && rightCount[b + 1] > 0 && cost < best) { best = cost; split = b + 1; }
+                }
+                if (split >= 0) {
+                    auto mid = std::partition(order.begin() + task.first, order.begin() + task.first + task.count, [&](int t) {
+                        return std::min(kBins - 1, (int)((centroids[t * 3 + axis] - lo[axis]) * scale)) < split;
+                    });
+                    int leftCount = (int)(mid - (order.begin() + task.first));
+                    // children are allocated as a pair: right = left + 1
+                    int left = (int)nodes_.size();
+                    int right = left + 1;
+                    nodes_.emplace_back();
+                    nodes_.emplace_back();
+                    nodes_[task.node].first = left;
+                    nodes_[task.node].count = 0;
+                    stack.push_back({ right, task.first + leftCount, task.count - leftCount });
+                    stack.push_back({ left, task.first, leftCount });
+                    continue;
+                }
+            }
+        }
+        nodes_[task.node].first = task.first;
+        nodes_[task.node].count = task.count;
+    }
+
+    // store triangles in leaf order so leaves read contiguous memory
+    std::vector<Triangle> sorted(triangles_.size());
+    for (size_t i = 0; i < order.size(); ++i) sorted[i] = triangles_[order[i]];
+    triangles_.swap(sorted);
+    bounds_ = nodes_[0].bounds;
+}
+
+bool MeshBVH::Raycast(float ox, float oy, float oz, float dx, float dy, float dz, float maxT,
+                      float& outT, int& outTriangle, float& nx, float& ny, float& nz) const {
+    if (nodes_.empty()) return false;
+    const float inf = INFINITY;
+    float invX = dx != 0.0f ? 1.0f / dx : inf;
+    float invY = dy != 0.0f ? 1.0f / dy : inf;
+    float invZ = dz != 0.0f ? 1.0f / dz : inf;
+
+    int hit = -1;
+    float best = maxT;
+    int stackBuf[64];
+    std::vector<int> overflow;
+    int sp = 0;
+    stackBuf[sp++] = 0;
+    auto push = [&](int id) {
+        if (sp < 64) stackBuf[sp++] = id;
+        else overflow.push_back(id);
+    };
+    while (sp > 0 || !overflow.empty()) {
+        int id;
+        if (!overflow.empty()) { id = overflow.back(); overflow.pop_back(); }
+        else id = stackBuf[--sp];
+        const Node& node = nodes_[id];
+        float tEnter;
+        if (!node.bounds.RayHit(ox, oy, oz, invX, invY, invZ, best, tEnter)) continue;
+        if (node.count > 0) {
+            for (int k = node.first; k < node.first + node.count; ++k) {
+                // Moller-Trumbore
+                const Triangle& t = triangles_[k];
+                float px = dy * t.e2[2] - dz * t.e2[1];
+                float py = dz * t.e2[0] - dx * t.e2[2];
+                float pz = dx * t.e2[1] - dy * t.e2[0];
+                float det = t.e1[0] * px + t.e1[1] * py + t.e1[2] * pz;
+                if (fabsf(det) < 1e-12f) continue;
+                float inv = 1.0f / det;
+                float sx = ox - t.v0[0], sy = oy - t.v0[1], sz = oz - t.v0[2];
+                float u = (sx * px + sy * py + sz * pz) * inv;
+                if (u < 0.0f || u > 1.0f) continue;
+                float qx = sy * t.e1[2] - sz * t.e1[1];
+                float qy = sz * t.e1[0] - sx * t.e1[2];
+                float qz = sx * t.e1[1] - sy * t.e1[0];
+                float v = (dx * qx + dy * qy + dz * qz) * inv;
+                if (v < 0.0f || u + v > 1.0f) continue;
+                float tt = (t.e2[0] * qx + t.e2[1] * qy + t.e2[2] * qz) * inv;
+                if (tt < 0.0f || tt > best) continue;
+                best = tt;
+                hit = k;
+            }
+            continue;
+        }
+        // visit the nearer child first
+        int left = node.first;
+        int right = left + 1;
+        float tl, tr;
+        bool hl = nodes_[left].bounds.RayHit(ox, oy, oz, invX, invY, invZ, best, tl);
+        bool hr = nodes_[right].bounds.RayHit(ox, oy, oz, invX, invY, invZ, best, tr);
+        if (hl && hr) {
+            if (tl <= tr) { push(right); push(left); }
+            else { push(left); push(right); }
+        } else if (hl) push(left);
+        else if (hr) push(right);
+    }
+    if (hit < 0) return false;
+    const Triangle& t = triangles_[hit];
+    outT = best;
+    outTriangle = t.index;
+    nx = t.e1[1] * t.e2[2] - t.e1[2] * t.e2[1];
+    ny = t.e1[2] * t.e2[0] - t.e1[0] * t.e2[2];
+    nz = t.e1[0] * t.e2[1] - t.e1[1] * t.e2[0];
+    return true;
+}
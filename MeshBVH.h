@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+#include "AABBTree.h"
+
+struct Mesh;
+
+// MeshBVH: static bounding-volume hierarchy over a mesh's triangles (mesh local space).
+// Built once per mesh with binned SAH splits; used for exact ray picking against geometry.
+class MeshBVH {
+public:
+    void Build(const Mesh& mesh);
+
+    // Closest triangle hit by origin + dir * t, t in [0, maxT] (both faces count).
+    // Returns the triangle index (into mesh indices / 3) and its unnormalized face normal.
+    bool Raycast(float ox, float oy, float oz, float dx, float dy, float dz, float maxT,
+                 float& outT, int& outTriangle, float& nx, float& ny, float& nz) const;
+
+    const Bounds3& GetBounds() const { return bounds_; }
+    bool Empty() const { return nodes_.empty(); }
+    size_t GetTriangleCount() const { return triangles_.size(); }
+    size_t GetNodeCount() const { return nodes_.size(); }
+
+private:
+    struct Node {
+        Bounds3 bounds;
+        int first = 0;  // leaf: first entry in triangles_; inner: left child (right child = first + 1)
+        int count = 0;  // leaf: triangle count; inner: 0
+    };
+    struct Triangle {
+        float v0[3], e1[3], e2[3]; // v0 and the two edges, ready for the ray test
+        int index;                 // original triangle index
+    };
+
+    std::vector<Node> nodes_;
+    std::vector<Triangle> triangles_;
+    Bounds3 bounds_;
+};
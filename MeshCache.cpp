@@ -0,0 +1,196 @@
+#include "MeshCache.h"
+#include "MeshArtifact.h"
+#include "MeshPacking.h"
+#include "JobSystem.h"
+
+namespace {
+
+template <typename T>
+size_t VectorBytes(const std::vector<T>& v) { return v.capacity() * sizeof(T); }
+
+size_t MeshBytes(const Mesh& m) {
+    size_t bytes = sizeof(Mesh) + MeshPacking::StreamBytes(m);
+    bytes += VectorBytes(m.submeshes) + VectorBytes(m.materials);
+    bytes += VectorBytes(m.boneNames) + VectorBytes(m.boneOffsetMatrices) + VectorBytes(m.boneIndices) + VectorBytes(m.boneWeights);
+    bytes += VectorBytes(m.nodes) + VectorBytes(m.animations);
+    for (const auto& anim : m.animations)
+        for (const auto& ch : anim.channels)
+            bytes += VectorBytes(ch.positions) + VectorBytes(ch.rotations) + VectorBytes(ch.scales);
+    return bytes;
+}
+
+// Simplified levels only: levels[0] is the cached mesh itself
+size_t LODBytes(const MeshLODChain& chain) {
+    size_t bytes = 0;
+    for (size_t i = 1; i < chain.levels.size(); ++i)
+        if (chain.levels[i].mesh) bytes += MeshBytes(*chain.levels[i].mesh);
+    return bytes;
+}
+
+} // namespace
+
+MeshCache& MeshCache::Instance() {
+    static MeshCache cache;
+    return cache;
+}
+
+std::string MeshCache::Key(const std::string& path) const {
+    // the artifact name already folds the asset GUID / path hash; different spellings of one asset share it
+    return MeshArtifact::GetArtifactPath(path);
+}
+
+bool MeshCache::InUse(const Entry& e) const {
+    // the cache's own references: the entry, and level 0 of its LOD chain
+    long owners = 1;
+    if (e.lods && !e.lods->levels.empty() && e.lods->levels[0].mesh == e.mesh) ++owners;
+    return (e.mesh && e.mesh.use_count() > owners) || (e.lods && e.lods.use_count() > 1);
+}
+
+std::shared_ptr<const Mesh> MeshCache::Get(const std::string& path) {
+    const std::string key = Key(path);
+    std::unique_lock<std::mutex> lk(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        std::shared_ptr<Entry> e = it->second;
+        if (e->loading) {
+            stats_.coalesced++;
+            loaded_.wait(lk, [&] { return !e->loading; });
+            return e->mesh; // nullptr when that load failed
+        }
+        stats_.hits++;
+        lru_.splice(lru_.begin(), lru_, e->lru);
+        return e->mesh;
+    }
+
+    auto e = std::make_shared<Entry>();
+    e->loading = true;
+    e->lru = lru_.end();
+    entries_[key] = e;
+    stats_.misses++;
+    const bool pack = packVertices_;
+    lk.unlock();
+
+    std::shared_ptr<Mesh> mesh = MeshArtifact::Load(path);
+    if (mesh) {
+        // renderers and queries only read cached meshes: derive everything they need before publishing
+        if (!mesh->hasBounds) mesh->ComputeBounds();
+        if (!mesh->hasEdges) mesh->BuildEdges();
+        if (pack) MeshPacking::Pack(*mesh);
+    }
+
+    lk.lock();
+    e->loading = false;
+    auto cur = entries_.find(key);
+    const bool current = cur != entries_.end() && cur->second == e; // not invalidated meanwhile
+    if (!mesh) {
+        stats_.failures++;
+        if (current) entries_.erase(cur);
+    } else if (current) {
+        e->mesh = mesh;
+        e->bytes = MeshBytes(*mesh);
+        residentBytes_ += e->bytes;
+        lru_.push_front(key);
+        e->lru = lru_.begin();
+        Trim();
+    }
+    loaded_.notify_all();
+    return mesh;
+}
+
+std::shared_ptr<const MeshLODChain> MeshCache::GetLODs(const std::string& path, const std::shared_ptr<const Mesh>& mesh) {
+    if (!mesh) return nullptr;
+    const std::string key = Key(path);
+    std::unique_lock<std::mutex> lk(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end() || it->second->mesh != mesh) {
+        lk.unlock();
+        return MeshLOD::LoadOrBuild(path, mesh);
+    }
+    std::shared_ptr<Entry> e = it->second;
+    if (e->lodsLoading) loaded_.wait(lk, [&] { return !e->lodsLoading; });
+    if (e->lods) return e->lods;
+
+    e->lodsLoading = true;
+    MeshLOD::Settings settings;
+    settings.pack = packVertices_;
+    lk.unlock();
+    std::shared_ptr<const MeshLODChain> lods = MeshLOD::LoadOrBuild(path, mesh, settings);
+    lk.lock();
+    e->lodsLoading = false;
+    e->lods = lods;
+    if (lods && e->lru != lru_.end()) {
+        size_t bytes = LODBytes(*lods);
+        e->bytes += bytes;
+        residentBytes_ += bytes;
+        Trim();
+    }
+    loaded_.notify_all();
+    return lods;
+}
+
+void MeshCache::Prefetch(const std::string& path) {
+    JobSystem::Instance().Submit([path] { MeshCache::Instance().Get(path); });
+}
+
+void MeshCache::Evict(std::unordered_map<std::string, std::shared_ptr<Entry>>::iterator it) {
+    Entry& e = *it->second;
+    residentBytes_ -= e.bytes;
+    if (e.lru != lru_.end()) lru_.erase(e.lru);
+    entries_.erase(it);
+}
+
+void MeshCache::Invalidate(const std::string& path) {
+    const std::string key = Key(path);
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end() || it->second->loading || it->second->lodsLoading) return;
+    Evict(it);
+}
+
+void MeshCache::ReleaseUnused() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        const Entry& e = *it->second;
+        auto next = std::next(it);
+        if (!e.loading && !e.lodsLoading && !InUse(e)) {
+            Evict(it);
+            stats_.evictions++;
+        }
+        it = next;
+    }
+}
+
+void MeshCache::Trim() {
+    // walk from the least recently requested end, skipping meshes that are still referenced
+    for (auto key = lru_.end(); residentBytes_ > budgetBytes_ && key != lru_.begin();) {
+        --key;
+        auto it = entries_.find(*key);
+        if (it->second->lodsLoading || InUse(*it->second)) continue;
+        auto next = std::next(key);
+        Evict(it);
+        stats_.evictions++;
+        key = next;
+    }
+}
+
+void MeshCache::SetBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    budgetBytes_ = bytes;
+    Trim();
+}
+
+void MeshCache::SetPackVertices(bool pack) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    packVertices_ = pack;
+}
+
+MeshCache::Stats MeshCache::GetStats() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    Stats s = stats_;
+    s.meshes = lru_.size();
+    s.residentBytes = residentBytes_;
+    s.budgetBytes = budgetBytes_;
+    for (const auto& kv : entries_)
+        if (!kv.second->loading && !InUse(*kv.second)) s.unusedBytes += kv.second->bytes;
+    return s;
+}
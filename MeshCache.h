@@ -0,0 +1,87 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include "Mesh.h"
+#include "MeshLOD.h"
+
+// MeshCache: one shared Mesh (and LOD chain) per model file, however many renderers draw it.
+// Meshes are keyed by their artifact (asset GUID, or the path outside the AssetDatabase) and loaded
+// through MeshArtifact on the first request; a request for a mesh that is still loading on another
+// thread waits for that load instead of starting its own. Cached meshes are shared between renderers and
+// loader threads, so they are handed out const: bounds and edges are filled before a mesh is published.
+// Meshes no renderer references any more stay resident until the cache exceeds its memory budget, then
+// the least recently requested ones are released. Meshes in use are never evicted, so a path maps to
+// one Mesh for as long as anything draws it.
+class MeshCache {
+public:
+    static const size_t kDefaultBudgetBytes = 256u << 20;
+
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;          // requests that loaded the mesh (from its artifact or the source)
+        size_t coalesced = 0;       // requests that waited for another thread's load of the same mesh
+        size_t failures = 0;
+        size_t evictions = 0;
+        size_t meshes = 0;          // resident meshes
+        size_t residentBytes = 0;   // their geometry and LOD levels, measured when loaded
+        size_t unusedBytes = 0;     // part of residentBytes no one references (evictable)
+        size_t budgetBytes = 0;
+        double HitRate() const { size_t n = hits + misses + coalesced; return n ? (double)(hits + coalesced) / n : 0.0; }
+    };
+
+    static MeshCache& Instance();
+
+    // The shared mesh for a model file; nullptr when it can't be loaded (a later request retries)
+    std::shared_ptr<const Mesh> Get(const std::string& path);
+
+    // The LOD chain for a mesh returned by Get, built or read once and shared like the mesh.
+    // A mesh that didn't come from the cache gets its own chain.
+    std::shared_ptr<const MeshLODChain> GetLODs(const std::string& path, const std::shared_ptr<const Mesh>& mesh);
+
+    // Start loading a mesh on the JobSystem so a later Get finds it resident
+    void Prefetch(const std::string& path);
+
+    // Drop the cached mesh for a path (e.g. after its source changed); current users keep their copy
+    void Invalidate(const std::string& path);
+    // Release every mesh no one references
+    void ReleaseUnused();
+
+    void SetBudget(size_t bytes);
+
+    // Quantize meshes (and LOD levels) loaded from now on with MeshPacking, releasing their float streams
+    void SetPackVertices(bool pack);
+
+    Stats GetStats() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<const Mesh> mesh;
+        std::shared_ptr<const MeshLODChain> lods;
+        bool loading = false;
+        bool lodsLoading = false;
+        size_t bytes = 0;
+        std::list<std::string>::iterator lru;
+    };
+
+    MeshCache() = default;
+    ~MeshCache() = default;
+
+    std::string Key(const std::string& path) const;
+    bool InUse(const Entry& e) const;
+    void Evict(std::unordered_map<std::string, std::shared_ptr<Entry>>::iterator it);
+    void Trim(); // mutex_ held
+
+    std::unordered_map<std::string, std::shared_ptr<Entry>> entries_;
+    std::list<std::string> lru_; // most recently requested first
+    size_t budgetBytes_ = kDefaultBudgetBytes;
+    bool packVertices_ = false;
+    size_t residentBytes_ = 0;
+    Stats stats_;
+    mutable std::mutex mutex_;
+    std::condition_variable loaded_;
+};
@@ -0,0 +1,185 @@
+#include "MeshLOD.h"
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include "MeshPacking.h"
+#include "MeshArtifact.h"
+#include <fstream>
+#include <algorithm>
+#include <sys/stat.h>
+
+namespace {
+    const uint32_t kMagic = 0x31444F4C; // "LOD1"
+
+    uint64_t Fnv1a(const void* data, size_t bytes, uint64_t h = 14695981039346656037ull) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < bytes; ++i) h = (h ^ p[i]) * 1099511628211ull;
+        return h;
+    }
+
+    // source file size + modification time, importer version and settings: any change rebuilds the artifact
+    uint64_t MakeStamp(const std::string& sourcePath, const MeshLOD::Settings& s) {
+        long long fileInfo[2] = { -1, -1 };
+#ifdef _WIN32
+        struct _stat64 st;
+        if (_stat64(sourcePath.c_str(), &st) == 0) { fileInfo[0] = (long long)st.st_size; fileInfo[1] = (long long)st.st_mtime; }
+#else
+        struct stat st;
+        if (stat(sourcePath.c_str(), &st) == 0) { fileInfo[0] = (long long)st.st_size; fileInfo[1] = (long long)st.st_mtime; }
+#endif
+        uint64_t h = Fnv1a(fileInfo, sizeof(fileInfo));
+        h = Fnv1a(&MeshLOD::kImporterVersion, sizeof(MeshLOD::kImporterVersion), h);
+        const double settings[5] = { (double)s.maxLevels, s.reduction, (double)s.minTriangles, s.maxError, s.firstScreenSize };
+        return Fnv1a(settings, sizeof(settings), h);
+    }
+
+    // SubMesh with a fixed layout (size_t differs between x86 and x64), as in MeshArtifact
+    struct StoredSubMesh { uint64_t indexStart, indexCount; int32_t materialIndex, pad; };
+
+    template<typename T>
+    void WriteArray(std::ofstream& out, const std::vector<T>& v) {
+        uint32_t n = (uint32_t)v.size();
+        out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+        if (n) out.write(reinterpret_cast<const char*>(v.data()), sizeof(T) * n);
+    }
+
+    template<typename T>
+    bool ReadArray(std::ifstream& in, std::vector<T>& v) {
+        uint32_t n = 0;
+        if (!in.read(reinterpret_cast<char*>(&n), sizeof(n))) return false;
+        v.resize(n);
+        return n == 0 || (bool)in.read(reinterpret_cast<char*>(v.data()), sizeof(T) * n);
+    }
+}
+
+namespace MeshLOD {
+
+std::shared_ptr<MeshLODChain> Build(const std::shared_ptr<const Mesh>& mesh, const Settings& settings) {
+    auto chain = std::make_shared<MeshLODChain>();
+    if (!mesh) return chain;
+    chain->levels.push_back({ mesh, 1.0f, 0.0f });
+    const size_t triangles = mesh->TriangleCount();
+    std::vector<size_t> targets;
+    double target = (double)triangles;
+    for (int i = 1; i < settings.maxLevels; ++i) {
+        target *= settings.reduction;
+        if ((size_t)target < settings.minTriangles) break;
+        targets.push_back((size_t)target);
+    }
+    if (targets.empty()) return chain;
+
+    // the simplifier reads float streams: a packed mesh is simplified from an unpacked copy. The source
+    // may be shared (MeshCache), so missing bounds are computed on a copy too.
+    std::shared_ptr<const Mesh> source = mesh;
+    if ((mesh->packed && mesh->vertices.empty()) || !mesh->hasBounds) {
+        auto copy = std::make_shared<Mesh>(*mesh);
+        if (copy->packed && copy->vertices.empty()) MeshPacking::Unpack(*copy);
+        if (!copy->hasBounds) copy->ComputeBounds();
+        source = copy;
+    }
+    float maxError = settings.maxError * std::max(source->boundsRadius, 1e-6f);
+    std::vector<MeshSimplifier::Level> simplified = MeshSimplifier::Simplify(*source, targets, maxError);
+    float screenSize = settings.firstScreenSize;
+    for (MeshSimplifier::Level& s : simplified) {
+        // a level that saves less than 10% isn't worth a switch
+        size_t previous = chain->levels.back().mesh->TriangleCount();
+        if (s.mesh->TriangleCount() * 10 > previous * 9) break;
+        MeshOptimizer::Optimize(*s.mesh);
+        s.mesh->BuildEdges();
+        if (settings.pack) MeshPacking::Pack(*s.mesh);
+        chain->levels.push_back({ s.mesh, screenSize, s.error });
+        screenSize *= 0.5f;
+    }
+    return chain;
+}
+
+std::string GetArtifactPath(const std::string& sourcePath) {
+    return MeshArtifact::GetArtifactPath(sourcePath, ".lod");
+}
+
+bool SaveArtifact(const std::string& path, const MeshLODChain& chain, uint64_t stamp) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    uint32_t header[2] = { kMagic, kImporterVersion };
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(&stamp), sizeof(stamp));
+    // level 0 is the source, loaded by the model importer itself
+    uint32_t count = chain.levels.empty() ? 0 : (uint32_t)chain.levels.size() - 1;
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (size_t i = 1; i < chain.levels.size(); ++i) {
+        const MeshLODChain::Level& level = chain.levels[i];
+        const Mesh& m = *level.mesh;
+        float values[2] = { level.screenSize, level.error };
+        out.write(reinterpret_cast<const char*>(values), sizeof(values));
+        WriteArray(out, m.vertices);
+        WriteArray(out, m.normals);
+        WriteArray(out, m.uvs);
+        WriteArray(out, m.indices);
+        std::vector<StoredSubMesh> submeshes;
+        for (const Mesh::SubMesh& sm : m.submeshes) submeshes.push_back({ sm.indexStart, sm.indexCount, sm.materialIndex, 0 });
+        WriteArray(out, submeshes);
+    }
+    return (bool)out;
+}
+
+bool LoadArtifact(const std::string& path, const std::shared_ptr<const Mesh>& source, uint64_t stamp, MeshLODChain& out, bool pack) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in || !source) return false;
+    uint32_t header[2] = {};
+    uint64_t fileStamp = 0;
+    uint32_t count = 0;
+    if (!in.read(reinterpret_cast<char*>(header), sizeof(header)) || header[0] != kMagic || header[1] != kImporterVersion) return false;
+    if (!in.read(reinterpret_cast<char*>(&fileStamp), sizeof(fileStamp)) || fileStamp != stamp) return false;
+    if (!in.read(reinterpret_cast<char*>(&count), sizeof(count))) return false;
+    MeshLODChain chain;
+    chain.levels.push_back({ source, 1.0f, 0.0f });
+    for (uint32_t i = 0; i < count; ++i) {
+        MeshLODChain::Level level;
+        float values[2];
+        auto m = std::make_shared<Mesh>();
+        if (!in.read(reinterpret_cast<char*>(values), sizeof(values))) return false;
+        std::vector<StoredSubMesh> submeshes;
+        if (!ReadArray(in, m->vertices) || !ReadArray(in, m->normals) || !ReadArray(in, m->uvs) ||
+            !ReadArray(in, m->indices) || !ReadArray(in, submeshes)) return false;
+        for (int index : m->indices)
+            if (index < 0 || (size_t)index >= m->vertices.size()) return false;
+        const uint64_t indexCount = m->indices.size();
+        for (const StoredSubMesh& sm : submeshes) {
+            if (sm.indexStart > indexCount || sm.indexCount > indexCount - sm.indexStart) return false;
+            m->submeshes.push_back({ (size_t)sm.indexStart, (size_t)sm.indexCount, sm.materialIndex });
+        }
+        m->materials = source->materials;
+        m->ComputeBounds();
+        m->BuildEdges();
+        if (pack) MeshPacking::Pack(*m);
+        level.mesh = m;
+        level.screenSize = values[0];
+        level.error = values[1];
+        chain.levels.push_back(level);
+    }
+    out = std::move(chain);
+    return true;
+}
+
+std::shared_ptr<MeshLODChain> LoadOrBuild(const std::string& sourcePath, const std::shared_ptr<const Mesh>& mesh, const Settings& settings) {
+    if (!mesh) return nullptr;
+    // too small to get a level: nothing to cache
+    if (mesh->TriangleCount() * settings.reduction < settings.minTriangles || settings.maxLevels < 2) return Build(mesh, settings);
+    const std::string artifact = GetArtifactPath(sourcePath);
+    const uint64_t stamp = MakeStamp(sourcePath, settings);
+    auto chain = std::make_shared<MeshLODChain>();
+    if (LoadArtifact(artifact, mesh, stamp, *chain, settings.pack)) return chain;
+    Settings unpacked = settings; // the artifact keeps float streams
+    unpacked.pack = false;
+    chain = Build(mesh, unpacked);
+    SaveArtifact(artifact, *chain, stamp); // best effort: without Library/ the chain is rebuilt next time
+    if (settings.pack) {
+        for (size_t i = 1; i < chain->levels.size(); ++i) {
+            auto packed = std::make_shared<Mesh>(*chain->levels[i].mesh);
+            MeshPacking::Pack(*packed);
+            chain->levels[i].mesh = packed;
+        }
+    }
+    return chain;
+}
+
+} // namespace MeshLOD
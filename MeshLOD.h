@@ -0,0 +1,63 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include "Mesh.h"
+
+// MeshLODChain: a mesh and its simplified versions (MeshSimplifier), finest first. Level i > 0 is drawn while
+// the mesh's projected size is below levels[i].screenSize; SelectLevel adds hysteresis so a mesh sitting
+// on a threshold doesn't switch every frame.
+struct MeshLODChain {
+    struct Level {
+        std::shared_ptr<const Mesh> mesh;
+        float screenSize = 1.0f; // bounding-sphere diameter / screen height below which this level is used
+        float error = 0.0f;      // simplification error in mesh units
+    };
+    std::vector<Level> levels;   // levels[0] is the source mesh
+
+    size_t GetLevelCount() const { return levels.size(); }
+    // Level for a projected size, starting from `current`; sizes must cross a threshold by the hysteresis
+    // fraction before the level changes
+    int SelectLevel(float screenSize, int current, float hysteresis) const {
+        int n = (int)levels.size();
+        int level = current < 0 ? 0 : (current >= n ? n - 1 : current);
+        while (level + 1 < n && screenSize < levels[level + 1].screenSize * (1.0f - hysteresis)) ++level;
+        while (level > 0 && screenSize > levels[level].screenSize * (1.0f + hysteresis)) --level;
+        return level;
+    }
+};
+
+// MeshLOD: builds LOD chains at import time and keeps them as artifacts in Library/, so a model is
+// simplified once rather than on every load
+namespace MeshLOD {
+
+struct Settings {
+    int maxLevels = 4;               // including the source mesh
+    float reduction = 0.5f;          // triangle ratio between consecutive levels
+    size_t minTriangles = 256;       // no level below this (and no chain for smaller meshes)
+    float maxError = 0.02f;          // stop simplifying past this error, relative to the bounding radius
+    float firstScreenSize = 0.5f;    // level 1 starts below this projected size; each further level at half
+    bool pack = false;               // quantize levels 1+ with MeshPacking (artifacts keep float streams)
+};
+
+// Bump when the simplifier or the artifact layout changes; older artifacts are rebuilt
+const uint32_t kImporterVersion = 4;
+
+// Chain for an already loaded mesh (just the mesh when it is too small to simplify)
+std::shared_ptr<MeshLODChain> Build(const std::shared_ptr<const Mesh>& mesh, const Settings& settings = Settings());
+
+// Chain for the model at sourcePath: read from its artifact when that is up to date with the file and
+// settings, otherwise built from `mesh` (the loaded source) and written back
+std::shared_ptr<MeshLODChain> LoadOrBuild(const std::string& sourcePath, const std::shared_ptr<const Mesh>& mesh,
+                                          const Settings& settings = Settings());
+
+// Library/<asset guid>.lod, or a hash of the path for files outside the AssetDatabase
+std::string GetArtifactPath(const std::string& sourcePath);
+
+// Artifact I/O. The stamp identifies the source file version and settings the chain was built from.
+bool SaveArtifact(const std::string& path, const MeshLODChain& chain, uint64_t stamp);
+bool LoadArtifact(const std::string& path, const std::shared_ptr<const Mesh>& source, uint64_t stamp, MeshLODChain& out,
+                  bool pack = false);
+
+} // namespace MeshLOD
@@ -0,0 +1,318 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace {
+    // Forsyth's scoring constants, tuned for a 32-entry LRU cache
+    const int kCacheSize = 32;
+    const float kCacheDecayPower = 1.5f;
+    const float kLastTriScore = 0.75f;
+    const float kValenceBoostScale = 2.0f;
+    const float kValenceBoostPower = 0.5f;
+    const int kMaxValenceScore = 32;
+    const int kMaxCandidatesPerVertex = 32;
+
+    struct ScoreTables {
+        float cache[kCacheSize];
+        float valence[kMaxValenceScore];
+        ScoreTables() {
+            for (int i = 0; i < kCacheSize; ++i) {
+                // the last triangle's three vertices score the same, whatever their order
+                cache[i] = i < 3 ? kLastTriScore : powf(1.0f - (float)(i - 3) / (kCacheSize - 3), kCacheDecayPower);
+            }
+            valence[0] = 0.0f;
+            for (int i = 1; i < kMaxValenceScore; ++i) valence[i] = kValenceBoostScale * powf((float)i, -kValenceBoostPower);
+        }
+    };
+
+    float VertexScore(const ScoreTables& t, int cachePosition, int valence) {
+        if (valence == 0) return -1.0f; // no triangles left: never pulls anything in
+        float score = cachePosition < 0 ? 0.0f : t.cache[cachePosition];
+        return score + t.valence[std::min(valence, kMaxValenceScore - 1)];
+    }
+
+    // FIFO cache simulated with timestamps: a vertex is cached while fewer than cacheSize misses
+    // happened since it was loaded. Returns the misses for one triangle.
+    int UpdateFifo(const int* tri, std::vector<unsigned>& loadedAt, unsigned& time, int cacheSize) {
+        int misses = 0;
+        for (int k = 0; k < 3; ++k) {
+            unsigned& t = loadedAt[tri[k]];
+            if (time - t >= (unsigned)cacheSize) { t = time++; ++misses; }
+        }
+        return misses;
+    }
+
+    VECTOR Sub(const VECTOR& a, const VECTOR& b) { return VGet(a.x - b.x, a.y - b.y, a.z - b.z); }
+    VECTOR Cross(const VECTOR& a, const VECTOR& b) {
+        return VGet(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+    }
+}
+
+namespace MeshOptimizer {
+
+Mesh::VertexCacheStats AnalyzeVertexCache(const int* indices, size_t indexCount, size_t vertexCount, int cacheSize) {
+    Mesh::VertexCacheStats stats;
+    const size_t faces = indexCount / 3;
+    if (faces == 0 || vertexCount == 0) return stats;
+    // start every vertex "long ago" so its first use misses
+    unsigned time = (unsigned)cacheSize + 1;
+    std::vector<unsigned> loadedAt(vertexCount, 0);
+    std::vector<char> used(vertexCount, 0);
+    size_t misses = 0, referenced = 0;
+    for (size_t f = 0; f < faces; ++f) {
+        misses += UpdateFifo(indices + f * 3, loadedAt, time, cacheSize);
+        for (int k = 0; k < 3; ++k) {
+            int v = indices[f * 3 + k];
+            if (!used[v]) { used[v] = 1; ++referenced; }
+        }
+    }
+    stats.acmr = (float)misses / (float)faces;
+    stats.atvr = (float)misses / (float)referenced;
+    return stats;
+}
+
+void OptimizeVertexCache(int* indices, size_t indexCount, size_t vertexCount) {
+    static const ScoreTables tables;
+    const size_t faces = indexCount / 3;
+    if (faces < 2) return;
+
+    // triangle corners per vertex, as a compact adjacency list; the live ones are kept at the front of each
+    // list, and slot[corner] says where a corner sits so removal is O(1) even on high-valence vertices
+    std::vector<int> valence(vertexCount, 0);
+    for (size_t i = 0; i < faces * 3; ++i) valence[indices[i]]++;
+    std::vector<size_t> adjacencyStart(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) adjacencyStart[v + 1] = adjacencyStart[v] + valence[v];
+    std::vector<int> adjacency(faces * 3);
+    std::vector<size_t> slot(faces * 3);
+    {
+        std::vector<size_t> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+        for (size_t c = 0; c < faces * 3; ++c) {
+            slot[c] = fill[indices[c]]++;
+            adjacency[slot[c]] = (int)c;
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) vertexScore[v] = VertexScore(tables, -1, valence[v]);
+    std::vector<float> triangleScore(faces);
+    for (size_t f = 0; f < faces; ++f)
+        triangleScore[f] = vertexScore[indices[f * 3]] + vertexScore[indices[f * 3 + 1]] + vertexScore[indices[f * 3 + 2]];
+    std::vector<char> emitted(faces, 0);
+
+    std::vector<int> output;
+    output.reserve(faces * 3);
+    int cache[kCacheSize + 3];
+    int cacheCount = 0;
+    size_t cursor = 0; // every triangle before this one was emitted
+    int best = -1;
+    float bestScore = -1.0f;
+
+    for (size_t emittedCount = 0; emittedCount < faces; ++emittedCount) {
+        if (best < 0) {
+            // nothing near the cache scores: take the best of the next few unemitted triangles
+            while (emitted[cursor]) ++cursor;
+            best = (int)cursor;
+            bestScore = triangleScore[cursor];
+            for (size_t f = cursor + 1, scanned = 0; f < faces && scanned < 100; ++f) {
+                if (emitted[f]) continue;
+                ++scanned;
+                if (triangleScore[f] > bestScore) { bestScore = triangleScore[f]; best = (int)f; }
+            }
+        }
+        const int tri = best;
+        const int* v = indices + tri * 3;
+        output.insert(output.end(), v, v + 3);
+        emitted[tri] = 1;
+
+        // drop the triangle's corners from their vertices' live lists
+        for (int k = 0; k < 3; ++k) {
+            int vertex = v[k];
+            size_t corner = (size_t)tri * 3 + k;
+            size_t last = adjacencyStart[vertex] + valence[vertex] - 1;
+            int moved = adjacency[last];
+            adjacency[slot[corner]] = moved;
+            slot[moved] = slot[corner];
+            adjacency[last] = (int)corner;
+            slot[corner] = last;
+            valence[vertex]--;
+        }
+
+        // new cache: this triangle's vertices in front, then the old entries that aren't among them
+        int next[kCacheSize + 3];
+        int nextCount = 0;
+        for (int k = 0; k < 3; ++k) next[nextCount++] = v[k];
+        for (int i = 0; i < cacheCount; ++i) {
+            int c = cache[i];
+            if (c != v[0] && c != v[1] && c != v[2]) next[nextCount++] = c;
+        }
+
+        // rescore everything that was or is in the cache, then the triangles using those vertices
+        for (int i = 0; i < nextCount; ++i) {
+            int c = next[i];
+            int position = i < kCacheSize ? i : -1;
+            cachePosition[c] = position;
+            vertexScore[c] = VertexScore(tables, position, valence[c]);
+        }
+        best = -1;
+        bestScore = -1.0f;
+        for (int i = 0; i < nextCount; ++i) {
+            int c = next[i];
+            // hubs (fan centers, poles) only offer their first few live triangles as candidates
+            int candidates = std::min(valence[c], kMaxCandidatesPerVertex);
+            for (size_t a = adjacencyStart[c], end = a + candidates; a < end; ++a) {
+                int f = adjacency[a] / 3;
+                const int* fv = indices + f * 3;
+                float score = vertexScore[fv[0]] + vertexScore[fv[1]] + vertexScore[fv[2]];
+                triangleScore[f] = score;
+                if (score > bestScore) { bestScore = score; best = f; }
+            }
+        }
+        cacheCount = std::min(nextCount, kCacheSize);
+        std::copy(next, next + cacheCount, cache);
+    }
+    std::copy(output.begin(), output.end(), indices);
+}
+
+void OptimizeOverdraw(int* indices, size_t indexCount, const std::vector<VECTOR>& positions, float threshold) {
+    const size_t faces = indexCount / 3;
+    if (faces < 2) return;
+    const int cacheSize = kAnalyzeCacheSize;
+    std::vector<unsigned> loadedAt(positions.size(), 0);
+    unsigned time = (unsigned)cacheSize + 1;
+
+    // hard boundaries: a triangle with three misses starts a patch disjoint from what came before
+    std::vector<size_t> hard;
+    for (size_t f = 0; f < faces; ++f) {
+        if (UpdateFifo(indices + f * 3, loadedAt, time, cacheSize) == 3) hard.push_back(f);
+    }
+    if (hard.empty() || hard[0] != 0) hard.insert(hard.begin(), 0);
+    hard.push_back(faces);
+
+    // soft boundaries: split a patch wherever the running ACMR since the last split (cold cache) is
+    // already within threshold of the patch's own, so restarting the cache there costs little
+    std::vector<size_t> clusters;
+    for (size_t h = 0; h + 1 < hard.size(); ++h) {
+        const size_t start = hard[h], end = hard[h + 1];
+        time += cacheSize + 1;
+        size_t patchMisses = 0;
+        for (size_t f = start; f < end; ++f) patchMisses += UpdateFifo(indices + f * 3, loadedAt, time, cacheSize);
+        const float limit = threshold * (float)patchMisses / (float)(end - start);
+
+        clusters.push_back(start);
+        time += cacheSize + 1;
+        size_t misses = 0, count = 0;
+        for (size_t f = start; f < end; ++f) {
+            misses += UpdateFifo(indices + f * 3, loadedAt, time, cacheSize);
+            ++count;
+            if (f + 1 < end && (float)misses <= limit * (float)count) {
+                clusters.push_back(f + 1);
+                time += cacheSize + 1;
+                misses = count = 0;
+            }
+        }
+        // a tail worse than the limit goes back into the previous cluster
+        if (count > 0 && (float)misses > limit * (float)count && clusters.back() != start) clusters.pop_back();
+    }
+    clusters.push_back(faces);
+    const size_t clusterCount = clusters.size() - 1;
+    if (clusterCount < 2) return;
+
+    // mesh centroid over the referenced vertices
+    VECTOR center = VGet(0.0f, 0.0f, 0.0f);
+    for (size_t i = 0; i < faces * 3; ++i) {
+        const VECTOR& p = positions[indices[i]];
+        center.x += p.x; center.y += p.y; center.z += p.z;
+    }
+    float inv = 1.0f / (float)(faces * 3);
+    center = VGet(center.x * inv, center.y * inv, center.z * inv);
+
+    // clusters facing away from the center (on the outside) draw first and occlude the rest
+    struct Cluster { size_t begin, end; float sortKey; };
+    std::vector<Cluster> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c) {
+        VECTOR centroid = VGet(0.0f, 0.0f, 0.0f), normal = VGet(0.0f, 0.0f, 0.0f);
+        float area = 0.0f;
+        for (size_t f = clusters[c]; f < clusters[c + 1]; ++f) {
+            const VECTOR& a = positions[indices[f * 3]];
+            const VECTOR& b = positions[indices[f * 3 + 1]];
+            const VECTOR& d = positions[indices[f * 3 + 2]];
+            VECTOR n = Cross(Sub(b, a), Sub(d, a));
+            float w = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+            normal.x += n.x; normal.y += n.y; normal.z += n.z;
+            centroid.x += (a.x + b.x + d.x) * w; centroid.y += (a.y + b.y + d.y) * w; centroid.z += (a.z + b.z + d.z) * w;
+            area += w;
+        }
+        float key = 0.0f;
+        float length = sqrtf(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+        if (area > 0.0f && length > 0.0f) {
+            float s = 1.0f / (area * 3.0f);
+            VECTOR offset = Sub(VGet(centroid.x * s, centroid.y * s, centroid.z * s), center);
+            key = (offset.x * normal.x + offset.y * normal.y + offset.z * normal.z) / length;
+        }
+        order[c] = { clusters[c], clusters[c + 1], key };
+    }
+    std::stable_sort(order.begin(), order.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+    std::vector<int> output;
+    output.reserve(faces * 3);
+    for (const Cluster& c : order) output.insert(output.end(), indices + c.begin * 3, indices + c.end * 3);
+    std::copy(output.begin(), output.end(), indices);
+}
+
+void OptimizeVertexFetch(Mesh& mesh) {
+    const size_t vertexCount = mesh.vertices.size();
+    std::vector<int> remap(vertexCount, -1);
+    int next = 0;
+    for (int& index : mesh.indices) {
+        if (remap[index] < 0) remap[index] = next++;
+        index = remap[index];
+    }
+    for (size_t v = 0; v < vertexCount; ++v)
+        if (remap[v] < 0) remap[v] = next++;
+
+    // per-vertex arrays only: anything with a different length isn't indexed by vertex
+    auto permute = [&](auto& values) {
+        if (values.size() != vertexCount) return;
+        typename std::decay<decltype(values)>::type sorted(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v) sorted[remap[v]] = values[v];
+        values.swap(sorted);
+    };
+    permute(mesh.vertices);
+    permute(mesh.normals);
+    permute(mesh.uvs);
+    permute(mesh.boneIndices);
+    permute(mesh.boneWeights);
+}
+
+void Optimize(Mesh& mesh, float overdrawThreshold) {
+    const size_t vertexCount = mesh.vertices.size();
+    std::vector<int>& indices = mesh.indices;
+    if (indices.empty() || indices.size() % 3 != 0) return;
+    for (int index : indices)
+        if (index < 0 || (size_t)index >= vertexCount) return;
+
+    mesh.cacheStatsBefore = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount);
+
+    // each submesh on its own so material ranges survive; without submeshes the whole list is one range
+    std::vector<std::pair<size_t, size_t>> ranges;
+    for (const Mesh::SubMesh& sm : mesh.submeshes) {
+        if (sm.indexStart % 3 == 0 && sm.indexCount % 3 == 0 && sm.indexStart + sm.indexCount <= indices.size())
+            ranges.push_back({ sm.indexStart, sm.indexCount });
+    }
+    if (mesh.submeshes.empty()) ranges.push_back({ 0, indices.size() });
+    for (const auto& r : ranges) {
+        OptimizeVertexCache(indices.data() + r.first, r.second, vertexCount);
+        OptimizeOverdraw(indices.data() + r.first, r.second, mesh.vertices, overdrawThreshold);
+    }
+    OptimizeVertexFetch(mesh);
+
+    mesh.cacheStatsAfter = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount);
+    // indices changed: derived data is stale
+    mesh.bvh.reset();
+    mesh.hasEdges = false;
+    mesh.edges.clear();
+}
+
+} // namespace MeshOptimizer
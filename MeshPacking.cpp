@@ -0,0 +1,221 @@
+#include "MeshPacking.h"
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+template <typename T>
+size_t VectorBytes(const std::vector<T>& v) { return v.capacity() * sizeof(T); }
+
+template <typename T>
+void Release(std::vector<T>& v) { std::vector<T>().swap(v); }
+
+float AngleDegrees(const VECTOR& a, float bx, float by, float bz) {
+    float la = sqrtf(a.x * a.x + a.y * a.y + a.z * a.z), lb = sqrtf(bx * bx + by * by + bz * bz);
+    if (la <= 0.0f || lb <= 0.0f) return 0.0f;
+    float c = (a.x * bx + a.y * by + a.z * bz) / (la * lb);
+    return acosf(std::max(-1.0f, std::min(1.0f, c))) * (180.0f / 3.14159265f);
+}
+
+} // namespace
+
+namespace MeshPacking {
+
+uint16_t FloatToHalf(float f) {
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    const uint32_t sign = (x >> 16) & 0x8000;
+    const uint32_t mag = x & 0x7FFFFFFF;
+    if (mag >= 0x7F800000) return (uint16_t)(sign | (mag > 0x7F800000 ? 0x7E00 : 0x7C00)); // NaN / inf
+    if (mag >= 0x477FF000) return (uint16_t)(sign | 0x7C00);                               // rounds past 65504
+    if (mag < 0x38800000) {
+        // below the smallest normal half: subnormal steps of 2^-24
+        float a;
+        memcpy(&a, &mag, sizeof(a));
+        return (uint16_t)(sign | (uint32_t)lrintf(a * 16777216.0f));
+    }
+    // rebias the exponent and round the 13 dropped mantissa bits to nearest even
+    uint32_t h = (mag - 0x38000000) >> 13;
+    const uint32_t rest = mag & 0x1FFF;
+    if (rest > 0x1000 || (rest == 0x1000 && (h & 1))) ++h;
+    return (uint16_t)(sign | h);
+}
+
+float HalfToFloat(uint16_t h) {
+    const uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    const uint32_t exp = (h >> 10) & 0x1F;
+    const uint32_t man = h & 0x3FF;
+    if (exp == 0) {
+        float f = man * (1.0f / 16777216.0f);
+        return sign ? -f : f;
+    }
+    uint32_t bits = exp == 31 ? (sign | 0x7F800000 | (man << 13)) : (sign | ((exp + 112) << 23) | (man << 13));
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+bool Pack(Mesh& mesh, bool releaseSource, Stats* stats) {
+    const size_t n = mesh.vertices.size();
+    if (n == 0 || !mesh.boneNames.empty()) return false;
+    if (!mesh.hasBounds) mesh.ComputeBounds();
+    if (!mesh.hasEdges) mesh.BuildEdges();
+    const size_t sourceBytes = StreamBytes(mesh);
+
+    auto p = std::make_shared<Mesh::Packed>();
+    p->vertexCount = n;
+    p->indexCount = mesh.indices.size();
+
+    const Bounds3& b = mesh.bounds;
+    const float lo[3] = { b.minX, b.minY, b.minZ };
+    const float extent[3] = { b.maxX - b.minX, b.maxY - b.minY, b.maxZ - b.minZ };
+    float inv[3];
+    for (int c = 0; c < 3; ++c) {
+        p->offset[c] = lo[c];
+        p->scale[c] = extent[c] > 0.0f ? extent[c] / 65535.0f : 0.0f;
+        inv[c] = extent[c] > 0.0f ? 65535.0f / extent[c] : 0.0f;
+    }
+    p->positions.resize(n * 3);
+    for (size_t i = 0; i < n; ++i) {
+        const float v[3] = { mesh.vertices[i].x, mesh.vertices[i].y, mesh.vertices[i].z };
+        for (int c = 0; c < 3; ++c) {
+            long q = lrintf((v[c] - lo[c]) * inv[c]);
+            p->positions[i * 3 + c] = (uint16_t)std::max(0L, std::min(65535L, q));
+        }
+    }
+
+    if (mesh.normals.size() == n) {
+        p->normals.resize(n);
+        for (size_t i = 0; i < n; ++i)
+            p->normals[i] = EncodeOctahedral(mesh.normals[i].x, mesh.normals[i].y, mesh.normals[i].z);
+    }
+    if (mesh.uvs.size() == n) {
+        p->uvs.resize(n);
+        for (size_t i = 0; i < n; ++i)
+            p->uvs[i] = (uint32_t)FloatToHalf(mesh.uvs[i].x) | ((uint32_t)FloatToHalf(mesh.uvs[i].y) << 16);
+    }
+
+    // 16-bit copies only when every index and face number fits (0xFFFF stays free for open borders)
+    const size_t faces = mesh.indices.size() / 3;
+    bool shortIndices = n <= 65536;
+    for (size_t i = 0; i < mesh.indices.size() && shortIndices; ++i)
+        shortIndices = mesh.indices[i] >= 0 && (size_t)mesh.indices[i] < n;
+    if (shortIndices) p->indices.assign(mesh.indices.begin(), mesh.indices.end());
+    if (shortIndices && faces < 0xFFFF) {
+        p->edges.resize(mesh.edges.size() * 4);
+        for (size_t i = 0; i < mesh.edges.size(); ++i) {
+            const Mesh::Edge& e = mesh.edges[i];
+            uint16_t* out = &p->edges[i * 4];
+            out[0] = (uint16_t)e.v0; out[1] = (uint16_t)e.v1;
+            out[2] = (uint16_t)e.face0; out[3] = e.face1 < 0 ? 0xFFFF : (uint16_t)e.face1;
+        }
+    } else if (!p->normals.empty()) {
+        // lit by vertex normals, wireframes never read the edge's faces
+        p->edgeVertices.resize(mesh.edges.size() * 2);
+        for (size_t i = 0; i < mesh.edges.size(); ++i) {
+            p->edgeVertices[i * 2] = (uint32_t)mesh.edges[i].v0;
+            p->edgeVertices[i * 2 + 1] = (uint32_t)mesh.edges[i].v1;
+        }
+    }
+
+    if (stats) {
+        Stats& s = *stats;
+        s = Stats();
+        s.sourceBytes = sourceBytes;
+        for (size_t i = 0; i < n; ++i) {
+            const float v[3] = { mesh.vertices[i].x, mesh.vertices[i].y, mesh.vertices[i].z };
+            for (int c = 0; c < 3; ++c)
+                s.maxPositionError = std::max(s.maxPositionError, fabsf(p->offset[c] + p->positions[i * 3 + c] * p->scale[c] - v[c]));
+            if (!p->normals.empty()) {
+                float x, y, z;
+                DecodeOctahedral(p->normals[i], x, y, z);
+                s.maxNormalError = std::max(s.maxNormalError, AngleDegrees(mesh.normals[i], x, y, z));
+            }
+            if (!p->uvs.empty()) {
+                s.maxUVError = std::max(s.maxUVError, fabsf(HalfToFloat((uint16_t)(p->uvs[i] & 0xFFFF)) - mesh.uvs[i].x));
+                s.maxUVError = std::max(s.maxUVError, fabsf(HalfToFloat((uint16_t)(p->uvs[i] >> 16)) - mesh.uvs[i].y));
+            }
+        }
+    }
+
+    mesh.packed = p;
+    if (releaseSource) {
+        Release(mesh.vertices);
+        Release(mesh.normals);
+        Release(mesh.uvs);
+        if (!p->indices.empty()) Release(mesh.indices);
+        if (!p->edges.empty() || !p->edgeVertices.empty()) Release(mesh.edges);
+    }
+    if (stats) stats->packedBytes = StreamBytes(mesh);
+    return true;
+}
+
+void Unpack(Mesh& mesh) {
+    if (!mesh.packed) return;
+    const Mesh::Packed& p = *mesh.packed;
+    const size_t n = p.vertexCount;
+    if (mesh.vertices.empty()) {
+        mesh.vertices.resize(n);
+        for (size_t i = 0; i < n; ++i)
+            mesh.vertices[i] = VGet(p.offset[0] + p.positions[i * 3] * p.scale[0], p.offset[1] + p.positions[i * 3 + 1] * p.scale[1],
+                                    p.offset[2] + p.positions[i * 3 + 2] * p.scale[2]);
+    }
+    if (mesh.normals.empty() && !p.normals.empty()) {
+        mesh.normals.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            float x, y, z;
+            DecodeOctahedral(p.normals[i], x, y, z);
+            float inv = 1.0f / sqrtf(x * x + y * y + z * z);
+            mesh.normals[i] = VGet(x * inv, y * inv, z * inv);
+        }
+    }
+    if (mesh.uvs.empty() && !p.uvs.empty()) {
+        mesh.uvs.resize(n);
+        for (size_t i = 0; i < n; ++i)
+            mesh.uvs[i] = VGet(HalfToFloat((uint16_t)(p.uvs[i] & 0xFFFF)), HalfToFloat((uint16_t)(p.uvs[i] >> 16)), 0.0f);
+    }
+    if (mesh.indices.empty() && !p.indices.empty()) mesh.indices.assign(p.indices.begin(), p.indices.end());
+    if (mesh.edges.empty() && !p.edges.empty()) {
+        mesh.edges.resize(p.edges.size() / 4);
+        for (size_t i = 0; i < mesh.edges.size(); ++i) {
+            const uint16_t* e = &p.edges[i * 4];
+            mesh.edges[i] = { e[0], e[1], e[2], e[3] == 0xFFFF ? -1 : (int)e[3] };
+        }
+    } else if (mesh.edges.empty() && !p.edgeVertices.empty()) {
+        mesh.hasEdges = false; // the faces weren't kept: rebuilt from the indices
+        mesh.BuildEdges();
+    }
+}
+
+const VECTOR* GetPositions(const Mesh& mesh, ScratchArena& arena) {
+    if (!mesh.vertices.empty() || !mesh.packed) return mesh.vertices.empty() ? nullptr : mesh.vertices.data();
+    const Mesh::Packed& p = *mesh.packed;
+    VECTOR* out = arena.Allocate<VECTOR>(p.vertexCount);
+    for (size_t i = 0; i < p.vertexCount; ++i) {
+        out[i].x = p.offset[0] + p.positions[i * 3] * p.scale[0];
+        out[i].y = p.offset[1] + p.positions[i * 3 + 1] * p.scale[1];
+        out[i].z = p.offset[2] + p.positions[i * 3 + 2] * p.scale[2];
+    }
+    return out;
+}
+
+const int* GetIndices(const Mesh& mesh, ScratchArena& arena) {
+    if (!mesh.indices.empty() || !mesh.packed) return mesh.indices.empty() ? nullptr : mesh.indices.data();
+    const Mesh::Packed& p = *mesh.packed;
+    int* out = arena.Allocate<int>(p.indices.size());
+    for (size_t i = 0; i < p.indices.size(); ++i) out[i] = p.indices[i];
+    return out;
+}
+
+size_t StreamBytes(const Mesh& mesh) {
+    size_t bytes = VectorBytes(mesh.vertices) + VectorBytes(mesh.normals) + VectorBytes(mesh.uvs) +
+                   VectorBytes(mesh.indices) + VectorBytes(mesh.edges);
+    if (mesh.packed) {
+        const Mesh::Packed& p = *mesh.packed;
+        bytes += VectorBytes(p.positions) + VectorBytes(p.normals) + VectorBytes(p.uvs) + VectorBytes(p.indices);
+        bytes += VectorBytes(p.edges) + VectorBytes(p.edgeVertices);
+    }
+    return bytes;
+}
+
+} // namespace MeshPacking
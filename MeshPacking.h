@@ -0,0 +1,69 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include "Mesh.h"
+#include "ScratchArena.h"
+
+// MeshPacking: quantized vertex storage (Mesh::Packed). Positions become unorm16 relative to the bounds
+// (error about half a step, bounds extent / 131070), normals octahedral snorm16 pairs (under 0.05 degree)
+// and UVs half floats; indices and edges drop to 16 bits when the vertex count is at most 65536, and
+// larger meshes with normals keep only the vertex pair of each edge. Streams stay separate (SoA): the
+// renderer transforms positions and lights normals in separate passes.
+namespace MeshPacking {
+
+// Octahedral normal encoding: the unit sphere folded onto [-1, 1]^2, stored as snorm16 x | y << 16
+inline uint32_t EncodeOctahedral(float x, float y, float z) {
+    float l1 = fabsf(x) + fabsf(y) + fabsf(z);
+    if (l1 <= 0.0f) return 0;
+    x /= l1; y /= l1;
+    if (z < 0.0f) {
+        float fx = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        float fy = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = fx; y = fy;
+    }
+    int qx = (int)lrintf(std::max(-1.0f, std::min(1.0f, x)) * 32767.0f);
+    int qy = (int)lrintf(std::max(-1.0f, std::min(1.0f, y)) * 32767.0f);
+    return (uint32_t)(uint16_t)(int16_t)qx | ((uint32_t)(uint16_t)(int16_t)qy << 16);
+}
+
+// Unnormalized direction (length between 1/sqrt(3) and 1); lighting normalizes anyway
+inline void DecodeOctahedral(uint32_t e, float& x, float& y, float& z) {
+    x = (int16_t)(e & 0xFFFF) * (1.0f / 32767.0f);
+    y = (int16_t)(e >> 16) * (1.0f / 32767.0f);
+    z = 1.0f - fabsf(x) - fabsf(y);
+    if (z < 0.0f) {
+        float fx = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        float fy = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = fx; y = fy;
+    }
+}
+
+uint16_t FloatToHalf(float f);
+float HalfToFloat(uint16_t h);
+
+struct Stats {
+    size_t sourceBytes = 0;        // vertex, index and edge streams before packing
+    size_t packedBytes = 0;        // the same streams afterwards, including the float ones still kept
+    float maxPositionError = 0.0f; // mesh units
+    float maxNormalError = 0.0f;   // degrees
+    float maxUVError = 0.0f;
+};
+
+// Fill mesh.packed (computing bounds and edges first when missing). With releaseSource the float streams
+// are freed, and indices/edges too when 16-bit copies were made. Meshes with bones keep their streams for
+// skinning; false for them and for meshes without vertices.
+bool Pack(Mesh& mesh, bool releaseSource = true, Stats* stats = nullptr);
+
+// Rebuild the float streams of a packed mesh (quantized values; the packed streams stay)
+void Unpack(Mesh& mesh);
+
+// Float positions / int indices of a mesh, decoded into `arena` when only packed streams remain
+const VECTOR* GetPositions(const Mesh& mesh, ScratchArena& arena);
+const int* GetIndices(const Mesh& mesh, ScratchArena& arena);
+
+// Bytes held by the mesh's vertex, index and edge streams (float and packed)
+size_t StreamBytes(const Mesh& mesh);
+
+} // namespace MeshPacking
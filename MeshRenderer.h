@@ -1,143 +1,120 @@
 #pragma once
 #include "Component.h"
-#include "DxLib.h"
+#include "VectorMath.h"
 #include "Mesh.h"
 #include <memory>
 #include <string>
 #include <algorithm>
 #include <cmath>
-#include "ObjLoader.h"
-#include "third_party/ModelLoader.h"
+#include "MeshCache.h"
 #include "Lighting.h"
 #include "Shader.h"
+#include "RenderBackend.h"
+#include "VertexTransform.h"
+#include "MeshLOD.h"
+#include <vector>
 
-// MeshRenderer: render a loaded mesh (wireframe) or fallback cube
+// MeshRenderer: render a loaded mesh (wireframe or filled) or fallback cube through the current RenderBackend
 struct MeshRenderer : public Component {
     MeshRenderer() : color_(GetColor(200,200,200)), meshPath_(), mesh_(nullptr) { InitShader(); }
     MeshRenderer(int color) : color_(color), meshPath_(), mesh_(nullptr) { InitShader(); }
     MeshRenderer(const std::string& meshPath) : color_(GetColor(200,200,200)), meshPath_(meshPath), mesh_(nullptr) { InitShader(); }
 
     void InitShader() {
-        if (!shader_) shader_ = std::make_shared<Shader>();
-        // attempt to load simple shader (no-op succeeds)
-        shader_->Load("shaders/simple_lit.vert", "shaders/simple_lit.hlsl");
+        if (!shader_) shader_ = DefaultShader();
+    }
+
+    // The simple lit shader, loaded once and shared so renderers using it batch as one material
+    static std::shared_ptr<Shader> DefaultShader() {
+        static std::shared_ptr<Shader> shader = [] {
+            auto s = std::make_shared<Shader>();
+            // attempt to load simple shader (no-op succeeds)
+            s->Load("shaders/simple_lit.vert", "shaders/simple_lit.hlsl");
+            return s;
+        }();
+        return shader;
     }
 
     void Awake() override {
-        if (!meshPath_.empty()) {
-            // choose loader based on extension
-            if (meshPath_.size() >= 4) {
-                std::string ext = meshPath_.substr(meshPath_.size() - 4);
-                for (auto &c : ext) c = (char)tolower((unsigned char)c);
-                if (ext == ".obj") {
-                    mesh_ = ObjLoader::LoadObj(meshPath_);
-                } else {
-                    mesh_ = ModelLoader::LoadModel(meshPath_);
-                }
-            } else {
-                mesh_ = ObjLoader::LoadObj(meshPath_);
-            }
-        }
+        // shared with every other renderer of the same file (imported once into Library/)
+        if (!meshPath_.empty() && !mesh_) mesh_ = MeshCache::Instance().Get(meshPath_);
+        if (lodEnabled_ && mesh_ && !lods_ && !meshPath_.empty()) lods_ = MeshCache::Instance().GetLODs(meshPath_, mesh_);
     }
 
-    void Render() override {
-        if (!owner) return;
-        // compute simple light factor
-        VECTOR ldir = Lighting::GetMainDirectionalDir();
-        float lint = Lighting::GetMainDirectionalIntensity();
-        int lcol = Lighting::GetMainDirectionalColor();
+    // The mesh drawn this frame: the selected LOD level, or mesh_ without a chain
+    const std::shared_ptr<const Mesh>& GetDrawMesh() const {
+        if (lods_ && lodLevel_ > 0 && (size_t)lodLevel_ < lods_->levels.size()) return lods_->levels[lodLevel_].mesh;
+        return mesh_;
+    }
 
-        // bind shader and set uniforms (no-op on current platform)
-        if (shader_) {
-            shader_->Bind();
-            shader_->SetFloat3("LightDir", -ldir.x, -ldir.y, -ldir.z);
-            // unpack color
-            int lr = (lcol >> 16) & 0xFF;
-            int lg = (lcol >> 8) & 0xFF;
-            int lb = lcol & 0xFF;
-            shader_->SetFloat3("LightColor", lr / 255.0f, lg / 255.0f, lb / 255.0f);
-            shader_->SetFloat("LightIntensity", lint);
-        }
+    // Pick the LOD level for a projected size (bounding-sphere diameter / screen height)
+    void SelectLod(float screenSize, float hysteresis) {
+        lodLevel_ = lods_ ? lods_->SelectLevel(screenSize, lodLevel_, hysteresis) : 0;
+    }
 
-        auto clamp255 = [](int v) {
-            if (v < 0) return 0;
-            if (v > 255) return 255;
-            return v;
-        };
+    // Bind the shader with the main light's uniforms (no-op on current platform)
+    void BindShader() {
+        if (!shader_) return;
+        VECTOR ldir = Lighting::GetMainDirectionalDir();
+        int lcol = Lighting::GetMainDirectionalColor();
+        shader_->Bind();
+        shader_->SetFloat3("LightDir", -ldir.x, -ldir.y, -ldir.z);
+        // unpack color
+        int lr = (lcol >> 16) & 0xFF;
+        int lg = (lcol >> 8) & 0xFF;
+        int lb = lcol & 0xFF;
+        shader_->SetFloat3("LightColor", lr / 255.0f, lg / 255.0f, lb / 255.0f);
+        shader_->SetFloat("LightIntensity", Lighting::GetMainDirectionalIntensity());
+    }
 
-        auto ApplyLightingToColor = [&](int baseColor, const VECTOR& normal) {
-            int br = (baseColor >> 16) & 0xFF;
-            int bg = (baseColor >> 8) & 0xFF;
-            int bb = baseColor & 0xFF;
-            int lr = (lcol >> 16) & 0xFF;
-            int lg = (lcol >> 8) & 0xFF;
-            int lb = lcol & 0xFF;
-            float ndotl = 0.0f;
-            float nl = sqrtf(normal.x*normal.x + normal.y*normal.y + normal.z*normal.z);
-            if (nl > 0.0001f) {
-                VECTOR nn = VGet(normal.x / nl, normal.y / nl, normal.z / nl);
-                ndotl = nn.x * (-ldir.x) + nn.y * (-ldir.y) + nn.z * (-ldir.z);
-                if (ndotl < 0.0f) ndotl = 0.0f;
-            }
-            float factor = lint * ndotl;
-            float rVal = br * (1.0f - factor) + (br * (lr / 255.0f)) * factor;
-            float gVal = bg * (1.0f - factor) + (bg * (lg / 255.0f)) * factor;
-            float bVal = bb * (1.0f - factor) + (bb * (lb / 255.0f)) * factor;
-            int rr = clamp255((int)rVal);
-            int gg = clamp255((int)gVal);
-            int bb2 = clamp255((int)bVal);
-            return GetColor(rr, gg, bb2);
-        };
+    void Render() override {
+        if (!owner || culled_ || queued_) return;
+        BindShader();
+        RenderBackend& gfx = RenderBackend::Current();
+        if (alpha_ < 255) gfx.SetBlendAlpha(alpha_);
+        Draw();
+        if (alpha_ < 255) gfx.SetBlendAlpha(255);
+    }
 
+    // Draw with whatever shader and blend state is current (the scene's render queue sets them)
+    void Draw() {
+        if (!owner) return;
+        RenderBackend& gfx = RenderBackend::Current();
         if (mesh_) {
-            // simple transform: scale then translate per-vertex
-            float tx = owner->transform().x;
-            float ty = owner->transform().y;
-            float tz = owner->transform().z;
-            float sx = owner->transform().scaleX;
-            float sy = owner->transform().scaleY;
-            float sz = owner->transform().scaleZ;
-            // draw triangles
-            for (size_t i = 0; i + 2 < mesh_->indices.size(); i += 3) {
-                VECTOR v0 = mesh_->vertices[mesh_->indices[i + 0]];
-                VECTOR v1 = mesh_->vertices[mesh_->indices[i + 1]];
-                VECTOR v2 = mesh_->vertices[mesh_->indices[i + 2]];
-                v0.x = v0.x * sx + tx; v0.y = v0.y * sy + ty; v0.z = v0.z * sz + tz;
-                v1.x = v1.x * sx + tx; v1.y = v1.y * sy + ty; v1.z = v1.z * sz + tz;
-                v2.x = v2.x * sx + tx; v2.y = v2.y * sy + ty; v2.z = v2.z * sz + tz;
-                // compute normal if available
-                VECTOR normal = VGet(0,1,0);
-                if (mesh_->normals.size() == mesh_->vertices.size()) {
-                    normal = mesh_->normals[mesh_->indices[i + 0]];
-                } else {
-                    VECTOR e1 = VSub(v1, v0);
-                    VECTOR e2 = VSub(v2, v0);
-                    normal = VCross(e1, e2);
-                }
-                int litColor = ApplyLightingToColor(color_, normal);
-                DrawLine3D(v0, v1, litColor);
-                DrawLine3D(v1, v2, litColor);
-                DrawLine3D(v2, v0, litColor);
-            }
+            // a single instance: the backend transforms and lights each unique vertex once
+            InstanceGeometry geometry;
+            InstanceData instance;
+            GetInstanceGeometry(geometry);
+            GetInstanceData(instance);
+            gfx.DrawInstances3D(geometry, &instance, 1, GetMainLight());
             return;
         }
+        // compute simple light factor
+        VECTOR ldir = Lighting::GetMainDirectionalDir();
+        float lint = Lighting::GetMainDirectionalIntensity();
+        int lcol = Lighting::GetMainDirectionalColor();
+
         // fallback: draw cube wireframe
         float wx, wy, wz;
-        owner->transform().GetWorldPosition3D(wx, wy, wz);
-        float sx = owner->transform().scaleX * 0.5f;
-        float sy = owner->transform().scaleY * 0.5f;
-        float sz = owner->transform().scaleZ * 0.5f;
-        VECTOR v[8];
-        v[0] = VGet(wx - sx, wy - sy, wz - sz);
-        v[1] = VGet(wx + sx, wy - sy, wz - sz);
-        v[2] = VGet(wx + sx, wy + sy, wz - sz);
-        v[3] = VGet(wx - sx, wy + sy, wz - sz);
-        v[4] = VGet(wx - sx, wy - sy, wz + sz);
-        v[5] = VGet(wx + sx, wy - sy, wz + sz);
-        v[6] = VGet(wx + sx, wy + sy, wz + sz);
-        v[7] = VGet(wx - sx, wy + sy, wz + sz);
+        owner->ctransform().GetWorldPosition3D(wx, wy, wz);
+        float m[3][4];
+        owner->ctransform().GetMatrix3D(m);
+        const float corners[8][3] = {
+            { -0.5f, -0.5f, -0.5f }, { 0.5f, -0.5f, -0.5f }, { 0.5f, 0.5f, -0.5f }, { -0.5f, 0.5f, -0.5f },
+            { -0.5f, -0.5f, 0.5f }, { 0.5f, -0.5f, 0.5f }, { 0.5f, 0.5f, 0.5f }, { -0.5f, 0.5f, 0.5f },
+        };
+        float v[8][3];
+        for (int k = 0; k < 8; ++k) {
+            const float* c = corners[k];
+            v[k][0] = wx + m[0][0] * c[0] + m[0][1] * c[1] + m[0][2] * c[2];
+            v[k][1] = wy + m[1][0] * c[0] + m[1][1] * c[1] + m[1][2] * c[2];
+            v[k][2] = wz + m[2][0] * c[0] + m[2][1] * c[1] + m[2][2] * c[2];
+        }
         // compute cube face normals and draw with lighting
         VECTOR normals[6] = { VGet(0,0,-1), VGet(0,0,1), VGet(0,-1,0), VGet(0,1,0), VGet(-1,0,0), VGet(1,0,0) };
+        for (VECTOR& n : normals)
+            n = VGet(m[0][0] * n.x + m[0][1] * n.y + m[0][2] * n.z, m[1][0] * n.x + m[1][1] * n.y + m[1][2] * n.z,
+                     m[2][0] * n.x + m[2][1] * n.y + m[2][2] * n.z);
         // draw edges using average face normal for each edge simplified
         for (int i = 0; i < 12; ++i) {
             int a, b; int fn;
@@ -146,18 +123,154 @@ struct MeshRenderer : public Component {
                 case 4: a=4;b=5;fn=1; break; case 5: a=5;b=6;fn=1; break; case 6: a=6;b=7;fn=1; break; case 7: a=7;b=4;fn=1; break;
                 case 8: a=0;b=4;fn=2; break; case 9: a=1;b=5;fn=2; break; case 10: a=2;b=6;fn=2; break; case 11: a=3;b=7;fn=2; break;
             }
-            int litColor = ApplyLightingToColor(color_, normals[fn]);
-            DrawLine3D(v[a], v[b], litColor);
+            gfx.DrawLine3D(v[a], v[b], ApplyLightingToColor(color_, normals[fn], ldir, lint, lcol));
+        }
+    }
+
+    // The drawn mesh as DrawInstances3D geometry. Requires mesh_ (cached meshes and LOD levels come with
+    // their edge list).
+    void GetInstanceGeometry(InstanceGeometry& g) const {
+        static_assert(sizeof(VECTOR) == 3 * sizeof(float), "positions are read as packed xyz floats");
+        static_assert(sizeof(Mesh::Edge) == 4 * sizeof(int), "edges are read as 4 ints");
+        const Mesh& mesh = *GetDrawMesh();
+        g.positions = mesh.vertices.empty() ? nullptr : &mesh.vertices[0].x;
+        g.normals = !mesh.normals.empty() && mesh.normals.size() == mesh.vertices.size() ? &mesh.normals[0].x : nullptr;
+        g.vertexCount = mesh.vertices.size();
+        g.indices = mesh.indices.empty() ? nullptr : mesh.indices.data();
+        g.indexCount = mesh.indices.size();
+        g.edges = mesh.edges.empty() ? nullptr : &mesh.edges[0].v0;
+        g.edgeCount = mesh.edges.size();
+        g.wireframe = wireframe_;
+        if (mesh.packed) {
+            // quantized streams (MeshPacking) replace the float ones
+            const Mesh::Packed& p = *mesh.packed;
+            g.quantizedPositions = p.positions.data();
+            for (int c = 0; c < 3; ++c) { g.positionOffset[c] = p.offset[c]; g.positionScale[c] = p.scale[c]; }
+            g.octNormals = p.normals.empty() ? nullptr : p.normals.data();
+            g.normals = nullptr;
+            g.vertexCount = p.vertexCount;
+            g.indexCount = p.indexCount;
+            g.indices16 = p.indices.empty() ? nullptr : p.indices.data();
+            if (!p.edges.empty()) {
+                g.edges16 = p.edges.data();
+                g.edgeCount = p.edges.size() / 4;
+            } else if (!p.edgeVertices.empty()) {
+                g.edgeVertices = p.edgeVertices.data();
+                g.edgeCount = p.edgeVertices.size() / 2;
+            }
+        }
+    }
+
+    // This renderer's entry in an instance stream
+    void GetInstanceData(InstanceData& d) const {
+        owner->ctransform().GetMatrix3D(d.model);
+        VertexTransform::NormalMatrix(owner->ctransform(), d.normal);
+        d.color = (unsigned int)color_;
+        d.pad[0] = d.pad[1] = 0;
+    }
+
+    static InstanceLight GetMainLight() {
+        VECTOR ldir = Lighting::GetMainDirectionalDir();
+        InstanceLight l;
+        l.dirX = ldir.x; l.dirY = ldir.y; l.dirZ = ldir.z;
+        l.intensity = Lighting::GetMainDirectionalIntensity();
+        l.color = (unsigned int)Lighting::GetMainDirectionalColor();
+        return l;
+    }
+
+    // World-space box of what Render draws (mesh vertices through Transform::GetMatrix3D, or the fallback cube)
+    // and the radius of a sphere around the box center that also encloses it.
+    Bounds3 ComputeWorldBounds(float* sphereRadius = nullptr) const {
+        const Transform& t = owner->ctransform();
+        float m[3][4];
+        t.GetMatrix3D(m);
+        float c[3], e[3];
+        const bool meshBounds = mesh_ && mesh_->hasBounds;
+        if (meshBounds) {
+            const Bounds3& lb = mesh_->bounds;
+            c[0] = (lb.minX + lb.maxX) * 0.5f; c[1] = (lb.minY + lb.maxY) * 0.5f; c[2] = (lb.minZ + lb.maxZ) * 0.5f;
+            e[0] = (lb.maxX - lb.minX) * 0.5f; e[1] = (lb.maxY - lb.minY) * 0.5f; e[2] = (lb.maxZ - lb.minZ) * 0.5f;
+        } else {
+            // unit cube around the world position
+            t.GetWorldPosition3D(m[0][3], m[1][3], m[2][3]);
+            c[0] = c[1] = c[2] = 0.0f;
+            e[0] = e[1] = e[2] = 0.5f;
+        }
+        float lo[3], hi[3];
+        for (int r = 0; r < 3; ++r) {
+            float wc = m[r][0] * c[0] + m[r][1] * c[1] + m[r][2] * c[2] + m[r][3];
+            float we = fabsf(m[r][0]) * e[0] + fabsf(m[r][1]) * e[1] + fabsf(m[r][2]) * e[2];
+            lo[r] = wc - we; hi[r] = wc + we;
+        }
+        Bounds3 b;
+        b.minX = lo[0]; b.minY = lo[1]; b.minZ = lo[2];
+        b.maxX = hi[0]; b.maxY = hi[1]; b.maxZ = hi[2];
+        if (sphereRadius) {
+            if (meshBounds) {
+                float s = std::max(fabsf(t.scaleX), std::max(fabsf(t.scaleY), fabsf(t.scaleZ)));
+                *sphereRadius = mesh_->boundsRadius * s;
+            } else {
+                float hx = fabsf(t.scaleX) * 0.5f, hy = fabsf(t.scaleY) * 0.5f, hz = fabsf(t.scaleZ) * 0.5f;
+                *sphereRadius = sqrtf(hx * hx + hy * hy + hz * hz);
+            }
+        }
+        return b;
+    }
+
+    // Lambert blend of the base colour towards base * light colour; packed 0xRRGGBB in and out.
+    // Backends receive these colours as-is, so every backend shades a mesh the same way.
+    static unsigned int ApplyLightingToColor(int baseColor, const VECTOR& normal, const VECTOR& ldir, float lint, int lcol) {
+        auto clamp255 = [](int v) {
+            if (v < 0) return 0;
+            if (v > 255) return 255;
+            return v;
+        };
+        int br = (baseColor >> 16) & 0xFF;
+        int bg = (baseColor >> 8) & 0xFF;
+        int bb = baseColor & 0xFF;
+        int lr = (lcol >> 16) & 0xFF;
+        int lg = (lcol >> 8) & 0xFF;
+        int lb = lcol & 0xFF;
+        float ndotl = 0.0f;
+        float nl = sqrtf(normal.x*normal.x + normal.y*normal.y + normal.z*normal.z);
+        if (nl > 0.0001f) {
+            VECTOR nn = VGet(normal.x / nl, normal.y / nl, normal.z / nl);
+            ndotl = nn.x * (-ldir.x) + nn.y * (-ldir.y) + nn.z * (-ldir.z);
+            if (ndotl < 0.0f) ndotl = 0.0f;
         }
+        float factor = lint * ndotl;
+        float rVal = br * (1.0f - factor) + (br * (lr / 255.0f)) * factor;
+        float gVal = bg * (1.0f - factor) + (bg * (lg / 255.0f)) * factor;
+        float bVal = bb * (1.0f - factor) + (bb * (lb / 255.0f)) * factor;
+        int rr = clamp255((int)rVal);
+        int gg = clamp255((int)gVal);
+        int bb2 = clamp255((int)bVal);
+        return (unsigned int)((rr << 16) | (gg << 8) | bb2);
     }
 
     std::shared_ptr<Component> Clone() const override {
-        if (!meshPath_.empty()) return std::make_shared<MeshRenderer>(meshPath_);
-        return std::make_shared<MeshRenderer>(color_);
+        auto c = !meshPath_.empty() ? std::make_shared<MeshRenderer>(meshPath_) : std::make_shared<MeshRenderer>(color_);
+        c->color_ = color_;
+        c->mesh_ = mesh_; // instances share the loaded geometry (and can be drawn instanced)
+        c->shader_ = shader_;
+        c->lods_ = lods_;
+        c->lodEnabled_ = lodEnabled_;
+        c->wireframe_ = wireframe_;
+        c->layer_ = layer_;
+        c->alpha_ = alpha_;
+        return c;
     }
 
     int color_;
     std::string meshPath_;
-    std::shared_ptr<Mesh> mesh_;
+    std::shared_ptr<const Mesh> mesh_; // shared and read-only: needs bounds and edges filled in, as MeshCache does
     std::shared_ptr<Shader> shader_;
+    std::shared_ptr<const MeshLODChain> lods_; // built (or read from Library/) when the mesh loads; shared by clones
+    int lodLevel_ = 0;
+    bool lodEnabled_ = true;
+    bool wireframe_ = true; // draws the mesh's unique edges; false fills triangles with interpolated per-vertex colour
+    int layer_ = 0;   // render queue layer (0-255); lower layers draw first
+    int alpha_ = 255; // opacity; below 255 the mesh is blended and drawn back to front after the opaque ones
+    bool culled_ = false; // set by the scene's culling pass for the frame being drawn
+    bool queued_ = false; // drawn by the scene's render queue (possibly instanced) for the frame being drawn
 };
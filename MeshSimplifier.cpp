@@ -0,0 +1,323 @@
+#include "MeshSimplifier.h"
+#include <queue>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+
+namespace {
+    // open borders count this much more than the surface they bound (per squared edge length)
+    const double kBorderWeight = 10.0;
+
+    // Symmetric 4x4 sum of weighted plane products; Eval is the weighted squared distance to all planes
+    struct Quadric {
+        double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+        double weight = 0;
+
+        void AddPlane(double a, double b, double c, double d, double w) {
+            a2 += w * a * a; ab += w * a * b; ac += w * a * c; ad += w * a * d;
+            b2 += w * b * b; bc += w * b * c; bd += w * b * d;
+            c2 += w * c * c; cd += w * c * d;
+            d2 += w * d * d;
+            weight += w;
+        }
+        void Add(const Quadric& o) {
+            a2 += o.a2; ab += o.ab; ac += o.ac; ad += o.ad;
+            b2 += o.b2; bc += o.bc; bd += o.bd;
+            c2 += o.c2; cd += o.cd;
+            d2 += o.d2;
+            weight += o.weight;
+        }
+        double Eval(double x, double y, double z) const {
+            double e = x * (a2 * x + 2 * (ab * y + ac * z + ad)) + y * (b2 * y + 2 * (bc * z + bd)) + z * (c2 * z + 2 * cd) + d2;
+            return e > 0.0 ? e : 0.0;
+        }
+    };
+
+    struct Candidate {
+        float cost;             // squared error per unit weight
+        uint32_t from, to;      // `from` moves onto `to`
+        uint32_t fromVersion, toVersion;
+        bool operator<(const Candidate& o) const { return cost > o.cost; } // cheapest on top
+    };
+
+    struct Vec3 { double x, y, z; };
+    Vec3 ToVec(const VECTOR& v) { return { v.x, v.y, v.z }; }
+    Vec3 Sub(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+    Vec3 Cross(const Vec3& a, const Vec3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+    double Dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+    class Simplifier {
+    public:
+        explicit Simplifier(const Mesh& source) : src_(source) {}
+
+        std::vector<MeshSimplifier::Level> Run(const std::vector<size_t>& targets, float maxError);
+
+    private:
+        bool Contains(uint32_t f, uint32_t v) const { return tri_[f * 3] == v || tri_[f * 3 + 1] == v || tri_[f * 3 + 2] == v; }
+        void Setup();
+        void PushEdge(uint32_t a, uint32_t b);
+        bool CanCollapse(uint32_t from, uint32_t to);
+        void Collapse(uint32_t from, uint32_t to);
+        MeshSimplifier::Level Snapshot(float error) const;
+
+        const Mesh& src_;
+        size_t vertexCount_ = 0, faceCount_ = 0, liveFaces_ = 0;
+        std::vector<uint32_t> tri_;
+        std::vector<uint8_t> faceAlive_;
+        std::vector<uint8_t> locked_, removed_;
+        std::vector<uint32_t> version_;
+        std::vector<std::vector<uint32_t>> vertexFaces_; // may list dead faces until the vertex is touched
+        std::vector<Quadric> quadrics_;
+        std::priority_queue<Candidate> heap_;
+        std::vector<uint32_t> mark_, mark2_;
+        uint32_t stamp_ = 0;
+    };
+
+    void Simplifier::Setup() {
+        vertexCount_ = src_.vertices.size();
+        faceCount_ = src_.indices.size() / 3;
+        tri_.resize(faceCount_ * 3);
+        faceAlive_.assign(faceCount_, 0);
+        vertexFaces_.assign(vertexCount_, std::vector<uint32_t>());
+        quadrics_.assign(vertexCount_, Quadric());
+        locked_.assign(vertexCount_, 0);
+        removed_.assign(vertexCount_, 0);
+        version_.assign(vertexCount_, 0);
+        mark_.assign(vertexCount_, 0);
+        mark2_.assign(vertexCount_, 0);
+
+        // faces with bad or repeated indices are dropped
+        for (size_t f = 0; f < faceCount_; ++f) {
+            int a = src_.indices[f * 3], b = src_.indices[f * 3 + 1], c = src_.indices[f * 3 + 2];
+            bool ok = a >= 0 && b >= 0 && c >= 0 && (size_t)a < vertexCount_ && (size_t)b < vertexCount_ &&
+                      (size_t)c < vertexCount_ && a != b && b != c && a != c;
+            tri_[f * 3] = (uint32_t)a; tri_[f * 3 + 1] = (uint32_t)b; tri_[f * 3 + 2] = (uint32_t)c;
+            if (!ok) continue;
+            faceAlive_[f] = 1;
+            ++liveFaces_;
+            for (int k = 0; k < 3; ++k) vertexFaces_[tri_[f * 3 + k]].push_back((uint32_t)f);
+        }
+
+        // seams: vertices sharing a position with another vertex stay put
+        std::vector<uint32_t> order(vertexCount_);
+        for (size_t i = 0; i < vertexCount_; ++i) order[i] = (uint32_t)i;
+        auto less = [&](uint32_t a, uint32_t b) {
+            const VECTOR& p = src_.vertices[a]; const VECTOR& q = src_.vertices[b];
+            if (p.x != q.x) return p.x < q.x;
+            if (p.y != q.y) return p.y < q.y;
+            return p.z < q.z;
+        };
+        std::sort(order.begin(), order.end(), less);
+        for (size_t i = 1; i < vertexCount_; ++i) {
+            if (!less(order[i - 1], order[i])) locked_[order[i - 1]] = locked_[order[i]] = 1;
+        }
+
+        // face planes, weighted by area
+        std::vector<Vec3> normals(faceCount_, Vec3{ 0, 0, 0 });
+        for (size_t f = 0; f < faceCount_; ++f) {
+            if (!faceAlive_[f]) continue;
+            Vec3 p0 = ToVec(src_.vertices[tri_[f * 3]]);
+            Vec3 n = Cross(Sub(ToVec(src_.vertices[tri_[f * 3 + 1]]), p0), Sub(ToVec(src_.vertices[tri_[f * 3 + 2]]), p0));
+            double len = sqrt(Dot(n, n));
+            if (len <= 0.0) continue;
+            n = { n.x / len, n.y / len, n.z / len };
+            normals[f] = n;
+            double d = -Dot(n, p0);
+            for (int k = 0; k < 3; ++k) quadrics_[tri_[f * 3 + k]].AddPlane(n.x, n.y, n.z, d, len * 0.5);
+        }
+
+        // unique edges; those with a single face are borders and get a plane through the edge,
+        // perpendicular to the face
+        std::vector<std::pair<uint64_t, uint32_t>> edges;
+        edges.reserve(liveFaces_ * 3);
+        for (size_t f = 0; f < faceCount_; ++f) {
+            if (!faceAlive_[f]) continue;
+            for (int k = 0; k < 3; ++k) {
+                uint32_t a = tri_[f * 3 + k], b = tri_[f * 3 + (k + 1) % 3];
+                if (a > b) std::swap(a, b);
+                edges.push_back({ ((uint64_t)a << 32) | b, (uint32_t)f });
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        size_t unique = 0;
+        for (size_t i = 0; i < edges.size();) {
+            size_t j = i + 1;
+            while (j < edges.size() && edges[j].first == edges[i].first) ++j;
+            if (j - i == 1) {
+                uint32_t a = (uint32_t)(edges[i].first >> 32), b = (uint32_t)edges[i].first;
+                const Vec3& n = normals[edges[i].second];
+                Vec3 pa = ToVec(src_.vertices[a]);
+                Vec3 e = Sub(ToVec(src_.vertices[b]), pa);
+                Vec3 pn = Cross(e, n);
+                double len = sqrt(Dot(pn, pn));
+                if (len > 0.0) {
+                    pn = { pn.x / len, pn.y / len, pn.z / len };
+                    double d = -Dot(pn, pa);
+                    double w = kBorderWeight * Dot(e, e);
+                    quadrics_[a].AddPlane(pn.x, pn.y, pn.z, d, w);
+                    quadrics_[b].AddPlane(pn.x, pn.y, pn.z, d, w);
+                }
+            }
+            edges[unique++] = edges[i];
+            i = j;
+        }
+        // costs once every plane is in
+        for (size_t i = 0; i < unique; ++i) PushEdge((uint32_t)(edges[i].first >> 32), (uint32_t)edges[i].first);
+    }
+
+    void Simplifier::PushEdge(uint32_t a, uint32_t b) {
+        Quadric q = quadrics_[a];
+        q.Add(quadrics_[b]);
+        const double invWeight = q.weight > 0.0 ? 1.0 / q.weight : 1.0;
+        Candidate c;
+        c.cost = INFINITY;
+        if (!locked_[a]) {
+            const VECTOR& p = src_.vertices[b];
+            c = { (float)(q.Eval(p.x, p.y, p.z) * invWeight), a, b, version_[a], version_[b] };
+        }
+        if (!locked_[b]) {
+            const VECTOR& p = src_.vertices[a];
+            float cost = (float)(q.Eval(p.x, p.y, p.z) * invWeight);
+            if (cost < c.cost) c = { cost, b, a, version_[b], version_[a] };
+        }
+        if (c.cost < INFINITY) heap_.push(c);
+    }
+
+    bool Simplifier::CanCollapse(uint32_t from, uint32_t to) {
+        ++stamp_;
+        for (uint32_t f : vertexFaces_[to]) {
+            if (!faceAlive_[f]) continue;
+            for (int k = 0; k < 3; ++k) mark_[tri_[f * 3 + k]] = stamp_;
+        }
+        const Vec3 target = ToVec(src_.vertices[to]);
+        int shared = 0, common = 0;
+        for (uint32_t f : vertexFaces_[from]) {
+            if (!faceAlive_[f]) continue;
+            const uint32_t* t = &tri_[f * 3];
+            if (Contains(f, to)) {
+                ++shared;
+            } else {
+                // the face keeps its orientation with `from` moved onto `to`
+                Vec3 p[3], q[3];
+                for (int k = 0; k < 3; ++k) {
+                    p[k] = ToVec(src_.vertices[t[k]]);
+                    q[k] = t[k] == from ? target : p[k];
+                }
+                Vec3 before = Cross(Sub(p[1], p[0]), Sub(p[2], p[0]));
+                Vec3 after = Cross(Sub(q[1], q[0]), Sub(q[2], q[0]));
+                // reject flips and near-flips (normal turning by more than ~75 degrees)
+                if (Dot(before, after) <= 0.25 * sqrt(Dot(before, before) * Dot(after, after))) return false;
+            }
+            // link condition: the only vertices next to both ends are the far corners of the shared faces
+            for (int k = 0; k < 3; ++k) {
+                uint32_t w = t[k];
+                if (w == from || w == to || mark_[w] != stamp_ || mark2_[w] == stamp_) continue;
+                mark2_[w] = stamp_;
+                ++common;
+            }
+        }
+        return shared > 0 && common == shared;
+    }
+
+    void Simplifier::Collapse(uint32_t from, uint32_t to) {
+        std::vector<uint32_t>& toFaces = vertexFaces_[to];
+        for (uint32_t f : vertexFaces_[from]) {
+            if (!faceAlive_[f]) continue;
+            if (Contains(f, to)) {
+                faceAlive_[f] = 0;
+                --liveFaces_;
+                continue;
+            }
+            for (int k = 0; k < 3; ++k) if (tri_[f * 3 + k] == from) tri_[f * 3 + k] = to;
+            toFaces.push_back(f);
+        }
+        std::vector<uint32_t>().swap(vertexFaces_[from]);
+        toFaces.erase(std::remove_if(toFaces.begin(), toFaces.end(), [&](uint32_t f) { return !faceAlive_[f]; }), toFaces.end());
+        quadrics_[to].Add(quadrics_[from]);
+        removed_[from] = 1;
+        ++version_[to];
+
+        // every edge at `to` has a new cost
+        ++stamp_;
+        mark_[to] = stamp_;
+        for (uint32_t f : toFaces) {
+            for (int k = 0; k < 3; ++k) {
+                uint32_t w = tri_[f * 3 + k];
+                if (mark_[w] == stamp_) continue;
+                mark_[w] = stamp_;
+                PushEdge(to, w);
+            }
+        }
+    }
+
+    MeshSimplifier::Level Simplifier::Snapshot(float error) const {
+        MeshSimplifier::Level level;
+        level.error = error;
+        auto mesh = std::make_shared<Mesh>();
+        const bool hasNormals = src_.normals.size() == vertexCount_;
+        const bool hasUVs = src_.uvs.size() == vertexCount_;
+        std::vector<int> remap(vertexCount_, -1);
+        std::vector<size_t> liveBefore(faceCount_ + 1, 0); // live faces before each source face
+        mesh->indices.reserve(liveFaces_ * 3);
+        for (size_t f = 0; f < faceCount_; ++f) {
+            liveBefore[f + 1] = liveBefore[f] + faceAlive_[f];
+            if (!faceAlive_[f]) continue;
+            for (int k = 0; k < 3; ++k) {
+                uint32_t v = tri_[f * 3 + k];
+                if (remap[v] < 0) {
+                    // vertices in first-use order
+                    remap[v] = (int)mesh->vertices.size();
+                    mesh->vertices.push_back(src_.vertices[v]);
+                    if (hasNormals) mesh->normals.push_back(src_.normals[v]);
+                    if (hasUVs) mesh->uvs.push_back(src_.uvs[v]);
+                }
+                mesh->indices.push_back(remap[v]);
+            }
+        }
+        // faces keep their source order, so each submesh stays one range
+        for (const Mesh::SubMesh& s : src_.submeshes) {
+            size_t first = std::min(faceCount_, s.indexStart / 3), last = std::min(faceCount_, (s.indexStart + s.indexCount) / 3);
+            mesh->submeshes.push_back({ liveBefore[first] * 3, (liveBefore[last] - liveBefore[first]) * 3, s.materialIndex });
+        }
+        mesh->materials = src_.materials;
+        mesh->ComputeBounds();
+        mesh->BuildEdges();
+        level.mesh = mesh;
+        return level;
+    }
+
+    std::vector<MeshSimplifier::Level> Simplifier::Run(const std::vector<size_t>& targets, float maxError) {
+        std::vector<MeshSimplifier::Level> levels;
+        Setup();
+        const double maxCost = (double)maxError * maxError;
+        double worst = 0.0;
+        size_t next = 0;
+        while (next < targets.size()) {
+            if (liveFaces_ <= targets[next]) {
+                levels.push_back(Snapshot((float)sqrt(worst)));
+                ++next;
+                continue;
+            }
+            if (heap_.empty()) break;
+            Candidate c = heap_.top();
+            heap_.pop();
+            if (removed_[c.from] || removed_[c.to] || version_[c.from] != c.fromVersion || version_[c.to] != c.toVersion) continue;
+            if (c.cost > maxCost) break;
+            if (!CanCollapse(c.from, c.to)) continue;
+            Collapse(c.from, c.to);
+            worst = std::max(worst, (double)c.cost);
+        }
+        return levels;
+    }
+}
+
+namespace MeshSimplifier {
+
+std::vector<Level> Simplify(const Mesh& source, const std::vector<size_t>& targets, float maxError) {
+    if (targets.empty() || source.indices.size() < 3) return std::vector<Level>();
+    Simplifier s(source);
+    return s.Run(targets, maxError);
+}
+
+} // namespace MeshSimplifier
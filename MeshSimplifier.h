@@ -0,0 +1,25 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include "Mesh.h"
+
+// MeshSimplifier: quadric error metric (Garland-Heckbert) edge collapse. Each collapse moves one vertex onto
+// a neighbour, so simplified meshes use a subset of the source vertices and keep their normals and UVs
+// exactly. Vertices on attribute seams (several vertices at one position) are never moved; open borders
+// are held in place by extra constraint planes. Collapses that would flip a triangle or make the surface
+// non-manifold are skipped.
+namespace MeshSimplifier {
+
+struct Level {
+    std::shared_ptr<Mesh> mesh;
+    float error = 0.0f; // largest collapse error so far, in mesh units (RMS distance to the source planes)
+};
+
+// Simplify `source` in a single pass, copying the mesh out each time its triangle count falls to the next
+// of `targets` (descending). Stops early - returning fewer levels - once the cheapest remaining collapse
+// would exceed maxError (mesh units) or none is possible. Meshes keep material and submesh ranges;
+// bounds and edges are filled in.
+std::vector<Level> Simplify(const Mesh& source, const std::vector<size_t>& targets, float maxError);
+
+} // namespace MeshSimplifier
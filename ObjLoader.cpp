@@ -1,59 +1,518 @@
 #include "ObjLoader.h"
-#include <fstream>
-#include <sstream>
-#include <iostream>
+#include "MeshOptimizer.h"
+#include "MappedFile.h"
+#include "JobSystem.h"
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
 #include <algorithm>
+#include <unordered_map>
+#include <vector>
 
-std::shared_ptr<Mesh> ObjLoader::LoadObj(const std::string& path) {
-    std::ifstream ifs(path);
-    if (!ifs) return nullptr;
+namespace {
+    // files are split into chunks of at least this size, one per thread
+    const size_t kMinChunkBytes = 1 << 20;
+
+    inline bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    inline const char* SkipBlanks(const char* p, const char* end) {
+        while (p < end && IsBlank(*p)) ++p;
+        return p;
+    }
+
+    inline const char* NextLine(const char* p, const char* end) {
+        const char* nl = static_cast<const char*>(memchr(p, '\n', end - p));
+        return nl ? nl + 1 : end;
+    }
+
+    // p starts with `tag` followed by a blank
+    inline bool IsTag(const char* p, const char* end, const char* tag, size_t length) {
+        return (size_t)(end - p) > length && memcmp(p, tag, length) == 0 && IsBlank(p[length]);
+    }
+
+    // rest of the line without surrounding blanks (names and paths)
+    std::string RestOfLine(const char* p, const char* end) {
+        p = SkipBlanks(p, end);
+        const char* e = p;
+        while (e < end && *e != '\n') ++e;
+        while (e > p && IsBlank(e[-1])) --e;
+        return std::string(p, e);
+    }
+
+    // from_chars is locale independent and correctly rounded; it doesn't take a leading '+'
+    inline const char* ParseFloat(const char* p, const char* end, float& out) {
+        p = SkipBlanks(p, end);
+        if (p < end && *p == '+') ++p;
+        std::from_chars_result r = std::from_chars(p, end, out);
+        if (r.ec != std::errc()) { out = 0.0f; return p; }
+        return r.ptr;
+    }
+
+    // integer at p ("12", "-3"); false when there is none
+    inline bool ParseIndex(const char*& p, const char* end, int& out) {
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+        const char* digits = p;
+        int value = 0;
+        while (p < end && (unsigned)(*p - '0') < 10u) value = value * 10 + (*p++ - '0');
+        out = negative ? -value : value;
+        return p != digits;
+    }
+
+    double MsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // 0-based v/vt/vn of one face corner, -1 when absent
+    struct Corner { int v, vt, vn; };
+
+    // state records between faces, applied in file order by the merge
+    struct StateChange {
+        enum Kind { UseMaterial, MaterialLibrary, Smoothing };
+        size_t face; // applies from this face of the chunk on
+        Kind kind;
+        int group;
+        std::string name;
+    };
+
+    // records parsed by one thread. Negative (relative) indices depend on how many records came before
+    // the chunk; they are stored relative to the chunk start and listed for the merge pass.
+    struct Chunk {
+        std::vector<VECTOR> positions, texcoords, normals;
+        std::vector<Corner> corners;
+        std::vector<uint32_t> faceSizes;                    // corners per face, in order
+        std::vector<std::pair<size_t, int>> relative;       // corner, mask of relative v (1), vt (2), vn (4)
+        std::vector<StateChange> changes;
+    };
+
+    inline void ParseCornerIndex(const char*& p, const char* end, int count, int bit, int& out, int& relativeMask) {
+        int value;
+        if (!ParseIndex(p, end, value) || value == 0) return;
+        if (value < 0) { out = count + value; relativeMask |= bit; }
+        else out = value - 1;
+    }
+
+    // Parse the lines starting in [p, end); the last one may run on up to fileEnd
+    void ParseLines(const char* p, const char* end, const char* fileEnd, Chunk& out) {
+        // rough guesses from typical record lengths; saves most regrowth on big files
+        out.positions.reserve((end - p) / 64);
+        out.corners.reserve((end - p) / 12);
+        while (p < end) {
+            p = SkipBlanks(p, fileEnd);
+            if (fileEnd - p < 2) break;
+            if (p[0] == 'v' && IsBlank(p[1])) {
+                float x, y, z;
+                p = ParseFloat(p + 2, fileEnd, x);
+                p = ParseFloat(p, fileEnd, y);
+                p = ParseFloat(p, fileEnd, z);
+                out.positions.push_back(VGet(x, y, z));
+            } else if (p[0] == 'f' && IsBlank(p[1])) {
+                uint32_t size = 0;
+                p += 2;
+                for (;;) {
+                    p = SkipBlanks(p, fileEnd);
+                    if (p >= fileEnd || *p == '\n' || *p == '#') break;
+                    // v, v/vt, v//vn or v/vt/vn
+                    Corner c = { -1, -1, -1 };
+                    int relativeMask = 0;
+                    ParseCornerIndex(p, fileEnd, (int)out.positions.size(), 1, c.v, relativeMask);
+                    if (p < fileEnd && *p == '/') {
+                        ++p;
+                        ParseCornerIndex(p, fileEnd, (int)out.texcoords.size(), 2, c.vt, relativeMask);
+                        if (p < fileEnd && *p == '/') {
+                            ++p;
+                            ParseCornerIndex(p, fileEnd, (int)out.normals.size(), 4, c.vn, relativeMask);
+                        }
+                    }
+                    while (p < fileEnd && !IsBlank(*p) && *p != '\n') ++p; // anything else in the token
+                    if (relativeMask) out.relative.push_back({ out.corners.size(), relativeMask });
+                    out.corners.push_back(c);
+                    ++size;
+                }
+                out.faceSizes.push_back(size);
+            } else if (IsTag(p, fileEnd, "vt", 2)) {
+                float u, v;
+                p = ParseFloat(p + 3, fileEnd, u);
+                p = ParseFloat(p, fileEnd, v);
+                out.texcoords.push_back(VGet(u, v, 0.0f));
+            } else if (IsTag(p, fileEnd, "vn", 2)) {
+                float x, y, z;
+                p = ParseFloat(p + 3, fileEnd, x);
+                p = ParseFloat(p, fileEnd, y);
+                p = ParseFloat(p, fileEnd, z);
+                out.normals.push_back(VGet(x, y, z));
+            } else if (p[0] == 's' && IsBlank(p[1])) {
+                // "s off" / "s 0" is flat, any other group smooth
+                std::string value = RestOfLine(p + 2, fileEnd);
+                int group = value == "off" ? 0 : (value.empty() || value == "on" ? 1 : atoi(value.c_str()));
+                out.changes.push_back({ out.faceSizes.size(), StateChange::Smoothing, group, std::string() });
+            } else if (IsTag(p, fileEnd, "usemtl", 6)) {
+                out.changes.push_back({ out.faceSizes.size(), StateChange::UseMaterial, 0, RestOfLine(p + 7, fileEnd) });
+            } else if (IsTag(p, fileEnd, "mtllib", 6)) {
+                out.changes.push_back({ out.faceSizes.size(), StateChange::MaterialLibrary, 0, RestOfLine(p + 7, fileEnd) });
+            }
+            // o/g only name parts of the file; faces are grouped by material
+            p = NextLine(p, fileEnd);
+        }
+    }
+
+    // open-addressing map from a corner key to a vertex (or normal accumulator), at most half full
+    class CornerMap {
+    public:
+        struct Key { int v, vt, vn, group; };
+
+        explicit CornerMap(size_t expected) {
+            size_t capacity = 16;
+            while (capacity < expected * 2) capacity <<= 1;
+            keys_.resize(capacity);
+            values_.assign(capacity, -1);
+        }
+
+        // value stored for key, or `value` after inserting it
+        int FindOrInsert(const Key& key, int value) {
+            if ((count_ + 1) * 2 > values_.size()) Grow();
+            size_t h = Find(key);
+            if (values_[h] >= 0) return values_[h];
+            keys_[h] = key;
+            values_[h] = value;
+            ++count_;
+            return value;
+        }
+
+    private:
+        size_t Find(const Key& key) const {
+            const size_t mask = values_.size() - 1;
+            uint64_t x = (uint64_t)(uint32_t)key.v * 0x9E3779B97F4A7C15ull;
+            x ^= ((uint64_t)(uint32_t)key.vt << 32 | (uint32_t)key.vn) * 0xC2B2AE3D27D4EB4Full;
+            x ^= (uint64_t)(uint32_t)key.group * 0x165667B19E3779F9ull;
+            size_t h = (size_t)(x ^ (x >> 29)) & mask;
+            while (values_[h] >= 0) {
+                const Key& k = keys_[h];
+                if (k.v == key.v && k.vt == key.vt && k.vn == key.vn && k.group == key.group) break;
+                h = (h + 1) & mask;
+            }
+            return h;
+        }
+
+        void Grow() {
+            std::vector<Key> keys;
+            std::vector<int> values;
+            keys.swap(keys_);
+            values.swap(values_);
+            keys_.resize(keys.size() * 2);
+            values_.assign(values.size() * 2, -1);
+            for (size_t i = 0; i < values.size(); ++i) {
+                if (values[i] < 0) continue;
+                size_t h = Find(keys[i]);
+                keys_[h] = keys[i];
+                values_[h] = values[i];
+            }
+        }
+
+        std::vector<Key> keys_;
+        std::vector<int> values_;
+        size_t count_ = 0;
+    };
+
+    int PackColor(float r, float g, float b) {
+        auto channel = [](float c) { return (int)(std::min(1.0f, std::max(0.0f, c)) * 255.0f + 0.5f); };
+        return (channel(r) << 16) | (channel(g) << 8) | channel(b);
+    }
+
+    bool IsAbsolutePath(const std::string& path) {
+        return (!path.empty() && (path[0] == '/' || path[0] == '\\')) || (path.size() > 1 && path[1] == ':');
+    }
+
+    std::string DirectoryOf(const std::string& path) {
+        size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+    }
+
+    // newmtl / Kd / map_Kd from one .mtl file; texture paths are resolved against the library's directory
+    void LoadMaterialLibrary(const std::string& path, std::unordered_map<std::string, Mesh::Material>& library) {
+        MappedFile file(path);
+        if (!file.IsOpen()) return;
+        const std::string directory = DirectoryOf(path);
+        const char* p = file.Data();
+        const char* end = p + file.Size();
+        Mesh::Material* current = nullptr;
+        while (p < end) {
+            p = SkipBlanks(p, end);
+            if (IsTag(p, end, "newmtl", 6)) {
+                std::string name = RestOfLine(p + 7, end);
+                current = &library[name];
+                *current = Mesh::Material();
+                current->name = name;
+            } else if (current && IsTag(p, end, "Kd", 2)) {
+                float r, g, b;
+                p = ParseFloat(p + 3, end, r);
+                p = ParseFloat(p, end, g);
+                p = ParseFloat(p, end, b);
+                current->diffuseColor = PackColor(r, g, b);
+            } else if (current && IsTag(p, end, "map_Kd", 6)) {
+                // options (-s, -o, ...) come first; the file name is the last token
+                std::string value = RestOfLine(p + 7, end);
+                size_t space = value.find_last_of(" \t");
+                std::string texture = space == std::string::npos ? value : value.substr(space + 1);
+                current->diffuseTexture = IsAbsolutePath(texture) ? texture : directory + texture;
+            }
+            p = NextLine(p, end);
+        }
+    }
+
+    VECTOR Normalized(const VECTOR& v) {
+        float length = sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+        return length > 0.0f ? VGet(v.x / length, v.y / length, v.z / length) : VGet(0.0f, 0.0f, 0.0f);
+    }
+}
+
+std::shared_ptr<Mesh> ObjLoader::ParseObj(const char* data, size_t size, const std::string& directory, LoadStats* stats) {
+    auto start = std::chrono::steady_clock::now();
+    JobSystem& jobs = JobSystem::Instance();
+    const int chunkCount = std::max(1, jobs.ChunkCount(size, kMinChunkBytes));
+    std::vector<Chunk> chunks(chunkCount);
+    jobs.ParallelFor(size, kMinChunkBytes, [&](size_t begin, size_t end, int c) {
+        // a chunk owns the lines that start inside it
+        const char* p = data + begin;
+        if (begin > 0 && data[begin - 1] != '\n') p = NextLine(p, data + size);
+        ParseLines(p, data + end, data + size, chunks[c]);
+    });
+
+    // prefix sums place every chunk's records in the merged arrays; relative indices become absolute
+    struct Offsets { size_t positions, texcoords, normals; };
+    std::vector<Offsets> offsets(chunkCount + 1, Offsets{ 0, 0, 0 });
+    for (int c = 0; c < chunkCount; ++c) {
+        offsets[c + 1].positions = offsets[c].positions + chunks[c].positions.size();
+        offsets[c + 1].texcoords = offsets[c].texcoords + chunks[c].texcoords.size();
+        offsets[c + 1].normals = offsets[c].normals + chunks[c].normals.size();
+    }
+    std::vector<VECTOR> positions(offsets[chunkCount].positions);
+    std::vector<VECTOR> texcoords(offsets[chunkCount].texcoords);
+    std::vector<VECTOR> normals(offsets[chunkCount].normals);
+    jobs.ParallelFor(chunkCount, 1, [&](size_t begin, size_t end, int) {
+        for (size_t c = begin; c < end; ++c) {
+            Chunk& chunk = chunks[c];
+            const Offsets& o = offsets[c];
+            std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + o.positions);
+            std::copy(chunk.texcoords.begin(), chunk.texcoords.end(), texcoords.begin() + o.texcoords);
+            std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + o.normals);
+            for (const auto& r : chunk.relative) {
+                Corner& corner = chunk.corners[r.first];
+                if (r.second & 1) corner.v += (int)o.positions;
+                if (r.second & 2) corner.vt += (int)o.texcoords;
+                if (r.second & 4) corner.vn += (int)o.normals;
+            }
+        }
+    });
+
+    // Unique vertices in first-use order. Corners without a file normal share an accumulator per position
+    // and smoothing group, so UV seams stay smooth; on flat faces every corner is its own vertex.
     auto mesh = std::make_shared<Mesh>();
-    std::vector<VECTOR> tempVerts;
-    std::string line;
-    while (std::getline(ifs, line)) {
-        if (line.size() < 2) continue;
-        if (line[0] == '#') continue;
-        std::istringstream iss(line);
-        std::string tag;
-        iss >> tag;
-        if (tag == "v") {
-            float x,y,z; iss >> x >> y >> z;
-            tempVerts.push_back(VGet(x,y,z));
-        } else if (tag == "f") {
-            // supports triangles or quads; faces may contain slashes
-            std::vector<int> faceIdx;
-            std::string part;
-            while (iss >> part) {
-                int vi = 0;
-                if (part.find('/') != std::string::npos) {
-                    // replace slashes then parse first number
-                    std::replace(part.begin(), part.end(), '/', ' ');
-                    std::istringstream ss(part);
-                    ss >> vi;
+    const bool hasUVs = !texcoords.empty();
+    std::vector<int> vertexAccumulator; // per vertex, -1 with a file normal
+    std::vector<VECTOR> accumulators;
+    std::unordered_map<std::string, Mesh::Material> library;
+    std::unordered_map<std::string, int> materialIndex;
+    std::vector<std::vector<int>> trianglesByMaterial(1); // slot 0: faces before any usemtl
+    size_t triangleCount = 0;
+    for (const Chunk& chunk : chunks)
+        for (uint32_t n : chunk.faceSizes) triangleCount += n >= 3 ? n - 2 : 0;
+    trianglesByMaterial[0].reserve(triangleCount * 3);
+    int materialSlot = 0;
+    int group = 1;
+    std::vector<int> face;
+
+    // positions-only files in one smoothing group need no deduplication: every position is a vertex
+    bool positionsOnly = texcoords.empty() && normals.empty();
+    for (const Chunk& chunk : chunks)
+        for (const StateChange& s : chunk.changes)
+            if (s.kind == StateChange::Smoothing && s.group != group) positionsOnly = false;
+    if (positionsOnly) {
+        mesh->vertices = positions;
+        mesh->normals.assign(positions.size(), VGet(0.0f, 0.0f, 0.0f));
+        accumulators.assign(positions.size(), VGet(0.0f, 0.0f, 0.0f));
+        vertexAccumulator.resize(positions.size());
+        for (size_t v = 0; v < positions.size(); ++v) vertexAccumulator[v] = (int)v;
+    }
+    CornerMap vertexMap(positionsOnly ? 0 : positions.size());
+    CornerMap normalMap(positionsOnly || !normals.empty() ? 0 : positions.size());
+
+    auto addVertex = [&](const Corner& c, int vt, int vn, int accumulator) {
+        mesh->vertices.push_back(positions[c.v]);
+        mesh->normals.push_back(vn >= 0 ? normals[vn] : VGet(0.0f, 0.0f, 0.0f));
+        if (hasUVs) mesh->uvs.push_back(vt >= 0 ? texcoords[vt] : VGet(0.0f, 0.0f, 0.0f));
+        vertexAccumulator.push_back(accumulator);
+        return (int)mesh->vertices.size() - 1;
+    };
+
+    for (Chunk& chunk : chunks) {
+        size_t change = 0, corner = 0;
+        for (size_t f = 0; f <= chunk.faceSizes.size(); ++f) {
+            for (; change < chunk.changes.size() && chunk.changes[change].face == f; ++change) {
+                const StateChange& s = chunk.changes[change];
+                if (s.kind == StateChange::Smoothing) {
+                    group = s.group;
+                } else if (s.kind == StateChange::MaterialLibrary) {
+                    LoadMaterialLibrary(IsAbsolutePath(s.name) ? s.name : directory + s.name, library);
                 } else {
-                    vi = std::stoi(part);
+                    auto found = materialIndex.find(s.name);
+                    if (found == materialIndex.end()) {
+                        // usemtl without a definition still gets its own (default) material
+                        auto defined = library.find(s.name);
+                        Mesh::Material material = defined != library.end() ? defined->second : Mesh::Material();
+                        material.name = s.name;
+                        found = materialIndex.emplace(s.name, (int)mesh->materials.size()).first;
+                        mesh->materials.push_back(material);
+                        trianglesByMaterial.emplace_back();
+                    }
+                    materialSlot = found->second + 1;
                 }
-                if (vi < 0) vi = (int)tempVerts.size() + 1 + vi; // negative index
-                faceIdx.push_back(vi - 1);
-            }
-            if (faceIdx.size() == 3) {
-                mesh->indices.push_back(faceIdx[0]);
-                mesh->indices.push_back(faceIdx[1]);
-                mesh->indices.push_back(faceIdx[2]);
-            } else if (faceIdx.size() == 4) {
-                // triangulate quad
-                mesh->indices.push_back(faceIdx[0]); mesh->indices.push_back(faceIdx[1]); mesh->indices.push_back(faceIdx[2]);
-                mesh->indices.push_back(faceIdx[0]); mesh->indices.push_back(faceIdx[2]); mesh->indices.push_back(faceIdx[3]);
-            } else if (faceIdx.size() > 4) {
-                // fan triangulation
-                for (size_t i = 1; i + 1 < faceIdx.size(); ++i) {
-                    mesh->indices.push_back(faceIdx[0]);
-                    mesh->indices.push_back(faceIdx[i]);
-                    mesh->indices.push_back(faceIdx[i+1]);
+            }
+            if (f == chunk.faceSizes.size()) break;
+
+            const uint32_t n = chunk.faceSizes[f];
+            const Corner* corners = chunk.corners.data() + corner;
+            corner += n;
+            bool valid = n >= 3;
+            for (uint32_t k = 0; k < n && valid; ++k) valid = corners[k].v >= 0 && (size_t)corners[k].v < positions.size();
+            if (!valid) continue;
+
+            // area-weighted polygon normal (Newell), the same as (v1 - v0) x (v2 - v0) for a triangle
+            VECTOR faceNormal = VGet(0.0f, 0.0f, 0.0f);
+            for (uint32_t k = 0; k < n; ++k) {
+                const VECTOR& a = positions[corners[k].v];
+                const VECTOR& b = positions[corners[(k + 1) % n].v];
+                faceNormal.x += (a.y - b.y) * (a.z + b.z);
+                faceNormal.y += (a.z - b.z) * (a.x + b.x);
+                faceNormal.z += (a.x - b.x) * (a.y + b.y);
+            }
+
+            face.clear();
+            for (uint32_t k = 0; k < n; ++k) {
+                const Corner& c = corners[k];
+                int vt = c.vt >= 0 && (size_t)c.vt < texcoords.size() ? c.vt : -1;
+                int vn = c.vn >= 0 && (size_t)c.vn < normals.size() ? c.vn : -1;
+                int vertex;
+                if (positionsOnly) {
+                    vertex = c.v;
+                } else if (vn < 0 && group == 0) {
+                    accumulators.push_back(VGet(0.0f, 0.0f, 0.0f));
+                    vertex = addVertex(c, vt, vn, (int)accumulators.size() - 1);
+                } else {
+                    int next = (int)mesh->vertices.size();
+                    vertex = vertexMap.FindOrInsert({ c.v, vt, vn, vn < 0 ? group : 0 }, next);
+                    if (vertex == next) {
+                        int accumulator = -1;
+                        if (vn < 0) {
+                            accumulator = normalMap.FindOrInsert({ c.v, -1, -1, group }, (int)accumulators.size());
+                            if (accumulator == (int)accumulators.size()) accumulators.push_back(VGet(0.0f, 0.0f, 0.0f));
+                        }
+                        addVertex(c, vt, vn, accumulator);
+                    }
+                }
+                int accumulator = vertexAccumulator[vertex];
+                if (accumulator >= 0) {
+                    VECTOR& sum = accumulators[accumulator];
+                    sum.x += faceNormal.x; sum.y += faceNormal.y; sum.z += faceNormal.z;
                 }
+                face.push_back(vertex);
+            }
+            // fan triangulation (quads split along 0-2)
+            std::vector<int>& triangles = trianglesByMaterial[materialSlot];
+            for (size_t i = 1; i + 1 < face.size(); ++i) {
+                triangles.push_back(face[0]);
+                triangles.push_back(face[i]);
+                triangles.push_back(face[i + 1]);
             }
         }
     }
-    mesh->vertices = std::move(tempVerts);
+    for (size_t v = 0; v < mesh->vertices.size(); ++v) {
+        if (vertexAccumulator[v] >= 0) mesh->normals[v] = Normalized(accumulators[vertexAccumulator[v]]);
+    }
+
+    // one submesh per material in order of first use (materialIndex -1 before any usemtl); no submeshes
+    // when the file uses no materials
+    for (size_t slot = 0; slot < trianglesByMaterial.size(); ++slot) {
+        std::vector<int>& triangles = trianglesByMaterial[slot];
+        if (triangles.empty()) continue;
+        if (!mesh->materials.empty()) mesh->submeshes.push_back({ mesh->indices.size(), triangles.size(), (int)slot - 1 });
+        if (mesh->indices.empty()) mesh->indices.swap(triangles);
+        else mesh->indices.insert(mesh->indices.end(), triangles.begin(), triangles.end());
+    }
+
+    if (stats) {
+        stats->bytes = size;
+        stats->vertices = mesh->vertices.size();
+        stats->faces = mesh->indices.size() / 3;
+        stats->chunks = chunkCount;
+        stats->parseMs = MsSince(start);
+    }
+    return mesh;
+}
+
+std::shared_ptr<Mesh> ObjLoader::LoadObj(const std::string& path, LoadStats* stats) {
+    auto start = std::chrono::steady_clock::now();
+    MappedFile file(path);
+    if (!file.IsOpen()) return nullptr;
+    auto mesh = ParseObj(file.Data(), file.Size(), DirectoryOf(path), stats);
+    if (stats) stats->parseMs = MsSince(start);
+    MeshOptimizer::Optimize(*mesh);
+    mesh->ComputeBounds();
+    mesh->BuildEdges();
     return mesh;
 }
+
+bool ObjLoader::ParsePositions(const char* data, size_t size, std::vector<VECTOR>& positions, std::vector<int>* indices) {
+    positions.clear();
+    if (indices) indices->clear();
+    const char* p = data;
+    const char* end = data + size;
+    std::vector<int> face;
+    while (p < end) {
+        p = SkipBlanks(p, end);
+        if (end - p < 2) break;
+        if (p[0] == 'v' && IsBlank(p[1])) {
+            float x, y, z;
+            p = ParseFloat(p + 2, end, x);
+            p = ParseFloat(p, end, y);
+            p = ParseFloat(p, end, z);
+            positions.push_back(VGet(x, y, z));
+        } else if (indices && p[0] == 'f' && IsBlank(p[1])) {
+            face.clear();
+            p += 2;
+            for (;;) {
+                p = SkipBlanks(p, end);
+                if (p >= end || *p == '\n' || *p == '#') break;
+                int v;
+                if (!ParseIndex(p, end, v) || v == 0) return false;
+                face.push_back(v < 0 ? (int)positions.size() + v : v - 1);
+                while (p < end && !IsBlank(*p) && *p != '\n') ++p; // vt/vn part of the corner
+            }
+            for (size_t i = 1; i + 1 < face.size(); ++i) {
+                indices->push_back(face[0]);
+                indices->push_back(face[i]);
+                indices->push_back(face[i + 1]);
+            }
+        }
+        p = NextLine(p, end);
+    }
+    if (indices) {
+        for (int index : *indices)
+            if (index < 0 || (size_t)index >= positions.size()) return false;
+    }
+    return true;
+}
+
+ObjLoader::LoadStats ObjLoader::Benchmark(const std::string& path, int runs) {
+    LoadStats best;
+    MappedFile file(path);
+    if (!file.IsOpen()) return best;
+    for (int i = 0; i < runs; ++i) {
+        LoadStats s;
+        ParseObj(file.Data(), file.Size(), DirectoryOf(path), &s);
+        if (i == 0 || s.parseMs < best.parseMs) best = s;
+    }
+    return best;
+}
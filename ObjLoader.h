@@ -1,8 +1,39 @@
 #pragma once
 #include <string>
 #include <memory>
+#include <cstddef>
+#include <vector>
 #include "Mesh.h"
 
+// OBJ import: v/vt/vn records, polygons (fan triangulated), usemtl/mtllib materials (Kd, map_Kd) and
+// smoothing groups. Every distinct v/vt/vn corner becomes one Mesh vertex; faces are grouped into one
+// submesh per material. Missing normals are generated: area-weighted within a smoothing group, or per
+// face after "s off". Files without "s" lines are smooth.
 namespace ObjLoader {
-    std::shared_ptr<Mesh> LoadObj(const std::string& path);
+    // Throughput of one load: the file is memory mapped and parsed in place, in chunks split at line
+    // boundaries and parsed in parallel on the JobSystem
+    struct LoadStats {
+        size_t bytes = 0;
+        size_t vertices = 0;   // unique vertices after deduplication
+        size_t faces = 0;      // triangles after fan triangulation
+        int chunks = 0;        // parallel parse chunks
+        double parseMs = 0.0;  // mapping and parsing, without import optimization
+        double MBPerSecond() const { return parseMs > 0.0 ? bytes / (1024.0 * 1024.0) / (parseMs / 1000.0) : 0.0; }
+        double VerticesPerSecond() const { return parseMs > 0.0 ? vertices / (parseMs / 1000.0) : 0.0; }
+    };
+
+    std::shared_ptr<Mesh> LoadObj(const std::string& path, LoadStats* stats = nullptr);
+
+    // Parse an OBJ held in memory; no bounds, edges or optimization. mtllib files are looked up in
+    // `directory` (with a trailing separator, or empty for the working directory).
+    std::shared_ptr<Mesh> ParseObj(const char* data, size_t size, const std::string& directory = std::string(),
+                                   LoadStats* stats = nullptr);
+
+    // Positions ("v") in file order and, when `indices` is given, the fan-triangulated position indices of
+    // the faces; no vertex splitting by vt/vn. For vertex-animation frames, which must keep the source
+    // vertex order. False on a malformed or out-of-range face index.
+    bool ParsePositions(const char* data, size_t size, std::vector<VECTOR>& positions, std::vector<int>* indices = nullptr);
+
+    // Parse `path` `runs` times and keep the fastest run, for measuring the parser on large files
+    LoadStats Benchmark(const std::string& path, int runs = 3);
 }
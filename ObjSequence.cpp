@@ -0,0 +1,363 @@
+#include "ObjSequence.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+// Each frame is one bitstream of blocks of kBlock values. A block starts with 6 header bits: the Rice
+// parameter k (5 bits) and kSecondOrder when the block is predicted from two frames (2 * q[f-1] - q[f-2])
+// rather than one (q[f-1]). Keyframes code the quantized values themselves. A value u is Rice coded as
+// u >> k zero bits, a one and the low k bits; quotients of kEscape or more are written as kEscape zero
+// bits followed by u in kRawBits bits.
+const size_t kBlock = 64;
+const uint32_t kSecondOrder = 0x20;
+const uint32_t kParamMask = 0x1F;
+const int kHeaderBits = 6;
+const uint32_t kEscape = 16;
+const int kRawBits = 20; // zigzag residuals of 16-bit values need 18
+
+uint32_t ZigZag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+int32_t UnZigZag(uint32_t u) { return (int32_t)(u >> 1) ^ -(int32_t)(u & 1); }
+
+inline int CountTrailingZeros(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward64(&i, v);
+    return (int)i;
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+size_t RiceBits(uint32_t u, int k) {
+    uint32_t q = u >> k;
+    return q < kEscape ? q + 1 + k : kEscape + kRawBits;
+}
+
+// Rice parameter with the fewest bits for a block
+int BestParameter(const uint32_t* values, size_t count, size_t& bits) {
+    int best = 0;
+    bits = SIZE_MAX;
+    for (int k = 0; k <= 18; ++k) {
+        size_t total = 0;
+        for (size_t i = 0; i < count; ++i) total += RiceBits(values[i], k);
+        if (total < bits) { bits = total; best = k; }
+    }
+    return best;
+}
+
+struct BitWriter {
+    std::vector<uint8_t>& out;
+    uint64_t acc = 0;
+    int bits = 0;
+    explicit BitWriter(std::vector<uint8_t>& o) : out(o) {}
+    void Put(uint32_t v, int w) { // w <= 32
+        acc |= (uint64_t)v << bits;
+        bits += w;
+        while (bits >= 8) { out.push_back((uint8_t)acc); acc >>= 8; bits -= 8; }
+    }
+    void PutRice(uint32_t u, int k) {
+        uint32_t q = u >> k;
+        if (q >= kEscape) { Put(0, kEscape); Put(u, kRawBits); return; }
+        Put(0, (int)q);
+        Put(1, 1);
+        if (k) Put(u & ((1u << k) - 1), k);
+    }
+    void Flush() { if (bits > 0) out.push_back((uint8_t)acc); acc = 0; bits = 0; }
+};
+
+// Reads up to 8 bytes past the end of a frame; data_ is padded for the last one
+struct BitReader {
+    const uint8_t* p;
+    uint64_t acc = 0;
+    int bits = 0;
+    explicit BitReader(const uint8_t* data) : p(data) {}
+    void Refill() { while (bits <= 56) { acc |= (uint64_t)*p++ << bits; bits += 8; } }
+    uint32_t Get(int w) { // w <= 32, after Refill
+        uint32_t v = (uint32_t)(acc & ((1ull << w) - 1));
+        acc >>= w;
+        bits -= w;
+        return v;
+    }
+    uint32_t GetRice(int k) {
+        Refill();
+        const int zeros = (acc & ((1ull << kEscape) - 1)) ? CountTrailingZeros(acc) : (int)kEscape;
+        if (zeros >= (int)kEscape) { Get(kEscape); Refill(); return Get(kRawBits); }
+        acc >>= zeros + 1;
+        bits -= zeros + 1;
+        return ((uint32_t)zeros << k) | (k ? Get(k) : 0);
+    }
+};
+
+} // namespace
+
+struct ObjSequence::Stream {
+    enum class State { Loading, Ready, Failed };
+    struct Slot {
+        int frame = -1;
+        State state = State::Ready;
+        std::vector<VECTOR> positions;
+    };
+
+    FrameReader reader;
+    int frameCount = 0;
+    int ahead = 0;
+    size_t vertexCount = 0;
+    std::mutex mutex;
+    int cursor = 0;
+    bool reading = false; // a reader task is queued or running
+    bool stopping = false;
+    std::vector<Slot> slots; // ahead + 1: always room for the whole window
+
+    // the frames from the cursor to `ahead` frames past it (wrapping, like playback)
+    bool InWindow(int frame) const { return (frame - cursor + frameCount) % frameCount <= ahead; }
+
+    Slot* Find(int frame) {
+        for (Slot& slot : slots)
+            if (slot.frame == frame) return &slot;
+        return nullptr;
+    }
+
+    // nearest frame of the window without a slot, -1 when the window is complete
+    int NextMissing() {
+        for (int d = 0; d <= ahead; ++d) {
+            const int frame = (cursor + d) % frameCount;
+            if (!Find(frame)) return frame;
+        }
+        return -1;
+    }
+
+    // Read the window until it is complete; mutex held on entry and exit. The slot being read is only
+    // touched by the reader, and a ready slot inside the window is never reused.
+    void ReadAhead(std::unique_lock<std::mutex>& lock) {
+        int frame;
+        while (!stopping && (frame = NextMissing()) >= 0) {
+            Slot* slot = nullptr;
+            for (Slot& s : slots)
+                if (s.frame < 0 || !InWindow(s.frame)) { slot = &s; break; }
+            slot->frame = frame;
+            slot->state = State::Loading;
+            lock.unlock();
+            const bool ok = reader(frame, slot->positions) && slot->positions.size() == vertexCount;
+            lock.lock();
+            slot->state = ok ? State::Ready : State::Failed;
+        }
+    }
+};
+
+ObjSequence::~ObjSequence() { StopStream(); }
+
+void ObjSequence::StopStream() {
+    if (!stream_) return;
+    std::shared_ptr<Stream> s = std::move(stream_);
+    std::lock_guard<std::mutex> lk(s->mutex);
+    s->stopping = true; // a running reader task finishes its frame and drops its reference
+}
+
+void ObjSequence::SetStream(int frameCount, std::vector<VECTOR> first, FrameReader reader, int ahead) {
+    StopStream();
+    data_.clear();
+    data_.shrink_to_fit();
+    frameOffsets_.clear();
+    current_.clear();
+    previous_.clear();
+    cursor_ = -1;
+    for (DecodedFrame& d : ring_) { d.frame = -1; d.positions.clear(); d.positions.shrink_to_fit(); }
+
+    auto s = std::make_shared<Stream>();
+    s->reader = std::move(reader);
+    s->frameCount = std::max(1, frameCount);
+    s->ahead = std::max(1, std::min(ahead, s->frameCount - 1));
+    if (s->frameCount == 1) s->ahead = 0;
+    s->vertexCount = first.size();
+    s->slots.resize(s->ahead + 1);
+    s->slots[0].frame = 0;
+    s->slots[0].positions = std::move(first);
+    for (Stream::Slot& slot : s->slots)
+        if (slot.frame < 0) slot.positions.reserve(s->vertexCount);
+
+    frameCount_ = s->frameCount;
+    vertexCount_ = s->vertexCount;
+    stream_ = s;
+    stats_ = Stats();
+    stats_.rawBytes = (size_t)frameCount_ * vertexCount_ * sizeof(VECTOR);
+    stats_.decodedBytes = s->slots.size() * vertexCount_ * sizeof(VECTOR);
+    SetCursor(0);
+}
+
+void ObjSequence::SetCursor(int frame) {
+    if (!stream_ || frame < 0 || frame >= frameCount_) return;
+    std::shared_ptr<Stream> s = stream_;
+    std::unique_lock<std::mutex> lock(s->mutex);
+    s->cursor = frame;
+    if (s->reading || s->NextMissing() < 0) return;
+    if (JobSystem::Instance().GetThreadCount() <= 1) {
+        s->ReadAhead(lock); // no workers: read on this thread
+        return;
+    }
+    s->reading = true;
+    JobSystem::Instance().Submit([s] {
+        std::unique_lock<std::mutex> lock(s->mutex);
+        s->ReadAhead(lock);
+        s->reading = false;
+    });
+}
+
+bool ObjSequence::IsPending(int frame) const {
+    if (!stream_ || frame < 0 || frame >= frameCount_) return false;
+    std::lock_guard<std::mutex> lk(stream_->mutex);
+    const Stream::Slot* slot = stream_->Find(frame);
+    return stream_->InWindow(frame) && (!slot || slot->state == Stream::State::Loading);
+}
+
+bool ObjSequence::SetFrames(const std::vector<std::vector<VECTOR>>& frames, const Settings& settings) {
+    const size_t n0 = frames.empty() ? 0 : frames[0].size();
+    for (const auto& f : frames)
+        if (f.size() != n0) return false;
+    StopStream();
+    vertexCount_ = n0;
+    settings_ = settings;
+    settings_.positionBits = std::max(1, std::min(16, settings_.positionBits));
+    settings_.keyframeInterval = std::max(1, settings_.keyframeInterval);
+    data_.clear();
+    frameOffsets_.clear();
+    cursor_ = -1;
+    for (DecodedFrame& d : ring_) { d.frame = -1; d.positions.clear(); d.positions.shrink_to_fit(); }
+    stats_ = Stats();
+    frameCount_ = (int)frames.size();
+    if (frames.empty()) return true;
+
+    // sequence bounds
+    const size_t n = vertexCount_;
+    float lo[3] = { INFINITY, INFINITY, INFINITY }, hi[3] = { -INFINITY, -INFINITY, -INFINITY };
+    for (const auto& f : frames)
+        for (const VECTOR& v : f) {
+            const float p[3] = { v.x, v.y, v.z };
+            for (int c = 0; c < 3; ++c) { lo[c] = std::min(lo[c], p[c]); hi[c] = std::max(hi[c], p[c]); }
+        }
+    const int32_t maxQ = (1 << settings_.positionBits) - 1;
+    float inv[3];
+    for (int c = 0; c < 3; ++c) {
+        if (n == 0) { lo[c] = hi[c] = 0.0f; }
+        const float extent = hi[c] - lo[c];
+        min_[c] = lo[c];
+        step_[c] = extent > 0.0f ? extent / maxQ : 0.0f;
+        inv[c] = extent > 0.0f ? maxQ / extent : 0.0f;
+    }
+
+    const size_t values = n * 3;
+    std::vector<int32_t> q(values), q1(values), q2(values); // frames f, f-1, f-2
+    std::vector<uint32_t> r1(kBlock), r2(kBlock);
+    frameOffsets_.reserve(frames.size());
+    for (size_t f = 0; f < frames.size(); ++f) {
+        for (size_t i = 0; i < n; ++i) {
+            const float p[3] = { frames[f][i].x, frames[f][i].y, frames[f][i].z };
+            for (int c = 0; c < 3; ++c) {
+                int32_t v = (int32_t)lrintf((p[c] - lo[c]) * inv[c]);
+                v = std::max(0, std::min(maxQ, v));
+                q[c * n + i] = v;
+                stats_.maxError = std::max(stats_.maxError, fabsf(min_[c] + v * step_[c] - p[c]));
+            }
+        }
+        frameOffsets_.push_back(data_.size());
+        const int phase = (int)(f % settings_.keyframeInterval);
+        BitWriter out(data_);
+        for (size_t b = 0; b < values; b += kBlock) {
+            const size_t count = std::min(kBlock, values - b);
+            for (size_t i = 0; i < count; ++i) {
+                const size_t k = b + i;
+                if (phase == 0) {
+                    r1[i] = (uint32_t)q[k];
+                } else {
+                    r1[i] = ZigZag(q[k] - q1[k]);
+                    if (phase >= 2) r2[i] = ZigZag(q[k] - (2 * q1[k] - q2[k]));
+                }
+            }
+            size_t bits1, bits2 = SIZE_MAX;
+            int k1 = BestParameter(r1.data(), count, bits1), k2 = 0;
+            if (phase >= 2) k2 = BestParameter(r2.data(), count, bits2);
+            const bool second = bits2 < bits1;
+            const uint32_t* r = second ? r2.data() : r1.data();
+            const int k = second ? k2 : k1;
+            out.Put((uint32_t)k | (second ? kSecondOrder : 0), kHeaderBits);
+            for (size_t i = 0; i < count; ++i) out.PutRice(r[i], k);
+        }
+        out.Flush();
+        std::swap(q2, q1);
+        std::swap(q1, q);
+    }
+    data_.resize(data_.size() + 8, 0); // BitReader overrun of the last frame
+    data_.shrink_to_fit();
+
+    current_.assign(values, 0);
+    previous_.assign(values, 0);
+    stats_.rawBytes = frames.size() * n * sizeof(VECTOR);
+    stats_.compressedBytes = data_.size() + frameOffsets_.size() * sizeof(size_t);
+    stats_.decodedBytes = kDecodedFrames * n * sizeof(VECTOR) + 2 * values * sizeof(int32_t);
+    return true;
+}
+
+void ObjSequence::DecodeStep(int frame) {
+    const bool key = frame % settings_.keyframeInterval == 0;
+    const size_t values = vertexCount_ * 3;
+    BitReader in(data_.data() + frameOffsets_[frame]);
+    int32_t* cur = current_.data();
+    int32_t* prev = previous_.data(); // receives the new frame (each value is read before it is replaced)
+    for (size_t b = 0; b < values; b += kBlock) {
+        const size_t end = std::min(b + kBlock, values);
+        in.Refill();
+        const uint32_t header = in.Get(kHeaderBits);
+        const int k = (int)(header & kParamMask);
+        if (key) {
+            for (size_t i = b; i < end; ++i) prev[i] = (int32_t)in.GetRice(k);
+        } else if (header & kSecondOrder) {
+            for (size_t i = b; i < end; ++i) prev[i] = 2 * cur[i] - prev[i] + UnZigZag(in.GetRice(k));
+        } else {
+            for (size_t i = b; i < end; ++i) prev[i] = cur[i] + UnZigZag(in.GetRice(k));
+        }
+    }
+    std::swap(current_, previous_);
+    cursor_ = frame;
+}
+
+void ObjSequence::Seek(int frame) {
+    const int key = frame - frame % settings_.keyframeInterval;
+    if (cursor_ < key || cursor_ > frame) DecodeStep(key);
+    while (cursor_ < frame) DecodeStep(cursor_ + 1);
+}
+
+const VECTOR* ObjSequence::GetFrame(int frame) {
+    if (frame < 0 || frame >= FrameCount()) return nullptr;
+    if (stream_) {
+        std::lock_guard<std::mutex> lk(stream_->mutex);
+        Stream::Slot* slot = stream_->Find(frame);
+        return slot && slot->state == Stream::State::Ready && stream_->InWindow(frame) ? slot->positions.data() : nullptr;
+    }
+    ++useClock_;
+    DecodedFrame* slot = &ring_[0];
+    for (DecodedFrame& d : ring_) {
+        if (d.frame == frame) { d.lastUse = useClock_; return d.positions.data(); }
+        if (d.lastUse < slot->lastUse) slot = &d;
+    }
+    Seek(frame);
+    const size_t n = vertexCount_;
+    slot->frame = frame;
+    slot->lastUse = useClock_;
+    slot->positions.resize(n);
+    const int32_t* qx = current_.data();
+    const int32_t* qy = qx + n;
+    const int32_t* qz = qy + n;
+    VECTOR* out = slot->positions.data();
+    for (size_t i = 0; i < n; ++i) {
+        out[i].x = min_[0] + qx[i] * step_[0];
+        out[i].y = min_[1] + qy[i] * step_[1];
+        out[i].z = min_[2] + qz[i] * step_[2];
+    }
+    return out;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <functional>
+#include <string>
+#include "VectorMath.h"
+
+// ObjSequence: the frames of a vertex-animated mesh (one position per vertex per frame, one shared index
+// list). Frames are stored compressed: positions are quantized to the sequence bounds, every frame but the
+// keyframes is predicted from the one or two before it, and the residuals are Rice coded in small blocks.
+// GetFrame decodes on demand into a ring of kDecodedFrames frames; playing forwards costs one frame step
+// per new frame, a seek at most keyframeInterval steps. Decoding isn't thread-safe: use a sequence from
+// one thread (renderers sharing it on the main thread are fine).
+// A streamed sequence (SetStream) keeps no frames resident: a reader task on the JobSystem reads the
+// frames from the playback cursor up to `ahead` frames past it into a ring of ahead + 1 frames, so
+// memory stays constant however long the sequence is and playback can start once frame 0 is read.
+struct ObjSequence {
+    struct Settings {
+        int positionBits = 12;     // per axis, 1..16; the error is at most half a step, bounds extent / (2^bits - 1) / 2
+        int keyframeInterval = 32; // frames between self-contained frames
+    };
+
+    struct Stats {
+        size_t rawBytes = 0;        // all frames as VECTORs
+        size_t compressedBytes = 0; // the encoded frames
+        size_t decodedBytes = 0;    // the decode ring and its predictor state
+        float maxError = 0.0f;      // largest position error of any axis, mesh units
+    };
+
+    static const int kDecodedFrames = 4;
+    static const int kDefaultStreamAhead = 4;
+
+    // Reads the positions of one frame (called on a worker thread); false if it can't
+    using FrameReader = std::function<bool(int frame, std::vector<VECTOR>& positions)>;
+
+    ObjSequence() = default;
+    ObjSequence(const ObjSequence&) = delete;
+    ObjSequence& operator=(const ObjSequence&) = delete;
+    ~ObjSequence();
+
+    std::vector<int> indices; // shared indices
+
+    // Compress `frames` (each VertexCount() positions long; frames of another length are rejected)
+    bool SetFrames(const std::vector<std::vector<VECTOR>>& frames, const Settings& settings);
+    bool SetFrames(const std::vector<std::vector<VECTOR>>& frames) { return SetFrames(frames, Settings()); }
+
+    // Stream `frameCount` frames through `reader`; `first` is frame 0, already read. Frames whose vertex
+    // count differs from it are dropped.
+    void SetStream(int frameCount, std::vector<VECTOR> first, FrameReader reader, int ahead = kDefaultStreamAhead);
+    bool IsStreamed() const { return stream_ != nullptr; }
+
+    int FrameCount() const { return frameCount_; }
+    size_t VertexCount() const { return vertexCount_; }
+
+    // Playback position (streamed sequences read ahead from here; no effect otherwise). Set it before
+    // requesting the frames of an update.
+    void SetCursor(int frame);
+
+    // Positions of frame `frame` (VertexCount() of them), or nullptr out of range. The pointer stays valid
+    // until kDecodedFrames other frames have been requested. Streamed: nullptr until the reader has the
+    // frame, which must be within `ahead` frames of the cursor; the pointer stays valid while it is.
+    const VECTOR* GetFrame(int frame);
+    // Streamed frame the reader hasn't produced yet (but will: it is within reach of the cursor)
+    bool IsPending(int frame) const;
+
+    const Stats& GetStats() const { return stats_; }
+
+private:
+    struct DecodedFrame {
+        int frame = -1;
+        unsigned int lastUse = 0;
+        std::vector<VECTOR> positions;
+    };
+
+    struct Stream; // reader state, shared with the reader task
+
+    void Seek(int frame);     // move the predictor state to `frame`
+    void DecodeStep(int frame); // decode `frame` from the state at frame - 1 (or from nothing at a keyframe)
+
+    void StopStream();
+
+    int frameCount_ = 0;
+    size_t vertexCount_ = 0;
+    Settings settings_;
+    float min_[3] = { 0.0f, 0.0f, 0.0f };
+    float step_[3] = { 0.0f, 0.0f, 0.0f };
+    std::vector<uint8_t> data_;          // encoded frames, back to back
+    std::vector<size_t> frameOffsets_;   // start of each frame in data_
+    // predictor state: quantized positions (x channel, then y, then z) of frames cursor_ and cursor_ - 1
+    int cursor_ = -1;
+    std::vector<int32_t> current_, previous_;
+    DecodedFrame ring_[kDecodedFrames];
+    unsigned int useClock_ = 0;
+    std::shared_ptr<Stream> stream_;
+    Stats stats_;
+};
@@ -1,118 +1,123 @@
 #include "ObjSequenceLoader.h"
-#include <Windows.h>
-#include <regex>
-#include <fstream>
-#include <sstream>
+#include "JobSystem.h"
+#include "MeshArtifact.h"
+#include "MappedFile.h"
+#include "ObjLoader.h"
+#include <filesystem>
 #include <iostream>
 #include <algorithm>
+#include <cctype>
+#include <climits>
 
+// Positions and triangulated position indices of one frame, parsed out of the mapped file (no exceptions:
+// frames are read on JobSystem workers)
 static bool LoadObjBasic(const std::string& path, std::vector<VECTOR>& outVerts, std::vector<int>& outIndices) {
-    std::ifstream ifs(path);
-    if (!ifs) return false;
-    std::vector<VECTOR> tempVerts;
-    std::string line;
-    while (std::getline(ifs, line)) {
-        if (line.size() < 2) continue;
-        if (line[0] == '#') continue;
-        std::istringstream iss(line);
-        std::string tag;
-        iss >> tag;
-        if (tag == "v") {
-            float x,y,z; iss >> x >> y >> z;
-            tempVerts.push_back(VGet(x,y,z));
-        } else if (tag == "f") {
-            std::vector<int> faceIdx;
-            std::string part;
-            while (iss >> part) {
-                int vi = 0;
-                if (part.find('/') != std::string::npos) {
-                    std::replace(part.begin(), part.end(), '/', ' ');
-                    std::istringstream ss(part);
-                    ss >> vi;
-                } else {
-                    vi = std::stoi(part);
-                }
-                if (vi < 0) vi = (int)tempVerts.size() + 1 + vi;
-                faceIdx.push_back(vi - 1);
-            }
-            if (faceIdx.size() == 3) {
-                outIndices.push_back(faceIdx[0]); outIndices.push_back(faceIdx[1]); outIndices.push_back(faceIdx[2]);
-            } else if (faceIdx.size() == 4) {
-                outIndices.push_back(faceIdx[0]); outIndices.push_back(faceIdx[1]); outIndices.push_back(faceIdx[2]);
-                outIndices.push_back(faceIdx[0]); outIndices.push_back(faceIdx[2]); outIndices.push_back(faceIdx[3]);
-            } else if (faceIdx.size() > 4) {
-                for (size_t i = 1; i + 1 < faceIdx.size(); ++i) {
-                    outIndices.push_back(faceIdx[0]); outIndices.push_back(faceIdx[i]); outIndices.push_back(faceIdx[i+1]);
-                }
-            }
-        }
-    }
-    outVerts = std::move(tempVerts);
-    return true;
+    MappedFile file(path);
+    return file.IsOpen() && ObjLoader::ParsePositions(file.Data(), file.Size(), outVerts, &outIndices);
 }
 
-std::shared_ptr<ObjSequence> ObjSequenceLoader::LoadSequence(const std::string& examplePath) {
-    // split directory and filename
-    std::string dir;
-    std::string filename;
-    size_t pos = examplePath.find_last_of("\\/");
-    if (pos == std::string::npos) {
-        dir = ".";
-        filename = examplePath;
-    } else {
-        dir = examplePath.substr(0, pos);
-        filename = examplePath.substr(pos + 1);
-    }
+// Positions only ("v" lines): the faces of a streamed frame are the first frame's
+static bool LoadObjPositions(const std::string& path, std::vector<VECTOR>& outVerts) {
+    MappedFile file(path);
+    return file.IsOpen() && ObjLoader::ParsePositions(file.Data(), file.Size(), outVerts);
+}
 
-    // regex to capture prefix, digits, suffix
-    std::smatch m;
-    std::regex r("(.*?)(\\d+)(\\.obj)$", std::regex::icase);
-    if (!std::regex_match(filename, m, r)) return nullptr;
-    std::string prefix = m[1].str();
-    std::string digits = m[2].str();
-    std::string suffix = m[3].str();
+// Split "<prefix><digits>.obj" (extension in any case); false for other names
+static bool MatchFrameName(const std::string& name, std::string& prefix, int& number, std::string& suffix) {
+    if (name.size() < 5) return false;
+    const size_t ext = name.size() - 4;
+    if (name[ext] != '.') return false;
+    for (size_t i = 1; i < 4; ++i)
+        if (tolower((unsigned char)name[ext + i]) != "obj"[i - 1]) return false;
+    size_t first = ext;
+    while (first > 0 && name[first - 1] >= '0' && name[first - 1] <= '9') --first;
+    if (first == ext) return false;
+    long long value = 0;
+    for (size_t i = first; i < ext; ++i) value = std::min(value * 10 + (name[i] - '0'), (long long)INT_MAX);
+    prefix.assign(name, 0, first);
+    number = (int)value;
+    suffix.assign(name, ext, 4);
+    return true;
+}
 
-    // enumerate files in dir using Win32 API
-    std::string search = dir + "\\*";
-    WIN32_FIND_DATAA fd;
-    HANDLE hFind = FindFirstFileA(search.c_str(), &fd);
-    if (hFind == INVALID_HANDLE_VALUE) return nullptr;
+// The files of the numbered sequence `examplePath` belongs to, in frame order
+static bool FindSequenceFiles(const std::string& examplePath, std::vector<std::string>& outFiles) {
+    namespace fs = std::filesystem;
+    const fs::path example(examplePath);
+    const fs::path dir = example.has_parent_path() ? example.parent_path() : fs::path(".");
+
+    std::string prefix, suffix;
+    int number;
+    if (!MatchFrameName(example.filename().string(), prefix, number, suffix)) return false;
 
     std::vector<std::pair<int, std::string>> found;
-    do {
-        if ((fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0) continue;
-        std::string fn = fd.cFileName;
-        std::smatch mm;
-        if (std::regex_match(fn, mm, r)) {
-            if (mm[1].str() == prefix && mm[3].str() == suffix) {
-                int idx = std::stoi(mm[2].str());
-                std::string full = dir + "\\" + fn;
-                found.push_back({idx, full});
-            }
-        }
-    } while (FindNextFileA(hFind, &fd) != 0);
-    FindClose(hFind);
+    std::error_code ec;
+    for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file(ec)) continue;
+        std::string p, s;
+        int idx;
+        if (MatchFrameName(it->path().filename().string(), p, idx, s) && p == prefix && s == suffix)
+            found.push_back({idx, it->path().string()});
+    }
 
-    if (found.empty()) return nullptr;
+    if (found.empty()) return false;
     std::sort(found.begin(), found.end(), [](auto &a, auto &b){ return a.first < b.first; });
+    outFiles.clear();
+    for (auto &f : found) outFiles.push_back(f.second);
+    return true;
+}
 
-    auto seq = std::make_shared<ObjSequence>();
-    seq->frames.reserve(found.size());
+std::shared_ptr<ObjSequence> ObjSequenceLoader::LoadSequence(const std::string& examplePath, const ObjSequence::Settings& settings) {
+    std::vector<std::string> files;
+    if (!FindSequenceFiles(examplePath, files)) return nullptr;
+
+    // frames are parsed in parallel into their own slots; only frame 0 keeps its indices, the others
+    // are checked against it by a hash of their index stream
+    std::vector<std::vector<VECTOR>> frames(files.size());
     std::vector<int> indices;
-    bool indicesSet = false;
-    for (auto &f : found) {
-        std::vector<VECTOR> verts;
-        std::vector<int> idxs;
-        if (!LoadObjBasic(f.second, verts, idxs)) return nullptr;
-        if (!indicesSet) { indices = idxs; indicesSet = true; }
-        else {
-            if (idxs != indices) {
-                std::cerr << "ObjSequenceLoader: index mismatch in " << f.second << "\n";
-                return nullptr;
-            }
+    std::vector<uint64_t> topology(files.size());
+    std::vector<char> loaded(files.size(), 0);
+    JobSystem::Instance().ParallelFor(files.size(), 1, [&](size_t begin, size_t end, int) {
+        for (size_t i = begin; i < end; ++i) {
+            std::vector<int> idxs;
+            if (!LoadObjBasic(files[i], frames[i], idxs)) continue;
+            topology[i] = MeshArtifact::HashContent((const char*)idxs.data(), idxs.size() * sizeof(int));
+            if (i == 0) indices = std::move(idxs);
+            loaded[i] = 1;
+        }
+    });
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (!loaded[i]) return nullptr;
+        if (topology[i] != topology[0]) {
+            std::cerr << "ObjSequenceLoader: index mismatch in " << files[i] << "\n";
+            return nullptr;
         }
-        seq->frames.push_back(std::move(verts));
     }
+
+    auto seq = std::make_shared<ObjSequence>();
+    if (!seq->SetFrames(frames, settings)) {
+        std::cerr << "ObjSequenceLoader: vertex count mismatch in " << examplePath << "\n";
+        return nullptr;
+    }
+    seq->indices = std::move(indices);
+    return seq;
+}
+
+std::shared_ptr<ObjSequence> ObjSequenceLoader::OpenSequence(const std::string& examplePath, int ahead) {
+    std::vector<std::string> files;
+    if (!FindSequenceFiles(examplePath, files)) return nullptr;
+
+    // topology and frame 0 now, the other frames as playback reaches them
+    std::vector<VECTOR> first;
+    std::vector<int> indices;
+    if (!LoadObjBasic(files[0], first, indices)) return nullptr;
+    auto seq = std::make_shared<ObjSequence>();
     seq->indices = std::move(indices);
+    const size_t vertexCount = first.size();
+    seq->SetStream((int)files.size(), std::move(first), [files, vertexCount](int frame, std::vector<VECTOR>& positions) {
+        if (LoadObjPositions(files[frame], positions) && positions.size() == vertexCount) return true;
+        std::cerr << "ObjSequenceLoader: can't stream " << files[frame] << "\n";
+        return false;
+    }, ahead);
     return seq;
 }
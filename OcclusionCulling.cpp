@@ -0,0 +1,243 @@
+#include "OcclusionCulling.h"
+#include "Mesh.h"
+#include "MeshPacking.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCCLUSION_SSE 1
+#endif
+
+namespace {
+    const int kBandRows = 16;
+
+    int64_t NowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+void OcclusionCulling::Initialize(int width, int height) {
+    width = std::max(4, (width + 3) & ~3);
+    height = std::max(1, height);
+    if (width == width_ && height == height_) return;
+    width_ = width;
+    height_ = height;
+    levels_.clear();
+    levelW_.clear();
+    levelH_.clear();
+    int w = width_, h = height_;
+    while (true) {
+        levels_.emplace_back((size_t)w * h, 1.0f);
+        levelW_.push_back(w);
+        levelH_.push_back(h);
+        if (w == 1 && h == 1) break;
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+    }
+    built_ = false;
+}
+
+void OcclusionCulling::BeginFrame(const float viewProj[4][4]) {
+    if (width_ == 0) Initialize();
+    for (int r = 0; r < 4; ++r)
+        for (int c = 0; c < 4; ++c) viewProj_[r][c] = viewProj[r][c];
+    occluders_.clear();
+    tris_.clear();
+    built_ = false;
+    stats_ = Stats();
+}
+
+void OcclusionCulling::AddOccluder(const Mesh& mesh, const float model[3][4]) {
+    Occluder o;
+    o.mesh = &mesh;
+    for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 4; ++c) o.model[r][c] = model[r][c];
+    o.firstTriangle = tris_.size();
+    tris_.resize(tris_.size() + mesh.TriangleCount());
+    occluders_.push_back(o);
+}
+
+void OcclusionCulling::BuildHiZ() {
+    int64_t start = NowNs();
+    JobSystem& jobs = JobSystem::Instance();
+    const float (*m)[4] = viewProj_;
+    const float W = (float)width_, H = (float)height_;
+
+    // triangle setup, one occluder per job item
+    jobs.ParallelFor(occluders_.size(), 1, [&](size_t begin, size_t end, int) {
+        for (size_t oi = begin; oi < end; ++oi) {
+            const Occluder& o = occluders_[oi];
+            const Mesh& mesh = *o.mesh;
+            // packed meshes (MeshPacking) are decoded into this thread's scratch arena
+            ScratchArena& arena = ScratchArena::ForThread();
+            ScratchArena::Scope scope(arena);
+            const VECTOR* vertices = MeshPacking::GetPositions(mesh, arena);
+            const int* indices = MeshPacking::GetIndices(mesh, arena);
+            const size_t vcount = mesh.VertexCount();
+            const size_t faces = mesh.TriangleCount();
+            for (size_t t = 0; t < faces; ++t) {
+                Tri& tri = tris_[o.firstTriangle + t];
+                tri.valid = false;
+                float z[3];
+                bool ok = true;
+                for (int k = 0; k < 3 && ok; ++k) {
+                    int idx = indices[t * 3 + k];
+                    if (idx < 0 || (size_t)idx >= vcount) { ok = false; break; }
+                    const VECTOR& v = vertices[idx];
+                    float px = o.model[0][0] * v.x + o.model[0][1] * v.y + o.model[0][2] * v.z + o.model[0][3];
+                    float py = o.model[1][0] * v.x + o.model[1][1] * v.y + o.model[1][2] * v.z + o.model[1][3];
+                    float pz = o.model[2][0] * v.x + o.model[2][1] * v.y + o.model[2][2] * v.z + o.model[2][3];
+                    float cx = m[0][0] * px + m[0][1] * py + m[0][2] * pz + m[0][3];
+                    float cy = m[1][0] * px + m[1][1] * py + m[1][2] * pz + m[1][3];
+                    float cz = m[2][0] * px + m[2][1] * py + m[2][2] * pz + m[2][3];
+                    float cw = m[3][0] * px + m[3][1] * py + m[3][2] * pz + m[3][3];
+                    // triangles crossing the near plane are dropped (fewer occluders is always safe)
+                    if (cz < 0.0f || cw <= 0.0f) { ok = false; break; }
+                    float iw = 1.0f / cw;
+                    tri.x[k] = (cx * iw * 0.5f + 0.5f) * W;
+                    tri.y[k] = (0.5f - cy * iw * 0.5f) * H;
+                    z[k] = cz * iw;
+                }
+                if (!ok) continue;
+                float area = (tri.x[1] - tri.x[0]) * (tri.y[2] - tri.y[0]) - (tri.x[2] - tri.x[0]) * (tri.y[1] - tri.y[0]);
+                if (area == 0.0f || !std::isfinite(area)) continue;
+                if (area < 0.0f) {
+                    std::swap(tri.x[1], tri.x[2]); std::swap(tri.y[1], tri.y[2]); std::swap(z[1], z[2]);
+                    area = -area;
+                }
+                float dz1 = z[1] - z[0], dz2 = z[2] - z[0];
+                tri.zA = (dz1 * (tri.y[2] - tri.y[0]) - dz2 * (tri.y[1] - tri.y[0])) / area;
+                tri.zB = (dz2 * (tri.x[1] - tri.x[0]) - dz1 * (tri.x[2] - tri.x[0])) / area;
+                tri.zC = z[0] - tri.zA * tri.x[0] - tri.zB * tri.y[0];
+                float minX = std::min(tri.x[0], std::min(tri.x[1], tri.x[2]));
+                float maxX = std::max(tri.x[0], std::max(tri.x[1], tri.x[2]));
+                float minY = std::min(tri.y[0], std::min(tri.y[1], tri.y[2]));
+                float maxY = std::max(tri.y[0], std::max(tri.y[1], tri.y[2]));
+                tri.minX = std::max(0, (int)ceilf(minX - 0.5f));
+                tri.minY = std::max(0, (int)ceilf(minY - 0.5f));
+                tri.maxX = std::min(width_ - 1, (int)floorf(maxX - 0.5f));
+                tri.maxY = std::min(height_ - 1, (int)floorf(maxY - 0.5f));
+                tri.valid = tri.minX <= tri.maxX && tri.minY <= tri.maxY;
+            }
+        }
+    });
+    for (const Tri& t : tris_) if (t.valid) stats_.occluderTriangles++;
+    stats_.occluders = (int)occluders_.size();
+
+    std::fill(levels_[0].begin(), levels_[0].end(), 1.0f);
+    const int bands = (height_ + kBandRows - 1) / kBandRows;
+    jobs.ParallelFor(bands, 1, [&](size_t begin, size_t end, int) {
+        for (size_t b = begin; b < end; ++b)
+            RasterBand((int)b * kBandRows, std::min(height_, (int)(b + 1) * kBandRows));
+    });
+    int64_t mid = NowNs();
+    stats_.rasterMs = (mid - start) / 1.0e6;
+
+    // each coarser texel keeps the farthest depth of the 2x2 block below it
+    for (size_t l = 1; l < levels_.size(); ++l) {
+        const std::vector<float>& src = levels_[l - 1];
+        std::vector<float>& dst = levels_[l];
+        int sw = levelW_[l - 1], sh = levelH_[l - 1];
+        int dw = levelW_[l], dh = levelH_[l];
+        for (int y = 0; y < dh; ++y) {
+            int y0 = y * 2, y1 = std::min(y * 2 + 1, sh - 1);
+            for (int x = 0; x < dw; ++x) {
+                int x0 = x * 2, x1 = std::min(x * 2 + 1, sw - 1);
+                float a = std::max(src[(size_t)y0 * sw + x0], src[(size_t)y0 * sw + x1]);
+                float b = std::max(src[(size_t)y1 * sw + x0], src[(size_t)y1 * sw + x1]);
+                dst[(size_t)y * dw + x] = std::max(a, b);
+            }
+        }
+    }
+    stats_.hizMs = (NowNs() - mid) / 1.0e6;
+    built_ = true;
+}
+
+void OcclusionCulling::RasterBand(int y0, int y1) {
+    float* depth = levels_[0].data();
+    for (const Tri& t : tris_) {
+        if (!t.valid || t.maxY < y0 || t.minY >= y1) continue;
+        // edge i is opposite vertex i; E(p) = (b - a) x (p - a) >= 0 inside
+        float ex[3], ey[3], ax[3], ay[3];
+        for (int i = 0; i < 3; ++i) {
+            int a = (i + 1) % 3, b = (i + 2) % 3;
+            ax[i] = t.x[a]; ay[i] = t.y[a];
+            ex[i] = t.x[b] - t.x[a];
+            ey[i] = t.y[b] - t.y[a];
+        }
+        int ry0 = std::max(t.minY, y0), ry1 = std::min(t.maxY, y1 - 1);
+        int xs = t.minX & ~3; // width_ is a multiple of 4, so whole groups stay inside the row
+        for (int y = ry0; y <= ry1; ++y) {
+            float py = y + 0.5f;
+            // E_i(px) = c_i - ey_i * px along the row
+            float c[3];
+            for (int i = 0; i < 3; ++i) c[i] = ex[i] * (py - ay[i]) + ey[i] * ax[i];
+            float zRow = t.zB * py + t.zC;
+            float* row = depth + (size_t)y * width_;
+#if defined(OCCLUSION_SSE)
+            const __m128 c0 = _mm_set1_ps(c[0]), c1 = _mm_set1_ps(c[1]), c2 = _mm_set1_ps(c[2]);
+            const __m128 ey0 = _mm_set1_ps(ey[0]), ey1 = _mm_set1_ps(ey[1]), ey2 = _mm_set1_ps(ey[2]);
+            const __m128 za = _mm_set1_ps(t.zA), zr = _mm_set1_ps(zRow), zero = _mm_setzero_ps();
+            __m128 px = _mm_add_ps(_mm_set1_ps((float)xs), _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f));
+            const __m128 four = _mm_set1_ps(4.0f);
+            for (int x = xs; x <= t.maxX; x += 4, px = _mm_add_ps(px, four)) {
+                __m128 in = _mm_cmpge_ps(_mm_sub_ps(c0, _mm_mul_ps(ey0, px)), zero);
+                in = _mm_and_ps(in, _mm_cmpge_ps(_mm_sub_ps(c1, _mm_mul_ps(ey1, px)), zero));
+                in = _mm_and_ps(in, _mm_cmpge_ps(_mm_sub_ps(c2, _mm_mul_ps(ey2, px)), zero));
+                if (_mm_movemask_ps(in) == 0) continue;
+                __m128 z = _mm_max_ps(_mm_add_ps(_mm_mul_ps(za, px), zr), zero);
+                __m128 cur = _mm_loadu_ps(row + x);
+                __m128 nearer = _mm_min_ps(cur, z);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(in, nearer), _mm_andnot_ps(in, cur)));
+            }
+#else
+            for (int x = xs; x <= t.maxX; ++x) {
+                float px = x + 0.5f;
+                if (c[0] - ey[0] * px < 0.0f || c[1] - ey[1] * px < 0.0f || c[2] - ey[2] * px < 0.0f) continue;
+                float z = std::max(0.0f, t.zA * px + zRow);
+                if (z < row[x]) row[x] = z;
+            }
+#endif
+        }
+    }
+}
+
+bool OcclusionCulling::IsVisible(const Bounds3& b) const {
+    if (!built_ || stats_.occluderTriangles == 0) return true;
+    const float (*m)[4] = viewProj_;
+    float minX = INFINITY, minY = INFINITY, maxX = -INFINITY, maxY = -INFINITY, minZ = INFINITY;
+    for (int k = 0; k < 8; ++k) {
+        float px = (k & 1) ? b.maxX : b.minX;
+        float py = (k & 2) ? b.maxY : b.minY;
+        float pz = (k & 4) ? b.maxZ : b.minZ;
+        float cx = m[0][0] * px + m[0][1] * py + m[0][2] * pz + m[0][3];
+        float cy = m[1][0] * px + m[1][1] * py + m[1][2] * pz + m[1][3];
+        float cz = m[2][0] * px + m[2][1] * py + m[2][2] * pz + m[2][3];
+        float cw = m[3][0] * px + m[3][1] * py + m[3][2] * pz + m[3][3];
+        if (cz < 0.0f || cw <= 0.0f) return true; // reaches in front of the near plane
+        float iw = 1.0f / cw;
+        float sx = (cx * iw * 0.5f + 0.5f) * width_;
+        float sy = (0.5f - cy * iw * 0.5f) * height_;
+        minX = std::min(minX, sx); maxX = std::max(maxX, sx);
+        minY = std::min(minY, sy); maxY = std::max(maxY, sy);
+        minZ = std::min(minZ, cz * iw);
+    }
+    if (!(maxX >= 0.0f && maxY >= 0.0f && minX < (float)width_ && minY < (float)height_)) return true;
+    int x0 = std::max(0, (int)floorf(minX)), x1 = std::min(width_ - 1, (int)floorf(maxX));
+    int y0 = std::max(0, (int)floorf(minY)), y1 = std::min(height_ - 1, (int)floorf(maxY));
+
+    // coarsest level where the rectangle spans at most 4x4 texels
+    int level = 0;
+    while (level + 1 < (int)levels_.size() && ((x1 >> level) - (x0 >> level) > 3 || (y1 >> level) - (y0 >> level) > 3)) ++level;
+    const std::vector<float>& hiz = levels_[level];
+    const int lw = levelW_[level];
+    float farthest = 0.0f;
+    for (int y = y0 >> level; y <= y1 >> level; ++y)
+        for (int x = x0 >> level; x <= x1 >> level; ++x)
+            farthest = std::max(farthest, hiz[(size_t)y * lw + x]);
+    return minZ <= farthest;
+}
@@ -1,12 +1,69 @@
 #pragma once
+#include <vector>
+#include <cstddef>
+#include "AABBTree.h"
 
-// OcclusionCulling stub: Hi-Z generation and test
+struct Mesh;
+
+// OcclusionCulling: CPU Hi-Z. A few large occluder meshes are rasterized into a low-resolution
+// depth buffer (nearest depth per texel, SSE 4-wide, horizontal bands in parallel), then a mip
+// chain keeps the farthest depth of each 2x2 block. An object is hidden when the nearest depth
+// of its box is behind every texel its screen rectangle covers.
+// Depth is post-projection z / w in [0, 1], using the matrix from FrustumCulling::BuildViewProjection.
 class OcclusionCulling {
 public:
+    struct Stats {
+        int occluders = 0;
+        size_t occluderTriangles = 0; // triangles rasterized (after near-plane rejection)
+        double rasterMs = 0.0;
+        double hizMs = 0.0;
+    };
+
     OcclusionCulling() {}
     ~OcclusionCulling() {}
 
-    void Initialize() {}
-    void BuildHiZ() {}
-    bool IsVisible(int objectId) { return true; }
+    // Depth buffer resolution (width rounds up to a multiple of 4); cheap when the size is unchanged
+    void Initialize(int width = 256, int height = 128);
+    // Start a frame: drops the previous occluders and Hi-Z
+    void BeginFrame(const float viewProj[4][4]);
+    // Queue a mesh drawn through a Transform::GetMatrix3D matrix
+    void AddOccluder(const Mesh& mesh, const float model[3][4]);
+    // Rasterize the queued occluders and build the mip chain
+    void BuildHiZ();
+    // Conservative: false only when the box is certainly hidden behind the occluders.
+    // Thread-safe after BuildHiZ.
+    bool IsVisible(const Bounds3& worldBounds) const;
+
+    int GetWidth() const { return width_; }
+    int GetHeight() const { return height_; }
+    int GetLevelCount() const { return (int)levels_.size(); }
+    // Level 0 is the rasterized depth buffer; rows are GetLevelWidth(level) texels apart
+    const std::vector<float>& GetLevel(int level) const { return levels_[level]; }
+    int GetLevelWidth(int level) const { return levelW_[level]; }
+    int GetLevelHeight(int level) const { return levelH_[level]; }
+    const Stats& GetStats() const { return stats_; }
+
+private:
+    struct Occluder {
+        const Mesh* mesh;
+        float model[3][4];
+        size_t firstTriangle; // into tris_
+    };
+    struct Tri {
+        float x[3], y[3];
+        float zA, zB, zC;         // depth plane: z = zA * x + zB * y + zC
+        int minX, minY, maxX, maxY;
+        bool valid;
+    };
+
+    void RasterBand(int y0, int y1);
+
+    int width_ = 0, height_ = 0;
+    float viewProj_[4][4] = {};
+    std::vector<Occluder> occluders_;
+    std::vector<Tri> tris_;
+    std::vector<std::vector<float>> levels_; // levels_[0] is the rasterized depth buffer
+    std::vector<int> levelW_, levelH_;
+    bool built_ = false;
+    Stats stats_;
 };
@@ -0,0 +1,160 @@
+#include "RenderBackend.h"
+#include "VectorMath.h"
+#include "VertexTransform.h"
+#include "ScratchArena.h"
+#include <vector>
+#include <algorithm>
+#if !ENGINE_DXLIB
+#include "SoftwareRasterizer.h"
+#endif
+
+namespace {
+    RenderBackend* current = nullptr;
+
+#if ENGINE_DXLIB
+    int ToDxColor(unsigned int c) {
+        return GetColor((c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF);
+    }
+#endif
+}
+
+RenderBackend& RenderBackend::Current() {
+    if (current) return *current;
+#if ENGINE_DXLIB
+    return DxLibRenderBackend::Instance();
+#else
+    // headless builds have no DxLib: draw into the software rasterizer
+    static SoftwareRasterizer software;
+    return software;
+#endif
+}
+
+void RenderBackend::SetCurrent(RenderBackend* backend) {
+    current = backend;
+}
+
+void RenderBackend::DrawInstances3D(const InstanceGeometry& geometry, const InstanceData* instances, size_t count, const InstanceLight& light) {
+    const size_t perInstance = VertexTransform::ExpandedVertexCount(geometry);
+    if (count == 0 || perInstance == 0) return;
+    ScratchArena& arena = ScratchArena::ForThread();
+    ScratchArena::Scope scope(arena);
+    RenderVertex* out = arena.Allocate<RenderVertex>(perInstance * count);
+    VertexTransform::ExpandInstances(geometry, instances, count, light, out);
+    if (geometry.wireframe) DrawLines3D(out, perInstance * count);
+    else DrawTriangles3D(out, perInstance * count, false);
+}
+
+#if ENGINE_DXLIB
+DxLibRenderBackend& DxLibRenderBackend::Instance() {
+    static DxLibRenderBackend inst;
+    return inst;
+}
+
+int DxLibRenderBackend::BeginTarget(int width, int height) {
+    int screen = MakeScreen(width, height, TRUE);
+    if (screen == -1) return 0;
+    prevScreen_ = GetDrawScreen();
+    SetDrawScreen(screen);
+    ClearDrawScreen();
+    // depth-test 3D draws like the software backend, so the scene's draw order is free to follow state
+    SetUseZBuffer3D(TRUE);
+    SetWriteZBuffer3D(TRUE);
+    SetBlendAlpha(255);
+    return screen;
+}
+
+void DxLibRenderBackend::EndTarget() {
+    SetBlendAlpha(255);
+    SetUseZBuffer3D(FALSE);
+    SetWriteZBuffer3D(FALSE);
+    SetDrawScreen(prevScreen_);
+}
+
+void DxLibRenderBackend::SetCamera(float eyeX, float eyeY, float eyeZ, float targetX, float targetY, float targetZ, float fovY) {
+    SetupCamera_Perspective(fovY);
+    SetCameraPositionAndTarget_UpVecY(VGet(eyeX, eyeY, eyeZ), VGet(targetX, targetY, targetZ));
+}
+
+void DxLibRenderBackend::DrawLine3D(const float a[3], const float b[3], unsigned int color) {
+    ::DrawLine3D(VGet(a[0], a[1], a[2]), VGet(b[0], b[1], b[2]), ToDxColor(color));
+}
+
+void DxLibRenderBackend::DrawTriangles3D(const RenderVertex* vertices, size_t count, bool wireframe) {
+    count -= count % 3;
+    if (wireframe) {
+        for (size_t i = 0; i < count; i += 3) {
+            const RenderVertex& v0 = vertices[i];
+            const RenderVertex& v1 = vertices[i + 1];
+            const RenderVertex& v2 = vertices[i + 2];
+            int c = ToDxColor(v0.color);
+            ::DrawLine3D(VGet(v0.x, v0.y, v0.z), VGet(v1.x, v1.y, v1.z), c);
+            ::DrawLine3D(VGet(v1.x, v1.y, v1.z), VGet(v2.x, v2.y, v2.z), c);
+            ::DrawLine3D(VGet(v2.x, v2.y, v2.z), VGet(v0.x, v0.y, v0.z), c);
+        }
+        return;
+    }
+    if (count == 0) return;
+    // colours are already lit by the caller
+    std::vector<VERTEX3D> verts(count);
+    for (size_t i = 0; i < count; ++i) {
+        const RenderVertex& s = vertices[i];
+        VERTEX3D& d = verts[i];
+        d.pos = VGet(s.x, s.y, s.z);
+        d.norm = VGet(0.0f, 1.0f, 0.0f);
+        d.dif = GetColorU8((s.color >> 16) & 0xFF, (s.color >> 8) & 0xFF, s.color & 0xFF, 255);
+        d.spc = GetColorU8(0, 0, 0, 0);
+        d.u = d.v = d.su = d.sv = 0.0f;
+    }
+    SetUseLighting(FALSE);
+    DrawPolygon3D(verts.data(), (int)(count / 3), DX_NONE_GRAPH, FALSE);
+    SetUseLighting(TRUE);
+}
+
+void DxLibRenderBackend::DrawLines3D(const RenderVertex* vertices, size_t count) {
+    count -= count % 2;
+    if (count == 0) return;
+    std::vector<VERTEX3D> verts(std::min(count, kLineBatch * 2));
+    SetUseLighting(FALSE);
+    for (size_t first = 0; first < count; first += kLineBatch * 2) {
+        size_t n = std::min(count - first, kLineBatch * 2);
+        for (size_t i = 0; i < n; ++i) {
+            const RenderVertex& s = vertices[first + i];
+            unsigned int c = vertices[first + (i & ~(size_t)1)].color;
+            VERTEX3D& d = verts[i];
+            d.pos = VGet(s.x, s.y, s.z);
+            d.norm = VGet(0.0f, 1.0f, 0.0f);
+            d.dif = GetColorU8((c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF, 255);
+            d.spc = GetColorU8(0, 0, 0, 0);
+            d.u = d.v = d.su = d.sv = 0.0f;
+        }
+        DrawPrimitive3D(verts.data(), (int)n, DX_PRIMTYPE_LINELIST, DX_NONE_GRAPH, FALSE);
+    }
+    SetUseLighting(TRUE);
+}
+
+void DxLibRenderBackend::SetBlendAlpha(int alpha) {
+    alpha = std::min(255, std::max(0, alpha));
+    SetDrawBlendMode(alpha < 255 ? DX_BLENDMODE_ALPHA : DX_BLENDMODE_NOBLEND, alpha);
+    SetWriteZBuffer3D(alpha < 255 ? FALSE : TRUE);
+}
+
+void DxLibRenderBackend::DrawBox(int x0, int y0, int x1, int y1, unsigned int color, bool fill) {
+    ::DrawBox(x0, y0, x1, y1, ToDxColor(color), fill ? TRUE : FALSE);
+}
+
+void DxLibRenderBackend::DrawCircle(int x, int y, int r, unsigned int color, bool fill) {
+    ::DrawCircle(x, y, r, ToDxColor(color), fill ? TRUE : FALSE);
+}
+
+int DxLibRenderBackend::LoadTexture(const std::string& path) {
+    return LoadGraph(path.c_str());
+}
+
+void DxLibRenderBackend::DeleteTexture(int handle) {
+    if (handle != -1) DeleteGraph(handle);
+}
+
+void DxLibRenderBackend::DrawTexture(int x, int y, int handle) {
+    DrawGraph(x, y, handle, TRUE);
+}
+#endif
@@ -0,0 +1,122 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <memory>
+
+// Colours passed to a RenderBackend are packed 0xRRGGBB (the layout GetColor returns for 32-bit screens).
+struct RenderVertex {
+    float x, y, z;
+    unsigned int color;
+};
+
+// Geometry shared by every instance of a DrawInstances3D call (a mesh in its local space)
+struct InstanceGeometry {
+    const float* positions = nullptr; // xyz per vertex
+    const float* normals = nullptr;   // xyz per vertex, or nullptr for flat shading
+    size_t vertexCount = 0;
+    const int* indices = nullptr;     // triangle list
+    size_t indexCount = 0;
+    const int* edges = nullptr;       // 4 ints per unique edge: v0, v1, face0, face1 (-1 on open borders)
+    size_t edgeCount = 0;
+    bool wireframe = false;           // draw the edges instead of the triangles
+    // quantized streams (Mesh::Packed); each one, when set, is read instead of its counterpart above
+    const uint16_t* quantizedPositions = nullptr; // unorm16 xyz; position = positionOffset + q * positionScale
+    float positionOffset[3] = { 0.0f, 0.0f, 0.0f };
+    float positionScale[3] = { 1.0f, 1.0f, 1.0f };
+    const uint32_t* octNormals = nullptr;         // octahedral, snorm16 x | y << 16
+    const uint16_t* indices16 = nullptr;
+    const uint16_t* edges16 = nullptr;            // like edges; face1 is 0xFFFF on open borders
+    const uint32_t* edgeVertices = nullptr;       // v0, v1 per edge; only with normals (no face lighting)
+};
+
+// One entry of the per-instance stream (96 bytes)
+struct InstanceData {
+    float model[3][4];  // local to world, Transform::GetMatrix3D
+    float normal[3][3]; // for normals, VertexTransform::NormalMatrix
+    unsigned int color; // base colour, lit per vertex by the backend
+    unsigned int pad[2];
+};
+
+// Directional light applied by DrawInstances3D (direction the light travels, as Lighting stores it)
+struct InstanceLight {
+    float dirX, dirY, dirZ;
+    float intensity;
+    unsigned int color;
+};
+
+// RenderBackend: the drawing calls components and the scene use, so a frame can go to DxLib or to the
+// headless SoftwareRasterizer. Only one backend is current at a time; DxLib is the default.
+class RenderBackend {
+public:
+    // Near/far clip distances of the 3D camera (DxLib's defaults)
+    static constexpr float kNearZ = 10.0f;
+    static constexpr float kFarZ = 10000.0f;
+
+    virtual ~RenderBackend() {}
+
+    // Start drawing into a width x height offscreen target (cleared). Returns its handle, or 0 on failure.
+    virtual int BeginTarget(int width, int height) = 0;
+    // Finish the target started by BeginTarget and restore the previous draw screen
+    virtual void EndTarget() = 0;
+
+    // Perspective camera (left-handed, Y up), vertical fov in radians
+    virtual void SetCamera(float eyeX, float eyeY, float eyeZ, float targetX, float targetY, float targetZ, float fovY) = 0;
+
+    virtual void DrawLine3D(const float a[3], const float b[3], unsigned int color) = 0;
+    // Triangle list (3 vertices per triangle) with per-vertex colour.
+    // wireframe draws each triangle's edges in the colour of its first vertex.
+    virtual void DrawTriangles3D(const RenderVertex* vertices, size_t count, bool wireframe) = 0;
+    // Line list (2 vertices per line), each line in the colour of its first vertex
+    virtual void DrawLines3D(const RenderVertex* vertices, size_t count) = 0;
+    // Instances of one mesh with their own transform and colour, lit by `light`. The default transforms and
+    // lights every instance on the CPU and submits the result as one DrawTriangles3D / DrawLines3D call.
+    virtual void DrawInstances3D(const InstanceGeometry& geometry, const InstanceData* instances, size_t count, const InstanceLight& light);
+    // Opacity of the following 3D draws, 0-255. Below 255 they blend over the target and are depth-tested
+    // without writing depth (submit them back to front). BeginTarget resets it to 255.
+    virtual void SetBlendAlpha(int alpha) = 0;
+
+    // Screen-space 2D drawing (right/bottom edges exclusive, like DxLib DrawBox)
+    virtual void DrawBox(int x0, int y0, int x1, int y1, unsigned int color, bool fill) = 0;
+    virtual void DrawCircle(int x, int y, int r, unsigned int color, bool fill) = 0;
+
+    // Images belong to the backend that loaded them and are released with it. LoadTexture returns -1 on
+    // failure. Holders of a handle keep Lifetime() and only call DeleteTexture while it hasn't expired.
+    virtual int LoadTexture(const std::string& path) = 0;
+    virtual void DeleteTexture(int handle) = 0;
+    virtual void DrawTexture(int x, int y, int handle) = 0;
+
+    // Expires when this backend is destroyed
+    std::weak_ptr<void> Lifetime() const { return lifetime_; }
+
+    static RenderBackend& Current();
+    // nullptr restores the default: DxLib, or a SoftwareRasterizer in builds without DxLib (VectorMath.h)
+    static void SetCurrent(RenderBackend* backend);
+
+private:
+    std::shared_ptr<int> lifetime_ = std::make_shared<int>(0);
+};
+
+// DxLibRenderBackend: forwards to DxLib (the editor/player path). Only defined when DxLib is available.
+class DxLibRenderBackend : public RenderBackend {
+public:
+    static DxLibRenderBackend& Instance();
+
+    int BeginTarget(int width, int height) override;
+    void EndTarget() override;
+    void SetCamera(float eyeX, float eyeY, float eyeZ, float targetX, float targetY, float targetZ, float fovY) override;
+    void DrawLine3D(const float a[3], const float b[3], unsigned int color) override;
+    void DrawTriangles3D(const RenderVertex* vertices, size_t count, bool wireframe) override;
+    void DrawLines3D(const RenderVertex* vertices, size_t count) override;
+    void SetBlendAlpha(int alpha) override;
+    void DrawBox(int x0, int y0, int x1, int y1, unsigned int color, bool fill) override;
+    void DrawCircle(int x, int y, int r, unsigned int color, bool fill) override;
+    int LoadTexture(const std::string& path) override;
+    void DeleteTexture(int handle) override;
+    void DrawTexture(int x, int y, int handle) override;
+
+private:
+    static const size_t kLineBatch = 4096; // lines per DrawPrimitive3D call
+
+    int prevScreen_ = -1;
+};
@@ -0,0 +1,45 @@
+#include "RenderQueue.h"
+#include <algorithm>
+
+uint64_t RenderQueue::MakeKey(int layer, bool transparent, uint32_t material, float depth01) {
+    const uint64_t depthMax = (1u << kDepthBits) - 1;
+    uint64_t l = (uint64_t)std::min(255, std::max(0, layer));
+    uint64_t m = material & ((1u << kMaterialBits) - 1);
+    float d = std::min(1.0f, std::max(0.0f, depth01)); // also maps NaN to 0
+    uint64_t depth = (uint64_t)(d * (float)depthMax);
+    uint64_t key = l << (64 - kLayerBits);
+    if (!transparent) return key | (m << kDepthBits) | depth;
+    key |= 1ull << (63 - kLayerBits);
+    return key | ((depthMax - depth) << kMaterialBits) | m;
+}
+
+void RenderQueue::Sort() {
+    const size_t n = items_.size();
+    stats_.items = (int)n;
+    if (n < 2) return;
+
+    // all eight histograms in one read
+    size_t counts[8][256] = {};
+    for (const Item& it : items_) {
+        for (int b = 0; b < 8; ++b) counts[b][(it.key >> (b * 8)) & 0xFF]++;
+    }
+    scratch_.resize(n);
+    std::vector<Item>* src = &items_;
+    std::vector<Item>* dst = &scratch_;
+    for (int b = 0; b < 8; ++b) {
+        size_t* c = counts[b];
+        if (c[(items_[0].key >> (b * 8)) & 0xFF] == n) continue; // every key has the same byte
+        size_t offset = 0;
+        for (int i = 0; i < 256; ++i) {
+            size_t count = c[i];
+            c[i] = offset;
+            offset += count;
+        }
+        const Item* in = src->data();
+        Item* out = dst->data();
+        for (size_t i = 0; i < n; ++i) out[c[(in[i].key >> (b * 8)) & 0xFF]++] = in[i];
+        std::swap(src, dst);
+        stats_.radixPasses++;
+    }
+    if (src != &items_) items_.swap(scratch_);
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// RenderQueue: draws of a frame as 64-bit sort keys, radix-sorted so submission walks them in state order.
+// Key layout, most significant first:
+//   layer (8 bits) | transparent (1 bit) | opaque: material (16) + depth front-to-back (24)
+//                                        | transparent: depth back-to-front (24) + material (16)
+// Opaque draws are grouped by material (fewest shader binds) and go near-to-far inside a material;
+// transparent draws come after the opaque ones of their layer, far-to-near so blending is correct.
+// Equal keys keep the order they were added in.
+class RenderQueue {
+public:
+    static const int kLayerBits = 8;
+    static const int kMaterialBits = 16;
+    static const int kDepthBits = 24;
+
+    struct Item {
+        uint64_t key;
+        uint32_t index; // caller's draw index
+        uint32_t pad;
+    };
+
+    struct Stats {
+        int items = 0;
+        int radixPasses = 0;    // byte passes the sort ran (bytes equal in every key are skipped)
+        int shaderBinds = 0;    // material changes while submitting
+        int bindsAvoided = 0;   // draws that reused the bound material
+        int blendChanges = 0;
+    };
+
+    // layer clamped to [0, 255]; material to 16 bits; depth01 = 0 at the near plane, 1 at the far plane
+    static uint64_t MakeKey(int layer, bool transparent, uint32_t material, float depth01);
+    static int GetLayer(uint64_t key) { return (int)(key >> (64 - kLayerBits)); }
+    static bool IsTransparent(uint64_t key) { return ((key >> (63 - kLayerBits)) & 1) != 0; }
+
+    void Clear() { items_.clear(); stats_ = Stats(); }
+    void Reserve(size_t count) { items_.reserve(count); scratch_.reserve(count); }
+    void Add(uint64_t key, uint32_t index) { items_.push_back({ key, index, 0 }); }
+    // Stable LSD radix sort on the key, 8 bits per pass
+    void Sort();
+
+    const std::vector<Item>& GetItems() const { return items_; }
+    size_t GetCount() const { return items_.size(); }
+    Stats& GetStats() { return stats_; }
+    const Stats& GetStats() const { return stats_; }
+
+private:
+    std::vector<Item> items_;
+    std::vector<Item> scratch_;
+    Stats stats_;
+};
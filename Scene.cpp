@@ -1,12 +1,21 @@
 #include "Scene.h"
 #include "Collider.h"
+#include "Collider3D.h"
 #include "Serializer.h"
-#include "DxLib.h"
+#include "VectorMath.h"
 #include "SpriteRenderer.h"
 #include "CameraComponent.h"
+#include "MeshRenderer.h"
+#include "MeshBVH.h"
+#include "RenderBackend.h"
 #include "Lighting.h"
+#include "Time.h"
+#include "JobSystem.h"
 #include <algorithm>
 #include <cmath>
+#include <unordered_map>
+#include <cstdint>
+#include <chrono>
 
 void Scene::AddRootObject(std::shared_ptr<GameObject> obj) {
     if (!obj) return;
@@ -33,11 +42,11 @@ std::vector<std::string> Scene::CollectOverridesFor(const std::shared_ptr<GameOb
     auto prefab = Serializer::LoadPrefab(prefabPath);
     if (!prefab) return out;
     // Compare transform x/y only for minimal implementation
-    if (fabsf(instance->transform().x - prefab->transform().x) > 1e-6f) {
-        out.push_back("PROP:" + instance->name() + ":transform.x:" + std::to_string(instance->transform().x));
+    if (fabsf(instance->ctransform().x - prefab->ctransform().x) > 1e-6f) {
+        out.push_back("PROP:" + instance->name() + ":transform.x:" + std::to_string(instance->ctransform().x));
     }
-    if (fabsf(instance->transform().y - prefab->transform().y) > 1e-6f) {
-        out.push_back("PROP:" + instance->name() + ":transform.y:" + std::to_string(instance->transform().y));
+    if (fabsf(instance->ctransform().y - prefab->ctransform().y) > 1e-6f) {
+        out.push_back("PROP:" + instance->name() + ":transform.y:" + std::to_string(instance->ctransform().y));
     }
     return out;
 }
@@ -89,20 +98,112 @@ void Scene::Start() {
     for (auto& r : src) r->Start();
 }
 
+namespace {
+    float LerpAngle(float a, float b, float t) {
+        float d = fmodf(b - a, 360.0f);
+        if (d > 180.0f) d -= 360.0f;
+        else if (d < -180.0f) d += 360.0f;
+        return a + d * t;
+    }
+}
+
 void Scene::Update() {
     // update all root objects (use playRoots_ when in play mode)
     auto& src = inPlayMode_ ? playRoots_ : roots_;
     for (auto& r : src) r->Update();
-    // collision / AABB handling
-    PhysicsStep();
+
+    // fixed-step simulation: FixedUpdate + collision / AABB handling
+    float hz = fixedStep.fixedHz > 1.0f ? fixedStep.fixedHz : 1.0f;
+    float dt = 1.0f / hz;
+    Time::fixedDeltaTime = dt;
+    fixedAccumulator_ += Time::deltaTime;
+
+    int steps = 0;
+    while (fixedAccumulator_ >= dt && steps < fixedStep.maxSubsteps) {
+        CapturePoses(prevPoses_);
+        auto& stepSrc = inPlayMode_ ? playRoots_ : roots_;
+        for (size_t i = 0; i < stepSrc.size(); ++i) stepSrc[i]->FixedUpdate();
+        PhysicsStep();
+        fixedAccumulator_ -= dt;
+        ++steps;
+    }
+    if (fixedAccumulator_ >= dt) {
+        // a long frame (or slow steps): drop whole steps rather than falling further behind
+        float dropped = floorf(fixedAccumulator_ / dt) * dt;
+        fixedAccumulator_ -= dropped;
+        physicsStats_.droppedTime += dropped;
+        physicsStats_.clampedFrames++;
+    }
+    if (steps > 0) CapturePoses(currPoses_);
+
+    physicsStats_.substepsLastFrame = steps;
+    physicsStats_.totalSubsteps += steps;
+    if (steps > physicsStats_.maxSubstepsSeen) physicsStats_.maxSubstepsSeen = steps;
+    physicsStats_.alpha = fixedAccumulator_ / dt;
+}
+
+void Scene::CapturePoses(std::vector<PoseState>& out) {
+    auto& src = inPlayMode_ ? playRoots_ : roots_;
+    out.resize(src.size());
+    for (size_t i = 0; i < src.size(); ++i) {
+        const Transform& t = src[i]->ctransform();
+        out[i] = { src[i]->id(), t.x, t.y, t.z, t.rotation, t.rotationX, t.rotationY, t.rotationZ, t.scaleX, t.scaleY, t.scaleZ };
+    }
+}
+
+void Scene::BeginInterpolatedPoses() {
+    auto& src = inPlayMode_ ? playRoots_ : roots_;
+    poseBlended_.assign(src.size(), 0);
+    if (!fixedStep.interpolate) return;
+    size_t n = std::min(src.size(), std::min(prevPoses_.size(), currPoses_.size()));
+    float a = physicsStats_.alpha;
+    for (size_t i = 0; i < n; ++i) {
+        const PoseState& p = prevPoses_[i];
+        const PoseState& c = currPoses_[i];
+        // both snapshots must be of this object; roots added or removed during the step shift the lists
+        if (p.owner != src[i]->id() || c.owner != p.owner) continue;
+        Transform& t = src[i]->transform_;
+        // only blend objects the simulation owns: anything moved since the step (editor drag,
+        // Update-driven movement) is drawn where it actually is
+        if (t.x != c.x || t.y != c.y || t.z != c.z || t.rotation != c.rotation ||
+            t.rotationX != c.rotationX || t.rotationY != c.rotationY || t.rotationZ != c.rotationZ ||
+            t.scaleX != c.scaleX || t.scaleY != c.scaleY || t.scaleZ != c.scaleZ) continue;
+        t.x = p.x + (c.x - p.x) * a;
+        t.y = p.y + (c.y - p.y) * a;
+        t.z = p.z + (c.z - p.z) * a;
+        t.rotation = LerpAngle(p.rotation, c.rotation, a);
+        t.rotationX = LerpAngle(p.rotationX, c.rotationX, a);
+        t.rotationY = LerpAngle(p.rotationY, c.rotationY, a);
+        t.rotationZ = LerpAngle(p.rotationZ, c.rotationZ, a);
+        t.scaleX = p.scaleX + (c.scaleX - p.scaleX) * a;
+        t.scaleY = p.scaleY + (c.scaleY - p.scaleY) * a;
+        t.scaleZ = p.scaleZ + (c.scaleZ - p.scaleZ) * a;
+        poseBlended_[i] = 1;
+    }
+}
+
+void Scene::EndInterpolatedPoses() {
+    auto& src = inPlayMode_ ? playRoots_ : roots_;
+    size_t n = std::min(src.size(), poseBlended_.size());
+    for (size_t i = 0; i < n; ++i) {
+        if (!poseBlended_[i]) continue;
+        const PoseState& c = currPoses_[i];
+        Transform& t = src[i]->transform_;
+        t.x = c.x; t.y = c.y; t.z = c.z;
+        t.rotation = c.rotation; t.rotationX = c.rotationX; t.rotationY = c.rotationY; t.rotationZ = c.rotationZ;
+        t.scaleX = c.scaleX; t.scaleY = c.scaleY; t.scaleZ = c.scaleZ;
+    }
+    poseBlended_.clear();
 }
 
 void Scene::Render() {
     auto& src = inPlayMode_ ? playRoots_ : roots_;
+    BeginInterpolatedPoses();
     for (auto& r : src) {
         if (r->IsPrefab()) continue; // never render prefab templates
         r->Render();
     }
+    EndInterpolatedPoses();
 }
 
 std::shared_ptr<GameObject> Scene::Instantiate(std::shared_ptr<GameObject> prefab) {
@@ -120,50 +221,426 @@ std::shared_ptr<GameObject> Scene::Instantiate(std::shared_ptr<GameObject> prefa
 }
 
 void Scene::RebuildColliderList() {
+    queryEntriesDirty_ = true;
+    // callbacks may add/remove objects mid-step; rebuild once the step is done
+    if (inPhysicsStep_) { colliderListDirty_ = true; return; }
+    colliderListDirty_ = false;
+    colliderComponentsVersion_ = GameObject::ComponentsVersion();
+    // state is carried over by key, not address: colliders removed since the last rebuild
+    // may have freed their address for a new one
+    std::vector<uint64_t> prevKeys;
+    prevKeys.swap(colliderKeys_);
+    // keep sweep start positions of continuous colliders that survive the rebuild
+    std::unordered_map<uint64_t, std::pair<float, float>> prevSweepPos;
+    for (size_t k = 0; k < continuous_.size() && continuous_[k] < prevKeys.size(); ++k) {
+        prevSweepPos[prevKeys[continuous_[k]]] = { ccdPrevX_[k], ccdPrevY_[k] };
+    }
+    // tree proxies of 3D colliders that survive are kept, so the rebuild doesn't re-insert everything
+    std::unordered_map<uint64_t, int> prevProxy;
+    for (size_t k = 0; k < colliders3D_.size() && colliders3D_[k] < prevKeys.size(); ++k) {
+        prevProxy[prevKeys[colliders3D_[k]]] = proxies3D_[k];
+    }
     colliders_.clear();
     auto& src = inPlayMode_ ? playRoots_ : roots_;
     for (auto& r : src) {
         if (r->IsPrefab()) continue;
+        uint32_t ordinal = 0;
         for (auto& c : r->GetAllComponents()) {
             auto col = std::dynamic_pointer_cast<Collider>(c);
-            if (col) colliders_.push_back(col.get());
+            if (!col) continue;
+            colliders_.push_back(col.get());
+            colliderKeys_.push_back((uint64_t)(uint32_t)r->id() << 32 | ordinal++);
         }
     }
+    broadPhase_.Reset(colliders_.size());
+
+    continuous_.clear();
+    ccdPrevX_.clear();
+    ccdPrevY_.clear();
+    for (size_t i = 0; i < colliders_.size(); ++i) {
+        Collider* c = colliders_[i];
+        if (!c->continuous || c->Is3D()) continue;
+        auto found = prevSweepPos.find(colliderKeys_[i]);
+        continuous_.push_back((uint32_t)i);
+        ccdPrevX_.push_back(found != prevSweepPos.end() ? found->second.first : c->owner->ctransform().x);
+        ccdPrevY_.push_back(found != prevSweepPos.end() ? found->second.second : c->owner->ctransform().y);
+    }
+
+    colliders3D_.clear();
+    proxies3D_.clear();
+    prevCenter3D_.clear();
+    size_t createdProxies = 0;
+    for (size_t i = 0; i < colliders_.size(); ++i) {
+        if (!colliders_[i]->Is3D()) continue;
+        auto* c = static_cast<Collider3D*>(colliders_[i]);
+        void* key = (void*)(uintptr_t)i;
+        int proxy;
+        auto found = prevProxy.find(colliderKeys_[i]);
+        if (found != prevProxy.end()) {
+            // the key may now name a different collider on the same object: refit to its bounds
+            proxy = found->second;
+            prevProxy.erase(found);
+            tree3D_.SetUserData(proxy, key);
+            tree3D_.MoveProxy(proxy, c->ComputeBounds());
+        } else {
+            proxy = tree3D_.CreateProxy(c->ComputeBounds(), key);
+            ++createdProxies;
+        }
+        colliders3D_.push_back((uint32_t)i);
+        proxies3D_.push_back(proxy);
+        const Transform& t = c->owner->ctransform();
+        prevCenter3D_.push_back(t.x);
+        prevCenter3D_.push_back(t.y);
+        prevCenter3D_.push_back(t.z);
+    }
+    for (auto& stale : prevProxy) tree3D_.DestroyProxy(stale.second);
+    // bulk additions (scene load, play mode) get a top-down rebuild instead of insertion order
+    if (createdProxies > 64 && createdProxies * 4 >= proxies3D_.size()) tree3D_.Rebuild();
+
+    // re-key the contacts of the previous step against the new list, dropping removed partners
+    std::unordered_map<uint64_t, uint32_t> indexOf;
+    indexOf.reserve(colliders_.size());
+    for (size_t i = 0; i < colliders_.size(); ++i) indexOf[colliderKeys_[i]] = (uint32_t)i;
+    for (Collider* c : colliders_) c->currentCollisions.clear();
+    size_t kept = 0;
+    for (const ColliderPair& p : prevPairs_) {
+        if (p.a >= prevKeys.size() || p.b >= prevKeys.size()) continue;
+        auto fa = indexOf.find(prevKeys[p.a]);
+        auto fb = indexOf.find(prevKeys[p.b]);
+        if (fa == indexOf.end() || fb == indexOf.end()) continue;
+        Collider* a = colliders_[fa->second];
+        Collider* b = colliders_[fb->second];
+        a->currentCollisions.insert(b);
+        b->currentCollisions.insert(a);
+        prevPairs_[kept++] = { std::min(fa->second, fb->second), std::max(fa->second, fb->second) };
+    }
+    prevPairs_.resize(kept);
+    std::sort(prevPairs_.begin(), prevPairs_.end(), [](const ColliderPair& x, const ColliderPair& y) {
+        return x.a < y.a || (x.a == y.a && x.b < y.b);
+    });
 }
 
 void Scene::PhysicsStep() {
-    // naive AABB collision detection
-    for (size_t i = 0; i < colliders_.size(); ++i) {
-        Collider* a = colliders_[i];
+    // colliders added to or removed from existing objects since the last rebuild
+    if (colliderComponentsVersion_ != GameObject::ComponentsVersion()) RebuildColliderList();
+    // broad + narrow phase run on the job pool; events are dispatched here on the calling thread
+    broadPhase_.Update(colliders_);
+    broadPhase_.FindOverlaps(overlapPairs_);
+    if (!colliders3D_.empty()) FindOverlaps3D();
+    if (!continuous_.empty()) SweepContinuous();
+    if (!colliders3D_.empty() || !continuous_.empty()) {
+        // extra pairs were appended: restore (a, b) order and drop duplicates
+        auto pairLess = [](const ColliderPair& x, const ColliderPair& y) {
+            return x.a < y.a || (x.a == y.a && x.b < y.b);
+        };
+        std::sort(overlapPairs_.begin(), overlapPairs_.end(), pairLess);
+        overlapPairs_.erase(std::unique(overlapPairs_.begin(), overlapPairs_.end(), [](const ColliderPair& x, const ColliderPair& y) {
+            return x.a == y.a && x.b == y.b;
+        }), overlapPairs_.end());
+    }
+
+    inPhysicsStep_ = true;
+    auto pairLess = [](const ColliderPair& x, const ColliderPair& y) {
+        return x.a < y.a || (x.a == y.a && x.b < y.b);
+    };
+    // both lists are sorted by (a, b), so walking them together reproduces list-order events
+    size_t ci = 0, pi = 0;
+    while (ci < overlapPairs_.size() || pi < prevPairs_.size()) {
+        bool takeCur = pi >= prevPairs_.size() || (ci < overlapPairs_.size() && !pairLess(prevPairs_[pi], overlapPairs_[ci]));
+        bool takePrev = ci >= overlapPairs_.size() || (pi < prevPairs_.size() && !pairLess(overlapPairs_[ci], prevPairs_[pi]));
+        const ColliderPair& p = takeCur ? overlapPairs_[ci] : prevPairs_[pi];
+        Collider* a = colliders_[p.a];
+        Collider* b = colliders_[p.b];
         GameObject* ao = a->owner;
-        float ax = ao->transform().x;
-        float ay = ao->transform().y;
-        float aw = a->width;
-        float ah = a->height;
-        for (size_t j = i + 1; j < colliders_.size(); ++j) {
-            Collider* b = colliders_[j];
-            GameObject* bo = b->owner;
-            float bx = bo->transform().x;
-            float by = bo->transform().y;
-            float bw = b->width;
-            float bh = b->height;
-            bool hit = a->TestAABB(ax, ay, aw, ah, bx, by, bw, bh);
-            bool wasHit = a->currentCollisions.count(b) > 0;
-            if (hit && !wasHit) {
-                a->currentCollisions.insert(b);
-                b->currentCollisions.insert(a);
-                for (auto& comp : ao->GetAllComponents()) comp->OnCollisionEnter(b);
-                for (auto& comp : bo->GetAllComponents()) comp->OnCollisionEnter(a);
-            } else if (hit && wasHit) {
-                for (auto& comp : ao->GetAllComponents()) comp->OnCollisionStay(b);
-                for (auto& comp : bo->GetAllComponents()) comp->OnCollisionStay(a);
-            } else if (!hit && wasHit) {
-                a->currentCollisions.erase(b);
-                b->currentCollisions.erase(a);
-                for (auto& comp : ao->GetAllComponents()) comp->OnCollisionExit(b);
-                for (auto& comp : bo->GetAllComponents()) comp->OnCollisionExit(a);
+        GameObject* bo = b->owner;
+        if (takeCur && !takePrev) {
+            a->currentCollisions.insert(b);
+            b->currentCollisions.insert(a);
+            for (auto& comp : ao->GetAllComponents()) comp->OnCollisionEnter(b);
+            for (auto& comp : bo->GetAllComponents()) comp->OnCollisionEnter(a);
+        } else if (takeCur && takePrev) {
+            for (auto& comp : ao->GetAllComponents()) comp->OnCollisionStay(b);
+            for (auto& comp : bo->GetAllComponents()) comp->OnCollisionStay(a);
+        } else {
+            a->currentCollisions.erase(b);
+            b->currentCollisions.erase(a);
+            for (auto& comp : ao->GetAllComponents()) comp->OnCollisionExit(b);
+            for (auto& comp : bo->GetAllComponents()) comp->OnCollisionExit(a);
+        }
+        if (takeCur) ++ci;
+        if (takePrev) ++pi;
+    }
+    prevPairs_.swap(overlapPairs_);
+    for (size_t k = 0; k < continuous_.size(); ++k) {
+        const Transform& t = colliders_[continuous_[k]]->owner->ctransform();
+        ccdPrevX_[k] = t.x;
+        ccdPrevY_[k] = t.y;
+    }
+    inPhysicsStep_ = false;
+
+    if (colliderListDirty_ || colliderComponentsVersion_ != GameObject::ComponentsVersion()) RebuildColliderList();
+}
+
+void Scene::SweepContinuous() {
+    // only the continuous colliders are swept, so cost scales with the number of fast movers
+    JobSystem& jobs = JobSystem::Instance();
+    const size_t kMinBatch = 16;
+    int chunks = jobs.ChunkCount(continuous_.size(), kMinBatch);
+    if ((int)ccdChunkPairs_.size() < chunks) ccdChunkPairs_.resize(chunks);
+    for (int c = 0; c < chunks; ++c) ccdChunkPairs_[c].clear();
+
+    const SimdAABB::AABBSoA& bounds = broadPhase_.GetBounds();
+    jobs.ParallelFor(continuous_.size(), kMinBatch, [&](size_t begin, size_t end, int chunk) {
+        std::vector<uint32_t> candidates;
+        for (size_t k = begin; k < end; ++k) {
+            uint32_t i = continuous_[k];
+            Collider* a = colliders_[i];
+            a->sweepHits.clear();
+            float px = ccdPrevX_[k], py = ccdPrevY_[k];
+            float dx = bounds.minX[i] - px;
+            float dy = bounds.minY[i] - py;
+            if (dx == 0.0f && dy == 0.0f) continue;
+
+            // broad-phase candidates inside the box covering the whole motion
+            candidates.clear();
+            broadPhase_.QueryBox(std::min(px, bounds.minX[i]), std::min(py, bounds.minY[i]),
+                                 std::max(px, bounds.minX[i]) + a->width, std::max(py, bounds.minY[i]) + a->height,
+                                 candidates);
+            for (uint32_t j : candidates) {
+                if (j == i) continue;
+                Collider* b = colliders_[j];
+                float toi, nx, ny;
+                if (a->SweepAABB(px, py, a->width, a->height, dx, dy,
+                                 bounds.minX[j], bounds.minY[j], b->width, b->height, toi, nx, ny)) {
+                    a->sweepHits.push_back({ b, toi, nx, ny });
+                    ccdChunkPairs_[chunk].push_back(i < j ? ColliderPair{ i, j } : ColliderPair{ j, i });
+                }
+            }
+            std::stable_sort(a->sweepHits.begin(), a->sweepHits.end(), [](const Collider::SweepHit& x, const Collider::SweepHit& y) {
+                return x.time < y.time;
+            });
+        }
+    });
+
+    // a pair touched during the step counts as overlapping for this step's events
+    for (int c = 0; c < chunks; ++c) {
+        overlapPairs_.insert(overlapPairs_.end(), ccdChunkPairs_[c].begin(), ccdChunkPairs_[c].end());
+    }
+}
+
+void Scene::FindOverlaps3D() {
+    // refit: proxies only move in the tree once they leave their fat boxes
+    const size_t n = colliders3D_.size();
+    bounds3D_.resize(n);
+    for (size_t k = 0; k < n; ++k) {
+        auto* c = static_cast<Collider3D*>(colliders_[colliders3D_[k]]);
+        const Transform& t = c->owner->ctransform();
+        bounds3D_[k] = c->ComputeBounds();
+        float* prev = &prevCenter3D_[k * 3];
+        tree3D_.MoveProxy(proxies3D_[k], bounds3D_[k], t.x - prev[0], t.y - prev[1], t.z - prev[2]);
+        prev[0] = t.x; prev[1] = t.y; prev[2] = t.z;
+    }
+
+    // tree queries + narrow phase run in parallel, each chunk writing its own pair buffer
+    JobSystem& jobs = JobSystem::Instance();
+    const size_t kMinBatch = 64;
+    int chunks = jobs.ChunkCount(n, kMinBatch);
+    if ((int)chunkPairs3D_.size() < chunks) chunkPairs3D_.resize(chunks);
+    for (int c = 0; c < chunks; ++c) chunkPairs3D_[c].clear();
+
+    jobs.ParallelFor(n, kMinBatch, [&](size_t begin, size_t end, int chunk) {
+        for (size_t k = begin; k < end; ++k) {
+            uint32_t i = colliders3D_[k];
+            auto* a = static_cast<Collider3D*>(colliders_[i]);
+            tree3D_.QueryOverlap(bounds3D_[k], [&](int proxy) {
+                uint32_t j = (uint32_t)(uintptr_t)tree3D_.GetUserData(proxy);
+                // each pair is reported by its lower index only
+                if (j <= i) return true;
+                auto* b = static_cast<Collider3D*>(colliders_[j]);
+                if (a->Overlaps(*b)) chunkPairs3D_[chunk].push_back({ i, j });
+                return true;
+            });
+        }
+    });
+    for (int c = 0; c < chunks; ++c) {
+        overlapPairs_.insert(overlapPairs_.end(), chunkPairs3D_[c].begin(), chunkPairs3D_[c].end());
+    }
+}
+
+namespace {
+    const MeshBVH* EnsureMeshBVH(const Mesh& mesh) {
+        if (!mesh.bvh) {
+            mesh.bvh = std::make_shared<MeshBVH>();
+            mesh.bvh->Build(mesh);
+        }
+        return mesh.bvh->Empty() ? nullptr : mesh.bvh.get();
+    }
+}
+
+Bounds3 Scene::ComputeQueryBounds(const QueryEntry& e) const {
+    const Transform& t = e.object->ctransform();
+    Bounds3 b;
+    if (e.kind == kQueryColliders3D) return static_cast<Collider3D*>(e.component)->ComputeBounds();
+    if (e.kind == kQueryColliders2D) {
+        // same box as the 2D broad phase, flat at the object's z
+        auto* c = static_cast<Collider*>(e.component);
+        b.minX = t.x; b.minY = t.y; b.minZ = t.z;
+        b.maxX = t.x + c->width; b.maxY = t.y + c->height; b.maxZ = t.z;
+        return b;
+    }
+    if (e.kind == kQueryMeshes) return static_cast<MeshRenderer*>(e.component)->ComputeWorldBounds();
+    b.minX = b.maxX = t.x; b.minY = b.maxY = t.y; b.minZ = b.maxZ = t.z;
+    return b;
+}
+
+void Scene::SyncQueryIndex() {
+    // components added or removed anywhere (inspector, scripts, prefab revert) re-index the entries
+    if (queryComponentsVersion_ != GameObject::ComponentsVersion()) queryEntriesDirty_ = true;
+    // objects written through transform() / MarkMoved() since the last sync
+    GameObject::TakeMoved(queryMovedObjects_);
+    if (!queryEntriesDirty_ && queryMovedObjects_.empty()) return;
+    auto& src = inPlayMode_ ? playRoots_ : roots_;
+    if (queryEntriesDirty_) {
+        for (auto& e : queryEntries_) queryTree_.DestroyProxy(e.proxy);
+        queryEntries_.clear();
+        queryEntryRange_.clear();
+        for (size_t ri = 0; ri < src.size(); ++ri) {
+            GameObject* obj = src[ri].get();
+            if (obj->IsPrefab()) continue;
+            const uint32_t first = (uint32_t)queryEntries_.size();
+            queryEntries_.push_back({ obj, nullptr, kQueryPivots, (uint32_t)ri, AABBTree::kNull });
+            for (auto& c : obj->GetAllComponents()) {
+                if (auto* col = dynamic_cast<Collider*>(c.get())) {
+                    queryEntries_.push_back({ obj, col, col->Is3D() ? kQueryColliders3D : kQueryColliders2D, (uint32_t)ri, AABBTree::kNull });
+                } else if (auto* mr = dynamic_cast<MeshRenderer*>(c.get())) {
+                    queryEntries_.push_back({ obj, mr, kQueryMeshes, (uint32_t)ri, AABBTree::kNull });
+                }
+            }
+            queryEntryRange_[obj] = { first, (uint32_t)queryEntries_.size() - first };
+        }
+        // meshes are loaded in Awake; BVHs are built here, outside the parallel refit
+        for (auto& e : queryEntries_) {
+            if (e.kind != kQueryMeshes) continue;
+            auto* mr = static_cast<MeshRenderer*>(e.component);
+            if (mr->mesh_) EnsureMeshBVH(*mr->mesh_);
+        }
+        const size_t n = queryEntries_.size();
+        queryBounds_.resize(n);
+        JobSystem::Instance().ParallelFor(n, 1024, [&](size_t begin, size_t end, int) {
+            for (size_t i = begin; i < end; ++i) queryBounds_[i] = ComputeQueryBounds(queryEntries_[i]);
+        });
+        for (size_t i = 0; i < n; ++i) queryEntries_[i].proxy = queryTree_.CreateProxy(queryBounds_[i], (void*)(uintptr_t)i);
+        queryTree_.Rebuild();
+        queryComponentsVersion_ = GameObject::ComponentsVersion();
+        queryEntriesDirty_ = false;
+        return;
+    }
+
+    // refit only the entries of moved objects (objects of other scenes / children aren't indexed)
+    queryRefit_.clear();
+    for (GameObject* obj : queryMovedObjects_) {
+        auto it = queryEntryRange_.find(obj);
+        if (it == queryEntryRange_.end()) continue;
+        for (uint32_t i = 0; i < it->second.second; ++i) queryRefit_.push_back(it->second.first + i);
+    }
+    JobSystem::Instance().ParallelFor(queryRefit_.size(), 1024, [&](size_t begin, size_t end, int) {
+        for (size_t k = begin; k < end; ++k) queryBounds_[queryRefit_[k]] = ComputeQueryBounds(queryEntries_[queryRefit_[k]]);
+    });
+    for (uint32_t i : queryRefit_) queryTree_.MoveProxy(queryEntries_[i].proxy, queryBounds_[i]);
+}
+
+bool Scene::Raycast(float ox, float oy, float oz, float dirX, float dirY, float dirZ, float maxDistance,
+                    RaycastHit& outHit, int mask) {
+    float len = sqrtf(dirX * dirX + dirY * dirY + dirZ * dirZ);
+    if (len <= 0.0f || maxDistance <= 0.0f) return false;
+    float dx = dirX / len, dy = dirY / len, dz = dirZ / len;
+    SyncQueryIndex();
+
+    bool found = false;
+    queryTree_.Raycast(ox, oy, oz, dx, dy, dz, maxDistance, [&](int proxy, float maxT) -> float {
+        const QueryEntry& e = queryEntries_[(size_t)(uintptr_t)queryTree_.GetUserData(proxy)];
+        if (!(e.kind & mask)) return maxT;
+        float t = 0, nx = 0, ny = 0, nz = 0;
+        int tri = -1;
+        if (e.kind == kQueryColliders3D) {
+            if (!static_cast<Collider3D*>(e.component)->Raycast(ox, oy, oz, dx, dy, dz, maxT, t, nx, ny, nz)) return maxT;
+        } else if (e.kind == kQueryMeshes) {
+            auto* mr = static_cast<MeshRenderer*>(e.component);
+            const Transform& tr = e.object->ctransform();
+            if (mr->mesh_ && mr->mesh_->bvh && !mr->mesh_->bvh->Empty()) {
+                if (tr.scaleX == 0.0f || tr.scaleY == 0.0f || tr.scaleZ == 0.0f) return maxT;
+                // ray in mesh space (inverse of Transform::GetMatrix3D); t is unchanged by the affine transform
+                float axes[3][3];
+                tr.GetAxes3D(axes);
+                const float s[3] = { tr.scaleX, tr.scaleY, tr.scaleZ };
+                const float rel[3] = { ox - tr.x, oy - tr.y, oz - tr.z };
+                float lo[3], ld[3];
+                for (int i = 0; i < 3; ++i) {
+                    lo[i] = (axes[i][0] * rel[0] + axes[i][1] * rel[1] + axes[i][2] * rel[2]) / s[i];
+                    ld[i] = (axes[i][0] * dx + axes[i][1] * dy + axes[i][2] * dz) / s[i];
+                }
+                float ln[3];
+                if (!mr->mesh_->bvh->Raycast(lo[0], lo[1], lo[2], ld[0], ld[1], ld[2], maxT, t, tri, ln[0], ln[1], ln[2])) return maxT;
+                for (int i = 0; i < 3; ++i) ln[i] /= s[i];
+                nx = axes[0][0] * ln[0] + axes[1][0] * ln[1] + axes[2][0] * ln[2];
+                ny = axes[0][1] * ln[0] + axes[1][1] * ln[1] + axes[2][1] * ln[2];
+                nz = axes[0][2] * ln[0] + axes[1][2] * ln[1] + axes[2][2] * ln[2];
+                float nl = sqrtf(nx * nx + ny * ny + nz * nz);
+                if (nl > 0.0f) { nx /= nl; ny /= nl; nz /= nl; }
+                if (nx * dx + ny * dy + nz * dz > 0.0f) { nx = -nx; ny = -ny; nz = -nz; }
+            } else {
+                float inv[3] = { dx != 0.0f ? 1.0f / dx : INFINITY, dy != 0.0f ? 1.0f / dy : INFINITY, dz != 0.0f ? 1.0f / dz : INFINITY };
+                const Bounds3& b = queryBounds_[(size_t)(uintptr_t)queryTree_.GetUserData(proxy)];
+                if (!b.RayHit(ox, oy, oz, inv[0], inv[1], inv[2], maxT, t)) return maxT;
+                // face normal from the side the hit point lies on
+                float px = ox + dx * t - (b.minX + b.maxX) * 0.5f;
+                float py = oy + dy * t - (b.minY + b.maxY) * 0.5f;
+                float pz = oz + dz * t - (b.minZ + b.maxZ) * 0.5f;
+                float ex = (b.maxX - b.minX) * 0.5f, ey = (b.maxY - b.minY) * 0.5f, ez = (b.maxZ - b.minZ) * 0.5f;
+                float ax = ex > 0 ? fabsf(px) / ex : 0, ay = ey > 0 ? fabsf(py) / ey : 0, az = ez > 0 ? fabsf(pz) / ez : 0;
+                if (ax >= ay && ax >= az) nx = px < 0 ? -1.0f : 1.0f;
+                else if (ay >= az) ny = py < 0 ? -1.0f : 1.0f;
+                else nz = pz < 0 ? -1.0f : 1.0f;
             }
+        } else {
+            return maxT; // 2D colliders and pivots have no volume to hit
         }
+        found = true;
+        outHit.object = e.object;
+        outHit.component = e.component;
+        outHit.distance = t;
+        outHit.pointX = ox + dx * t; outHit.pointY = oy + dy * t; outHit.pointZ = oz + dz * t;
+        outHit.normalX = nx; outHit.normalY = ny; outHit.normalZ = nz;
+        outHit.triangle = tri;
+        return t; // 0 (ray starts inside) ends the query: nothing can be closer
+    });
+    return found;
+}
+
+void Scene::OverlapPoint(float x, float y, float z, std::vector<GameObject*>& out, int mask) {
+    Bounds3 b;
+    b.minX = b.maxX = x; b.minY = b.maxY = y; b.minZ = b.maxZ = z;
+    OverlapBox(b, out, mask);
+}
+
+void Scene::OverlapBox(const Bounds3& box, std::vector<GameObject*>& out, int mask) {
+    out.clear();
+    SyncQueryIndex();
+    std::vector<uint32_t> hits;
+    queryTree_.QueryOverlap(box, [&](int proxy) {
+        uint32_t i = (uint32_t)(uintptr_t)queryTree_.GetUserData(proxy);
+        const QueryEntry& e = queryEntries_[i];
+        if (!(e.kind & mask)) return true;
+        bool hit = e.kind == kQueryColliders3D ? static_cast<Collider3D*>(e.component)->OverlapsBounds(box)
+                                               : queryBounds_[i].Overlaps(box);
+        if (hit) hits.push_back(i);
+        return true;
+    });
+    // entries are stored in root order
+    std::sort(hits.begin(), hits.end());
+    for (uint32_t i : hits) {
+        GameObject* obj = queryEntries_[i].object;
+        if (out.empty() || out.back() != obj) out.push_back(obj);
     }
 }
 
@@ -205,30 +682,49 @@ void Scene::ExitPlayMode() {
 }
 
 int Scene::RenderToTarget(int width, int height, const Camera2D& cam) {
-    int screen = MakeScreen(width, height, TRUE);
-    if (screen == -1) return 0;
-    int prev = GetDrawScreen();
-    SetDrawScreen(screen);
-    ClearDrawScreen();
+    RenderBackend& gfx = RenderBackend::Current();
+    int screen = gfx.BeginTarget(width, height);
+    if (screen == 0) return 0;
     auto& src = inPlayMode_ ? playRoots_ : roots_;
+    BeginInterpolatedPoses();
     for (auto& r : src) {
         if (r->IsPrefab()) continue; // never render prefab templates
-        float ox = r->transform().x;
-        float oy = r->transform().y;
-        r->transform().x = (ox - cam.x) * cam.zoom + width / 2.0f;
-        r->transform().y = (oy - cam.y) * cam.zoom + height / 2.0f;
+        float ox = r->transform_.x;
+        float oy = r->transform_.y;
+        r->transform_.x = (ox - cam.x) * cam.zoom + width / 2.0f;
+        r->transform_.y = (oy - cam.y) * cam.zoom + height / 2.0f;
         r->Render();
-        r->transform().x = ox;
-        r->transform().y = oy;
+        r->transform_.x = ox;
+        r->transform_.y = oy;
     }
+    EndInterpolatedPoses();
 
-    SetDrawScreen(prev);
+    gfx.EndTarget();
     return screen;
 }
 
-int Scene::RenderToTarget3D(int width, int height, const Camera3D& cam) {
+Scene::Camera3D Scene::ResolveCamera3D(const Camera3D& cam) const {
+    // the first camera object takes the editor camera's orbit and provides the target position
     Camera3D camUsed = cam;
-    for (auto& obj : roots_) {
+    auto& src = inPlayMode_ ? playRoots_ : roots_;
+    for (auto& obj : src) {
+        if (obj->IsPrefab()) continue; // ignore prefab templates
+        for (auto& c : obj->GetAllComponents()) {
+            if (dynamic_cast<CameraComponent*>(c.get())) {
+                camUsed.x = obj->ctransform().x;
+                camUsed.y = obj->ctransform().y;
+                camUsed.z = obj->ctransform().z;
+                return camUsed;
+            }
+        }
+    }
+    return camUsed;
+}
+
+int Scene::RenderToTarget3D(int width, int height, const Camera3D& cam) {
+    // play mode draws and culls the runtime clones, which are also what the poses blend
+    auto& src = inPlayMode_ ? playRoots_ : roots_;
+    for (auto& obj : src) {
         if (obj->IsPrefab()) continue; // ignore prefab templates
         for (auto& c : obj->GetAllComponents()) {
             auto camComp = std::dynamic_pointer_cast<CameraComponent>(c);
@@ -237,73 +733,305 @@ int Scene::RenderToTarget3D(int width, int height, const Camera3D& cam) {
                 camComp->pitch = cam.pitch;
                 camComp->distance = cam.distance;
                 camComp->fov = cam.fov;
-
-                camUsed.yaw = camComp->yaw;
-                camUsed.pitch = camComp->pitch;
-                camUsed.distance = camComp->distance;
-                camUsed.fov = camComp->fov;
-                camUsed.x = obj->transform().x;
-                camUsed.y = obj->transform().y;
-                camUsed.z = obj->transform().z;
                 goto camera_determined;
             }
         }
     }
 camera_determined:;
+    Camera3D camUsed = ResolveCamera3D(cam);
 
-    int screen = MakeScreen(width, height, TRUE);
-    if (screen == -1) return 0;
-    int prev = GetDrawScreen();
-    SetDrawScreen(screen);
-    ClearDrawScreen();
+    RenderBackend& gfx = RenderBackend::Current();
+    int screen = gfx.BeginTarget(width, height);
+    if (screen == 0) return 0;
 
     float radYaw = camUsed.yaw * 3.14159265f / 180.0f;
     float radPitch = camUsed.pitch * 3.14159265f / 180.0f;
     float cx = camUsed.x + cosf(radYaw) * cosf(radPitch) * camUsed.distance;
     float cy = camUsed.y + sinf(radPitch) * camUsed.distance;
     float cz = camUsed.z + sinf(radYaw) * cosf(radPitch) * camUsed.distance;
-    SetCameraPositionAndTarget_UpVecY(VGet(cx, cy, cz), VGet(camUsed.x, camUsed.y, camUsed.z));
+    gfx.SetCamera(cx, cy, cz, camUsed.x, camUsed.y, camUsed.z, camUsed.fov * 3.14159265f / 180.0f);
+    FrustumCulling::Frustum frustum = FrustumCulling::Frustum::FromCamera(cx, cy, cz, camUsed.x, camUsed.y, camUsed.z,
+        camUsed.fov * 3.14159265f / 180.0f, (float)width / (float)height, RenderBackend::kNearZ, RenderBackend::kFarZ);
 
     // Update global lighting info from scene mainLight
     Lighting::SetMainDirectionalLight(mainLight.dirX, mainLight.dirY, mainLight.dirZ, mainLight.color, mainLight.intensity);
 
-    for (auto& r : roots_) {
+    BeginInterpolatedPoses();
+    CullMeshRenderers(frustum);
+    if (occlusion.enabled) {
+        float viewProj[4][4];
+        FrustumCulling::BuildViewProjection(viewProj, cx, cy, cz, camUsed.x, camUsed.y, camUsed.z,
+            camUsed.fov * 3.14159265f / 180.0f, (float)width / (float)height, RenderBackend::kNearZ, RenderBackend::kFarZ);
+        OcclusionCullMeshRenderers(viewProj, cx, cy, cz, (float)width / (float)height);
+    }
+
+    BuildRenderQueue(cx, cy, cz, tanf(camUsed.fov * 3.14159265f / 360.0f));
+
+    // queued MeshRenderers skip themselves here and are drawn in key order below
+    for (auto& r : src) {
         if (r->IsPrefab()) continue; // never render prefab templates
         r->Render();
     }
+    SubmitRenderQueue(gfx);
+    EndCulling();
 
     if (showGrid) {
         int gridSize = 1000;
         int step = 50;
         int half = gridSize / 2;
+        const unsigned int gridColor = 0x787878;
         for (int x = -half; x <= half; x += step) {
-            DrawLine3D(VGet((float)x, 0.0f, (float)-half), VGet((float)x, 0.0f, (float)half), GetColor(120,120,120));
+            float a[3] = { (float)x, 0.0f, (float)-half }, b[3] = { (float)x, 0.0f, (float)half };
+            gfx.DrawLine3D(a, b, gridColor);
         }
         for (int z = -half; z <= half; z += step) {
-            DrawLine3D(VGet((float)-half, 0.0f, (float)z), VGet((float)half, 0.0f, (float)z), GetColor(120,120,120));
+            float a[3] = { (float)-half, 0.0f, (float)z }, b[3] = { (float)half, 0.0f, (float)z };
+            gfx.DrawLine3D(a, b, gridColor);
         }
     }
 
-    DrawCircle(width - 60, 40, 10, GetColor(255,245,200), TRUE);
+    gfx.DrawCircle(width - 60, 40, 10, 0xFFF5C8, true);
 
-    for (auto& r : roots_) {
+    for (auto& r : src) {
         if (r->IsPrefab()) continue;
         for (auto& c : r->GetAllComponents()) {
             auto sr = std::dynamic_pointer_cast<SpriteRenderer>(c);
             if (sr && sr->handle_ != -1) {
-                float ox = r->transform().x;
-                float oz = r->transform().y; // using 2D y as z for simple mapping
+                float ox = r->ctransform().x;
+                float oz = r->ctransform().y; // using 2D y as z for simple mapping
                 int sx = (int)(width/2 + (ox - camUsed.x));
                 int sz = (int)(height/2 + (oz - camUsed.z));
-                DrawBox(sx - 20, sz + 2, sx + 20, sz + 12, GetColor(0,0,0), TRUE);
+                gfx.DrawBox(sx - 20, sz + 2, sx + 20, sz + 12, 0x000000, true);
             }
         }
     }
+    EndInterpolatedPoses();
 
-    SetDrawScreen(prev);
+    gfx.EndTarget();
     return screen;
 }
 
+void Scene::CullMeshRenderers(const FrustumCulling::Frustum& frustum) {
+    cullRenderers_.clear();
+    auto& src = inPlayMode_ ? playRoots_ : roots_;
+    for (auto& r : src) {
+        if (r->IsPrefab()) continue;
+        for (auto& c : r->GetAllComponents()) {
+            auto* mr = dynamic_cast<MeshRenderer*>(c.get());
+            if (mr && mr->enabled) cullRenderers_.push_back(mr);
+        }
+    }
+    const size_t n = cullRenderers_.size();
+    cullBounds_.Resize(n);
+    cullVisible_.assign(n, 1);
+    const size_t batches = (n + FrustumCulling::kBatch - 1) / FrustumCulling::kBatch;
+    JobSystem::Instance().ParallelFor(batches, 64, [&](size_t begin, size_t end, int) {
+        size_t first = begin * FrustumCulling::kBatch;
+        size_t last = std::min(n, end * FrustumCulling::kBatch);
+        for (size_t i = first; i < last; ++i) {
+            float radius;
+            Bounds3 b = cullRenderers_[i]->ComputeWorldBounds(&radius);
+            cullBounds_.Set(i, b, radius);
+        }
+        if (frustumCulling) FrustumCulling::Cull(cullBounds_, frustum, first, last, cullVisible_);
+    });
+
+    renderStats_ = RenderStats();
+    for (size_t i = 0; i < n; ++i) {
+        MeshRenderer* mr = cullRenderers_[i];
+        size_t tris = mr->mesh_ ? mr->mesh_->TriangleCount() : 0;
+        mr->culled_ = !cullVisible_[i];
+        if (mr->culled_) { renderStats_.meshesCulled++; renderStats_.trianglesCulled += tris; }
+        else { renderStats_.meshesVisible++; renderStats_.trianglesVisible += tris; }
+    }
+}
+
+void Scene::OcclusionCullMeshRenderers(const float viewProj[4][4], float eyeX, float eyeY, float eyeZ, float aspect) {
+    auto start = std::chrono::steady_clock::now();
+    const size_t n = cullRenderers_.size();
+
+    // occluders: visible filled meshes, biggest on screen first (wireframes hide nothing)
+    occluderCandidates_.clear();
+    occluderScores_.assign(n, 0.0f);
+    for (size_t i = 0; i < n; ++i) {
+        MeshRenderer* mr = cullRenderers_[i];
+        if (mr->culled_ || !mr->mesh_ || mr->wireframe_ || mr->mesh_->TriangleCount() == 0) continue;
+        float dx = cullBounds_.centerX[i] - eyeX, dy = cullBounds_.centerY[i] - eyeY, dz = cullBounds_.centerZ[i] - eyeZ;
+        float dist = sqrtf(dx * dx + dy * dy + dz * dz);
+        float size = dist > 0.0f ? cullBounds_.radius[i] / dist : INFINITY;
+        if (size < occlusion.minOccluderSize) continue;
+        occluderScores_[i] = size;
+        occluderCandidates_.push_back(i);
+    }
+    std::sort(occluderCandidates_.begin(), occluderCandidates_.end(),
+              [&](size_t a, size_t b) { return occluderScores_[a] > occluderScores_[b]; });
+
+    int bufferWidth = std::max(4, occlusion.bufferWidth);
+    occlusion_.Initialize(bufferWidth, std::max(1, (int)(bufferWidth / std::max(aspect, 0.01f))));
+    occlusion_.BeginFrame(viewProj);
+    size_t triangles = 0;
+    int occluders = 0;
+    for (size_t i : occluderCandidates_) {
+        if (occluders >= occlusion.maxOccluders) break;
+        MeshRenderer* mr = cullRenderers_[i];
+        size_t tris = mr->mesh_->TriangleCount();
+        if (triangles + tris > occlusion.occluderTriangleBudget) continue;
+        float model[3][4];
+        mr->owner->ctransform().GetMatrix3D(model);
+        occlusion_.AddOccluder(*mr->mesh_, model);
+        triangles += tris;
+        occluders++;
+    }
+
+    if (occluders > 0) {
+        occlusion_.BuildHiZ();
+        JobSystem::Instance().ParallelFor(n, 64, [&](size_t begin, size_t end, int) {
+            for (size_t i = begin; i < end; ++i) {
+                if (!cullVisible_[i]) continue;
+                Bounds3 b;
+                b.minX = cullBounds_.centerX[i] - cullBounds_.extentX[i]; b.maxX = cullBounds_.centerX[i] + cullBounds_.extentX[i];
+                b.minY = cullBounds_.centerY[i] - cullBounds_.extentY[i]; b.maxY = cullBounds_.centerY[i] + cullBounds_.extentY[i];
+                b.minZ = cullBounds_.centerZ[i] - cullBounds_.extentZ[i]; b.maxZ = cullBounds_.centerZ[i] + cullBounds_.extentZ[i];
+                if (!occlusion_.IsVisible(b)) cullVisible_[i] = 0;
+            }
+        });
+        for (size_t i = 0; i < n; ++i) {
+            MeshRenderer* mr = cullRenderers_[i];
+            if (cullVisible_[i] || mr->culled_) continue; // culled_ is still the frustum result here
+            size_t tris = mr->mesh_ ? mr->mesh_->TriangleCount() : 0;
+            mr->culled_ = true;
+            renderStats_.meshesVisible--; renderStats_.trianglesVisible -= tris;
+            renderStats_.meshesOccluded++; renderStats_.trianglesOccluded += tris;
+        }
+    }
+    renderStats_.occluders = occlusion_.GetStats().occluders;
+    renderStats_.occluderTriangles = occlusion_.GetStats().occluderTriangles;
+    renderStats_.occlusionMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Scene::BuildRenderQueue(float eyeX, float eyeY, float eyeZ, float tanHalfFov) {
+    auto start = std::chrono::steady_clock::now();
+    renderQueue_.Clear();
+    queuedDraws_.clear();
+    groupDraws_.clear();
+    materialIds_.clear();
+    if (gpuInstancing) instancer_.Begin();
+
+    const float depthScale = 1.0f / (RenderBackend::kFarZ - RenderBackend::kNearZ);
+    for (size_t i = 0; i < cullRenderers_.size(); ++i) {
+        MeshRenderer* mr = cullRenderers_[i];
+        if (mr->culled_) continue;
+        mr->queued_ = true;
+        float dx = cullBounds_.centerX[i] - eyeX, dy = cullBounds_.centerY[i] - eyeY, dz = cullBounds_.centerZ[i] - eyeZ;
+        float dist = sqrtf(dx * dx + dy * dy + dz * dz);
+        float depth = (dist - RenderBackend::kNearZ) * depthScale;
+        if (mr->lods_) {
+            // bounding-sphere diameter over the screen height
+            float size = dist > cullBounds_.radius[i] ? cullBounds_.radius[i] / (dist * tanHalfFov) * lod.bias : INFINITY;
+            if (lod.enabled) mr->SelectLod(size, lod.hysteresis);
+            else mr->lodLevel_ = 0;
+        }
+        if (mr->mesh_) {
+            renderStats_.trianglesDrawn += mr->GetDrawMesh()->TriangleCount();
+            if (mr->GetDrawMesh() != mr->mesh_) renderStats_.meshesLodReduced++;
+        }
+        int group = gpuInstancing ? instancer_.Add(*mr) : -1;
+        if (group < 0) {
+            queuedDraws_.push_back({ mr, -1, depth });
+        } else if ((size_t)group == groupDraws_.size()) {
+            groupDraws_.push_back(queuedDraws_.size());
+            queuedDraws_.push_back({ nullptr, group, depth });
+        } else {
+            // a group sorts by its nearest instance
+            float& d = queuedDraws_[groupDraws_[group]].depth;
+            d = std::min(d, depth);
+        }
+    }
+    if (gpuInstancing) instancer_.UploadInstanceData();
+
+    renderQueue_.Reserve(queuedDraws_.size());
+    for (size_t i = 0; i < queuedDraws_.size(); ++i) {
+        const QueuedDraw& d = queuedDraws_[i];
+        const MeshRenderer* mr = d.group >= 0 ? instancer_.GetGroupRenderer(d.group) : d.renderer;
+        auto material = materialIds_.emplace(mr->shader_.get(), (uint32_t)materialIds_.size()).first->second;
+        uint64_t key = sortRenderQueue ? RenderQueue::MakeKey(mr->layer_, mr->alpha_ < 255, material, d.depth) : 0;
+        renderQueue_.Add(key, (uint32_t)i);
+    }
+    renderQueue_.Sort();
+
+    renderStats_.meshesInstanced = gpuInstancing ? instancer_.GetStats().instances : 0;
+    renderStats_.instanceGroups = gpuInstancing ? instancer_.GetStats().groups : 0;
+    renderStats_.queueItems = (int)renderQueue_.GetCount();
+    renderStats_.queueMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Scene::SubmitRenderQueue(RenderBackend& gfx) {
+    const InstanceLight light = MeshRenderer::GetMainLight();
+    RenderQueue::Stats& stats = renderQueue_.GetStats();
+    const size_t bindsBefore = Shader::GetBindCount();
+    const Shader* bound = nullptr;
+    bool anyBound = false;
+    int alpha = 255;
+    for (const RenderQueue::Item& item : renderQueue_.GetItems()) {
+        const QueuedDraw& d = queuedDraws_[item.index];
+        MeshRenderer* mr = d.group >= 0 ? instancer_.GetGroupRenderer(d.group) : d.renderer;
+        if (!anyBound || mr->shader_.get() != bound) {
+            mr->BindShader();
+            bound = mr->shader_.get();
+            anyBound = true;
+        } else {
+            stats.bindsAvoided++;
+        }
+        if (mr->alpha_ != alpha) {
+            alpha = mr->alpha_;
+            gfx.SetBlendAlpha(alpha);
+            stats.blendChanges++;
+        }
+        if (d.group >= 0) instancer_.DrawGroup(gfx, d.group, light);
+        else mr->Draw();
+    }
+    if (alpha != 255) gfx.SetBlendAlpha(255);
+    stats.shaderBinds = (int)(Shader::GetBindCount() - bindsBefore);
+    renderStats_.shaderBinds = stats.shaderBinds;
+    renderStats_.shaderBindsAvoided = stats.bindsAvoided;
+    renderStats_.blendChanges = stats.blendChanges;
+}
+
+void Scene::EndCulling() {
+    for (MeshRenderer* mr : cullRenderers_) mr->culled_ = mr->queued_ = false;
+}
+
+void Scene::ScreenPointToRay3D(float px, float py, int width, int height, const Camera3D& cam,
+                               float& ox, float& oy, float& oz, float& dirX, float& dirY, float& dirZ) const {
+    // same eye placement as RenderToTarget3D (left-handed, Y up, vertical fov)
+    Camera3D c = ResolveCamera3D(cam);
+    float radYaw = c.yaw * 3.14159265f / 180.0f;
+    float radPitch = c.pitch * 3.14159265f / 180.0f;
+    ox = c.x + cosf(radYaw) * cosf(radPitch) * c.distance;
+    oy = c.y + sinf(radPitch) * c.distance;
+    oz = c.z + sinf(radYaw) * cosf(radPitch) * c.distance;
+    float f[3] = { c.x - ox, c.y - oy, c.z - oz };
+    float fl = sqrtf(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+    if (fl <= 0.0f) { f[0] = 0; f[1] = 0; f[2] = 1; fl = 1; }
+    f[0] /= fl; f[1] /= fl; f[2] /= fl;
+    // right = up x forward, up' = forward x right
+    float r[3] = { f[2], 0.0f, -f[0] };
+    float rl = sqrtf(r[0] * r[0] + r[2] * r[2]);
+    if (rl <= 1e-6f) { r[0] = 1; r[2] = 0; rl = 1; }
+    r[0] /= rl; r[2] /= rl;
+    float u[3] = { f[1] * r[2] - f[2] * r[1], f[2] * r[0] - f[0] * r[2], f[0] * r[1] - f[1] * r[0] };
+
+    float tanHalf = tanf(c.fov * 3.14159265f / 360.0f);
+    float aspect = height > 0 ? (float)width / (float)height : 1.0f;
+    float sx = (2.0f * px / (float)width - 1.0f) * tanHalf * aspect;
+    float sy = (1.0f - 2.0f * py / (float)height) * tanHalf;
+    dirX = f[0] + r[0] * sx + u[0] * sy;
+    dirY = f[1] + r[1] * sx + u[1] * sy;
+    dirZ = f[2] + r[2] * sx + u[2] * sy;
+    float dl = sqrtf(dirX * dirX + dirY * dirY + dirZ * dirZ);
+    dirX /= dl; dirY /= dl; dirZ /= dl;
+}
+
 int Scene::RenderToTarget(int width, int height) {
     if (renderMode == RenderMode::Mode2D) return RenderToTarget(width, height, camera);
     return RenderToTarget3D(width, height, camera3D);
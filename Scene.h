@@ -2,10 +2,19 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include "GameObject.h"
+#include "BroadPhase.h"
+#include "AABBTree.h"
+#include "FrustumCulling.h"
+#include "OcclusionCulling.h"
+#include "GPUInstanceDrawer.h"
+#include "RenderQueue.h"
 
 // Forward declare Collider as struct to match its definition in Collider.h
 struct Collider;
+struct MeshRenderer;
+class Shader;
 
 // Scene: GameObject collection and basic scene lifecycle
 class Scene {
@@ -84,6 +93,99 @@ public:
 
     bool showGrid = true;
 
+    // RenderToTarget3D skips MeshRenderers whose world bounds are outside the camera frustum
+    bool frustumCulling = true;
+    // Filled MeshRenderers that cover the most screen are rasterized into a small CPU depth buffer;
+    // frustum-visible meshes whose bounds are entirely behind it are skipped as well
+    struct OcclusionSettings {
+        bool enabled = true;
+        int bufferWidth = 256;                   // depth buffer height follows the target aspect
+        int maxOccluders = 32;
+        size_t occluderTriangleBudget = 100000;
+        float minOccluderSize = 0.05f;           // bounding radius / distance to the eye
+    } occlusion;
+    // MeshRenderers with an LOD chain draw the level matching their projected size (MeshLODChain)
+    struct LodSettings {
+        bool enabled = true;
+        float hysteresis = 0.15f; // fraction a size must pass a level threshold by before switching
+        float bias = 1.0f;        // scales projected sizes; below 1 switches to coarser levels sooner
+    } lod;
+    // Visible MeshRenderers sharing a mesh and material are drawn as one instanced draw (GPUInstanceDrawer)
+    bool gpuInstancing = true;
+    // Visible MeshRenderers (and instance groups) are drawn in RenderQueue key order: by layer, opaque
+    // before blended, opaque by material then near to far, blended far to near. Off: culling order.
+    bool sortRenderQueue = true;
+    struct RenderStats {
+        int meshesVisible = 0;
+        int meshesCulled = 0;          // outside the frustum
+        int meshesOccluded = 0;        // inside the frustum, hidden behind occluders
+        size_t trianglesVisible = 0;   // full-resolution triangles of the visible meshes
+        size_t trianglesCulled = 0;
+        size_t trianglesOccluded = 0;
+        int occluders = 0;
+        size_t occluderTriangles = 0;
+        double occlusionMs = 0.0;      // occluder rasterization + Hi-Z + tests
+        int meshesInstanced = 0;       // visible meshes drawn through GPUInstanceDrawer
+        int instanceGroups = 0;        // their draw calls
+        int meshesLodReduced = 0;      // visible meshes drawn with a simplified LOD level
+        size_t trianglesDrawn = 0;     // trianglesVisible after LOD selection
+        int queueItems = 0;            // render queue draws (instance groups count once)
+        int shaderBinds = 0;           // Shader::Bind calls while submitting the queue
+        int shaderBindsAvoided = 0;    // queue draws that reused the bound shader
+        int blendChanges = 0;
+        double queueMs = 0.0;          // key building + sort
+    };
+    // Counters of the last RenderToTarget3D
+    const RenderStats& GetRenderStats() const { return renderStats_; }
+
+    // Fixed-step physics: Update accumulates frame time and runs FixedUpdate + PhysicsStep
+    // in steps of 1/fixedHz. Rendering blends transforms between the last two steps.
+    struct FixedStepSettings {
+        float fixedHz = 60.0f;
+        int maxSubsteps = 5;     // spiral-of-death guard: time beyond this many steps is dropped
+        bool interpolate = true;
+    } fixedStep;
+
+    struct PhysicsStats {
+        int substepsLastFrame = 0;
+        int maxSubstepsSeen = 0;
+        long long totalSubsteps = 0;
+        int clampedFrames = 0;    // frames where the guard dropped time
+        float droppedTime = 0.0f; // total simulation time discarded by the guard (seconds)
+        float alpha = 0.0f;       // interpolation factor for the current frame
+    };
+    const PhysicsStats& GetPhysicsStats() const { return physicsStats_; }
+
+    // Scene queries over the colliders and mesh renderers of the active roots.
+    // Bounds live in an AABBTree that is refit on the first query after objects may have moved;
+    // mesh hits are refined with the mesh's triangle BVH.
+    enum QueryMask {
+        kQueryColliders2D = 1,
+        kQueryColliders3D = 2,
+        kQueryMeshes = 4,
+        kQueryPivots = 8, // object origins as points (editor picking of objects without colliders)
+        kQueryDefault = kQueryColliders2D | kQueryColliders3D | kQueryMeshes
+    };
+    struct RaycastHit {
+        GameObject* object = nullptr;
+        Component* component = nullptr; // the Collider3D or MeshRenderer that was hit
+        float distance = 0.0f;          // along the normalized ray direction
+        float pointX = 0, pointY = 0, pointZ = 0;
+        float normalX = 0, normalY = 0, normalZ = 0;
+        int triangle = -1;              // mesh triangle index for MeshRenderer hits
+    };
+    // Closest hit along the ray (2D colliders and pivots are flat and never hit)
+    bool Raycast(float ox, float oy, float oz, float dirX, float dirY, float dirZ, float maxDistance,
+                 RaycastHit& outHit, int mask = kQueryColliders3D | kQueryMeshes);
+    // Objects whose shapes contain / overlap the query, in root order without duplicates.
+    // 2D colliders are flat at the object's z: pass an unbounded z range for 2D queries.
+    void OverlapPoint(float x, float y, float z, std::vector<GameObject*>& out, int mask = kQueryDefault);
+    void OverlapBox(const Bounds3& box, std::vector<GameObject*>& out, int mask = kQueryDefault);
+
+    // World-space ray through a pixel of a width x height view rendered by RenderToTarget3D
+    void ScreenPointToRay3D(float px, float py, int width, int height, const Camera3D& cam,
+                            float& ox, float& oy, float& oz, float& dirX, float& dirY, float& dirZ) const;
+
     int RenderToTarget(int width, int height, const Camera2D& cam);
     int RenderToTarget3D(int width, int height, const Camera3D& cam);
     int RenderToTarget(int width, int height); // fallback that uses current renderMode
@@ -97,8 +199,96 @@ private:
     std::weak_ptr<GameObject> selected_;
 
     std::vector<Collider*> colliders_;
+    std::vector<uint64_t> colliderKeys_; // owner id << 32 | collider ordinal on the owner; unlike addresses never reused
     bool inPlayMode_ = false;
 
+    // physics state: overlap pairs of the current and previous step, sorted by (a, b)
+    BroadPhase2D broadPhase_;
+    std::vector<ColliderPair> overlapPairs_;
+    std::vector<ColliderPair> prevPairs_;
+    // continuous colliders (indices into colliders_) and their positions at the previous step
+    std::vector<uint32_t> continuous_;
+    std::vector<float> ccdPrevX_;
+    std::vector<float> ccdPrevY_;
+    std::vector<std::vector<ColliderPair>> ccdChunkPairs_;
+    // 3D colliders: proxies in a dynamic AABB tree (userData = index into colliders_)
+    AABBTree tree3D_;
+    std::vector<uint32_t> colliders3D_;
+    std::vector<int> proxies3D_;
+    std::vector<Bounds3> bounds3D_;
+    std::vector<float> prevCenter3D_; // xyz per 3D collider at the previous step
+    std::vector<std::vector<ColliderPair>> chunkPairs3D_;
+    // query index: one tree proxy per collider / mesh renderer / root pivot
+    struct QueryEntry {
+        GameObject* object;
+        Component* component;
+        int kind;      // QueryMask bit
+        uint32_t root; // root index, used to order results
+        int proxy;
+    };
+    AABBTree queryTree_;
+    std::vector<QueryEntry> queryEntries_;
+    std::vector<Bounds3> queryBounds_; // exact bounds per entry as of the last refit
+    std::unordered_map<const GameObject*, std::pair<uint32_t, uint32_t>> queryEntryRange_; // first entry, count
+    std::vector<GameObject*> queryMovedObjects_; // GameObject::TakeMoved scratch
+    std::vector<uint32_t> queryRefit_;           // entries of moved objects
+    bool queryEntriesDirty_ = true;
+    unsigned int queryComponentsVersion_ = 0; // GameObject::ComponentsVersion() the entries were built at
+    // per-frame culling state of RenderToTarget3D
+    RenderStats renderStats_;
+    std::vector<MeshRenderer*> cullRenderers_;
+    FrustumCulling::BoundsSoA cullBounds_;
+    std::vector<uint8_t> cullVisible_;
+    OcclusionCulling occlusion_;
+    GPUInstanceDrawer instancer_;
+    // one render queue entry: a renderer drawing itself, or an instance group (renderer unused)
+    struct QueuedDraw {
+        MeshRenderer* renderer;
+        int group;
+        float depth; // [0,1] between the near and far planes
+    };
+    RenderQueue renderQueue_;
+    std::vector<QueuedDraw> queuedDraws_;
+    std::vector<size_t> groupDraws_; // queuedDraws_ index of each instance group
+    std::unordered_map<const Shader*, uint32_t> materialIds_; // dense per-frame material ids
+    std::vector<size_t> occluderCandidates_;  // indices into cullRenderers_
+    std::vector<float> occluderScores_;
+    bool inPhysicsStep_ = false;
+    bool colliderListDirty_ = false;
+    unsigned int colliderComponentsVersion_ = 0; // GameObject::ComponentsVersion() colliders_ was built at
+
+    // transform snapshots of the roots before/after the last fixed step
+    struct PoseState {
+        int owner; // GameObject::id(); steps may add or remove roots between the two snapshots
+        float x, y, z;
+        float rotation, rotationX, rotationY, rotationZ;
+        float scaleX, scaleY, scaleZ;
+    };
+    float fixedAccumulator_ = 0.0f;
+    PhysicsStats physicsStats_;
+    std::vector<PoseState> prevPoses_;
+    std::vector<PoseState> currPoses_;
+    std::vector<char> poseBlended_;
+
     void RebuildColliderList();
     void PhysicsStep();
+    void SweepContinuous();
+    void FindOverlaps3D();
+    void SyncQueryIndex();
+    Bounds3 ComputeQueryBounds(const QueryEntry& e) const;
+    Camera3D ResolveCamera3D(const Camera3D& cam) const;
+    // Mark MeshRenderers outside the frustum as culled for this frame; undone by EndCulling
+    void CullMeshRenderers(const FrustumCulling::Frustum& frustum);
+    // Mark frustum-visible MeshRenderers hidden behind the largest filled meshes as culled
+    void OcclusionCullMeshRenderers(const float viewProj[4][4], float eyeX, float eyeY, float eyeZ, float aspect);
+    // Key and sort the visible MeshRenderers (instanceable ones through instancer_) and mark them
+    // queued_; undone by EndCulling
+    // (selecting each one's LOD level on the way)
+    void BuildRenderQueue(float eyeX, float eyeY, float eyeZ, float tanHalfFov);
+    void SubmitRenderQueue(RenderBackend& gfx);
+    void EndCulling();
+    void CapturePoses(std::vector<PoseState>& out);
+    // Swap the interpolated poses into the live transforms for drawing; undone by EndInterpolatedPoses
+    void BeginInterpolatedPoses();
+    void EndInterpolatedPoses();
 };
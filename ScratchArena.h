@@ -0,0 +1,81 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+// ScratchArena: bump allocator for per-frame temporary arrays (trivially copyable types; nothing is
+// constructed or destroyed). Blocks are kept between frames, so steady-state drawing allocates nothing.
+// Allocate inside a Scope; leaving the scope rewinds the arena to where the scope started.
+class ScratchArena {
+public:
+    static const size_t kAlignment = 32; // enough for AVX loads
+    static const size_t kMinBlockSize = 64 * 1024;
+
+    // One arena per thread, so jobs can use scratch memory without locking
+    static ScratchArena& ForThread() {
+        static thread_local ScratchArena arena;
+        return arena;
+    }
+
+    template<typename T>
+    T* Allocate(size_t count) { return static_cast<T*>(AllocateBytes(count * sizeof(T))); }
+
+    void* AllocateBytes(size_t bytes) {
+        bytes = (std::max<size_t>(bytes, 1) + kAlignment - 1) & ~(kAlignment - 1);
+        for (; block_ < blocks_.size(); ++block_, offset_ = 0) {
+            Block& b = blocks_[block_];
+            if (offset_ + bytes <= b.size) {
+                void* p = b.base + offset_;
+                offset_ += bytes;
+                used_ += bytes;
+                peak_ = std::max(peak_, used_);
+                return p;
+            }
+        }
+        // out of blocks: add one at least twice the size of the last
+        Block b;
+        const size_t minSize = kMinBlockSize;
+        b.size = std::max(bytes, std::max(minSize, blocks_.empty() ? 0 : blocks_.back().size * 2));
+        b.storage.reset(new unsigned char[b.size + kAlignment]);
+        b.base = b.storage.get() + ((kAlignment - ((uintptr_t)b.storage.get() & (kAlignment - 1))) & (kAlignment - 1));
+        capacity_ += b.size;
+        blocks_.push_back(std::move(b));
+        block_ = blocks_.size() - 1;
+        offset_ = bytes;
+        used_ += bytes;
+        peak_ = std::max(peak_, used_);
+        return blocks_.back().base;
+    }
+
+    struct Marker { size_t block, offset, used; };
+    Marker GetMarker() const { return { block_, offset_, used_ }; }
+    void Rewind(const Marker& m) { block_ = m.block; offset_ = m.offset; used_ = m.used; }
+    void Reset() { Rewind({ 0, 0, 0 }); }
+
+    class Scope {
+    public:
+        explicit Scope(ScratchArena& arena) : arena_(arena), marker_(arena.GetMarker()) {}
+        ~Scope() { arena_.Rewind(marker_); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        ScratchArena& arena_;
+        Marker marker_;
+    };
+
+    size_t GetUsed() const { return used_; }        // bytes handed out (including padding)
+    size_t GetPeak() const { return peak_; }        // largest GetUsed so far
+    size_t GetCapacity() const { return capacity_; }
+
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> storage;
+        unsigned char* base = nullptr; // storage aligned to kAlignment
+        size_t size = 0;
+    };
+    std::vector<Block> blocks_;
+    size_t block_ = 0, offset_ = 0;
+    size_t used_ = 0, peak_ = 0, capacity_ = 0;
+};
@@ -4,12 +4,39 @@
 #include "LabelComponent.h"
 #include "SpriteRenderer.h"
 #include "Collider.h"
+#include "Collider3D.h"
+#include "MeshRenderer.h"
 #include <fstream>
 #include <iostream>
+#include <cstdio>
+#if !defined(_MSC_VER)
+#define sscanf_s sscanf // lǂ܂Ȃ̂ sscanf Ɠ
+#endif
 
 // : ȈՎBT|[gR|[lĝݕۑ/B
 // tH[}bg͔ɒP: IuWFNgƂɖO, x,y, eR|[lǧ^ƃf[^
 
+namespace {
+    // POS3D:z,rotX,rotY,rotZ,scaleX,scaleY,scaleZ (files without it keep the defaults)
+    void ReadTransform3D(const char* s, Transform& t) {
+        float v[7];
+        if (sscanf_s(s, "%f,%f,%f,%f,%f,%f,%f", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6]) != 7) return;
+        t.z = v[0];
+        t.rotationX = v[1]; t.rotationY = v[2]; t.rotationZ = v[3];
+        t.scaleX = v[4]; t.scaleY = v[5]; t.scaleZ = v[6];
+    }
+
+    // MESH:color,wireframe,path (the path goes last since it may contain commas; empty = fallback cube)
+    void AddMeshRenderer(const char* s, GameObject& obj) {
+        int color = 0, wire = 1, n = 0;
+        if (sscanf_s(s, "%d,%d,%n", &color, &wire, &n) != 2 || n == 0) return;
+        std::string meshPath(s + n);
+        auto mr = meshPath.empty() ? obj.AddComponent<MeshRenderer>(color) : obj.AddComponent<MeshRenderer>(meshPath);
+        mr->color_ = color;
+        mr->wireframe_ = wire != 0;
+    }
+}
+
 bool Serializer::SaveScene(const std::string& path, const std::vector<std::shared_ptr<GameObject>>& roots) {
     std::ofstream ofs(path);
     if (!ofs) return false;
@@ -17,13 +44,20 @@ bool Serializer::SaveScene(const std::string& path, const std::vector<std::share
         ofs << "OBJ\n";
         ofs << "NAME:" << r->name() << "\n";
         ofs << "POS:" << r->transform().x << "," << r->transform().y << "\n";
+        const Transform& t = r->ctransform();
+        ofs << "POS3D:" << t.z << "," << t.rotationX << "," << t.rotationY << "," << t.rotationZ << ","
+            << t.scaleX << "," << t.scaleY << "," << t.scaleZ << "\n";
         for (auto& c : r->GetAllComponents()) {
             if (auto sc = std::dynamic_pointer_cast<SpriteRenderer>(c)) {
                 ofs << "SPRITE:" << sc->path_ << "\n";
             } else if (auto lb = std::dynamic_pointer_cast<LabelComponent>(c)) {
                 ofs << "LABEL:" << lb->text << "\n";
+            } else if (auto c3 = std::dynamic_pointer_cast<Collider3D>(c)) {
+                ofs << "COL3D:" << (int)c3->shape << "," << c3->width << "," << c3->height << "," << c3->depth << "," << c3->radius << "\n";
             } else if (auto col = std::dynamic_pointer_cast<Collider>(c)) {
-                ofs << "COL:" << col->width << "," << col->height << "\n";
+                ofs << "COL:" << col->width << "," << col->height << "," << (col->continuous ? 1 : 0) << "\n";
+            } else if (auto mr = std::dynamic_pointer_cast<MeshRenderer>(c)) {
+                ofs << "MESH:" << mr->color_ << "," << (mr->wireframe_ ? 1 : 0) << "," << mr->meshPath_ << "\n";
             }
         }
         ofs << "ENDOBJ\n";
@@ -53,16 +87,27 @@ bool Serializer::LoadScene(const std::string& path, std::vector<std::shared_ptr<
                 current->transform().x = x;
                 current->transform().y = y;
             }
+        } else if (line.rfind("POS3D:", 0) == 0) {
+            ReadTransform3D(line.c_str() + 6, current->transform());
+        } else if (line.rfind("MESH:", 0) == 0) {
+            AddMeshRenderer(line.c_str() + 5, *current);
         } else if (line.rfind("SPRITE:", 0) == 0) {
             auto p = line.substr(7);
             current->AddComponent<SpriteRenderer>(p);
         } else if (line.rfind("LABEL:", 0) == 0) {
             auto t = line.substr(6);
             current->AddComponent<LabelComponent>(t);
+        } else if (line.rfind("COL3D:", 0) == 0) {
+            int shape=0; float w=0,h=0,d=0,r=0;
+            if (sscanf_s(line.c_str()+6, "%d,%f,%f,%f,%f", &shape, &w, &h, &d, &r) == 5) {
+                auto c3 = current->AddComponent<Collider3D>(w,h,d,(Collider3D::Shape)shape);
+                c3->radius = r;
+            }
         } else if (line.rfind("COL:", 0) == 0) {
-            float w=0,h=0;
-            if (sscanf_s(line.c_str()+4, "%f,%f", &w, &h) == 2) {
-                current->AddComponent<Collider>(w,h);
+            float w=0,h=0; int continuous=0; // files before the continuous flag have two fields
+            int fields = sscanf_s(line.c_str()+4, "%f,%f,%d", &w, &h, &continuous);
+            if (fields >= 2) {
+                current->AddComponent<Collider>(w,h)->continuous = fields == 3 && continuous != 0;
             }
         } else if (line == "ENDOBJ") {
             if (current) current->Awake();
@@ -78,13 +123,20 @@ bool Serializer::SavePrefab(const std::string& path, std::shared_ptr<GameObject>
     ofs << "PREFAB\n";
     ofs << "NAME:" << prefab->name() << "\n";
     ofs << "POS:" << prefab->transform().x << "," << prefab->transform().y << "\n";
+    const Transform& t = prefab->ctransform();
+    ofs << "POS3D:" << t.z << "," << t.rotationX << "," << t.rotationY << "," << t.rotationZ << ","
+        << t.scaleX << "," << t.scaleY << "," << t.scaleZ << "\n";
     for (auto& c : prefab->GetAllComponents()) {
         if (auto sc = std::dynamic_pointer_cast<SpriteRenderer>(c)) {
             ofs << "SPRITE:" << sc->path_ << "\n";
         } else if (auto lb = std::dynamic_pointer_cast<LabelComponent>(c)) {
             ofs << "LABEL:" << lb->text << "\n";
+        } else if (auto c3 = std::dynamic_pointer_cast<Collider3D>(c)) {
+            ofs << "COL3D:" << (int)c3->shape << "," << c3->width << "," << c3->height << "," << c3->depth << "," << c3->radius << "\n";
         } else if (auto col = std::dynamic_pointer_cast<Collider>(c)) {
-            ofs << "COL:" << col->width << "," << col->height << "\n";
+            ofs << "COL:" << col->width << "," << col->height << "," << (col->continuous ? 1 : 0) << "\n";
+        } else if (auto mr = std::dynamic_pointer_cast<MeshRenderer>(c)) {
+            ofs << "MESH:" << mr->color_ << "," << (mr->wireframe_ ? 1 : 0) << "," << mr->meshPath_ << "\n";
         }
     }
     ofs << "ENDPREFAB\n";
@@ -109,15 +161,28 @@ std::shared_ptr<GameObject> Serializer::LoadPrefab(const std::string& path) {
                     current->transform().y = y;
                 }
             }
+        } else if (line.rfind("POS3D:", 0) == 0) {
+            if (current) ReadTransform3D(line.c_str() + 6, current->transform());
+        } else if (line.rfind("MESH:", 0) == 0) {
+            if (current) AddMeshRenderer(line.c_str() + 5, *current);
         } else if (line.rfind("SPRITE:", 0) == 0) {
             if (current) current->AddComponent<SpriteRenderer>(line.substr(7));
         } else if (line.rfind("LABEL:", 0) == 0) {
             if (current) current->AddComponent<LabelComponent>(line.substr(6));
+        } else if (line.rfind("COL3D:", 0) == 0) {
+            if (current) {
+                int shape=0; float w=0,h=0,d=0,r=0;
+                if (sscanf_s(line.c_str()+6, "%d,%f,%f,%f,%f", &shape, &w, &h, &d, &r) == 5) {
+                    auto c3 = current->AddComponent<Collider3D>(w,h,d,(Collider3D::Shape)shape);
+                    c3->radius = r;
+                }
+            }
         } else if (line.rfind("COL:", 0) == 0) {
             if (current) {
-                float w=0,h=0;
-                if (sscanf_s(line.c_str()+4, "%f,%f", &w, &h) == 2) {
-                    current->AddComponent<Collider>(w,h);
+                float w=0,h=0; int continuous=0;
+                int fields = sscanf_s(line.c_str()+4, "%f,%f,%d", &w, &h, &continuous);
+                if (fields >= 2) {
+                    current->AddComponent<Collider>(w,h)->continuous = fields == 3 && continuous != 0;
                 }
             }
         } else if (line == "ENDPREFAB") {
@@ -8,8 +8,11 @@ bool Shader::Load(const std::string& vertexPath, const std::string& pixelPath) {
     return true;
 }
 
+size_t Shader::bindCount_ = 0;
+
 void Shader::Bind() {
     // no-op
+    ++bindCount_;
 }
 
 void Shader::SetFloat3(const std::string& name, float x, float y, float z) {
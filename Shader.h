@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <cstddef>
 
 // Lightweight shader abstraction ? currently a no-op wrapper around DxLib/placeholder.
 class Shader {
@@ -13,6 +14,9 @@ public:
     // Bind shader for rendering (no-op if unsupported)
     void Bind();
 
+    // Bind calls so far, over every shader (render-queue statistics)
+    static size_t GetBindCount() { return bindCount_; }
+
     // Set a float3 uniform (name-based; no-op fallback)
     void SetFloat3(const std::string& name, float x, float y, float z);
 
@@ -21,4 +25,7 @@ public:
 
     // Set a color/int uniform
     void SetInt(const std::string& name, int v);
+
+private:
+    static size_t bindCount_;
 };
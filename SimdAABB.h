@@ -0,0 +1,102 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define SIMDAABB_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMDAABB_SSE 1
+#endif
+
+// SimdAABB: 2D AABB boxes stored as separate min/max arrays (SoA) and a kernel that tests
+// one query box against 8 consecutive boxes at once, returning one bit per overlapping box.
+// Overlap is inclusive on the edges, the same rule as Collider::TestAABB.
+namespace SimdAABB {
+
+// Width of one OverlapMask8 batch; arrays are padded so a batch may start at any index < Size()
+const size_t kBatch = 8;
+
+struct AABBSoA {
+    std::vector<float> minX, minY, maxX, maxY;
+
+    size_t Size() const { return count_; }
+
+    // Resize to n boxes. The padding slots hold NaN boxes: every comparison with them is false, so they
+    // never overlap, not even an infinite query box.
+    void Resize(size_t n) {
+        count_ = n;
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        size_t padded = n + kBatch;
+        minX.assign(padded, nan); minY.assign(padded, nan);
+        maxX.assign(padded, nan); maxY.assign(padded, nan);
+    }
+
+    void Set(size_t i, float x0, float y0, float x1, float y1) {
+        minX[i] = x0; minY[i] = y0; maxX[i] = x1; maxY[i] = y1;
+    }
+
+private:
+    size_t count_ = 0;
+};
+
+// Reference implementation, also used when no SIMD instruction set is available
+inline uint32_t OverlapMask8Scalar(const AABBSoA& s, size_t first, float qMinX, float qMinY, float qMaxX, float qMaxY) {
+    uint32_t mask = 0;
+    for (size_t k = 0; k < kBatch; ++k) {
+        size_t i = first + k;
+        bool hit = s.minX[i] <= qMaxX && s.maxX[i] >= qMinX && s.minY[i] <= qMaxY && s.maxY[i] >= qMinY;
+        mask |= (uint32_t)hit << k;
+    }
+    return mask;
+}
+
+inline uint32_t OverlapMask8(const AABBSoA& s, size_t first, float qMinX, float qMinY, float qMaxX, float qMaxY) {
+#if defined(SIMDAABB_AVX)
+    __m256 hit = _mm256_cmp_ps(_mm256_loadu_ps(&s.minX[first]), _mm256_set1_ps(qMaxX), _CMP_LE_OQ);
+    hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_loadu_ps(&s.maxX[first]), _mm256_set1_ps(qMinX), _CMP_GE_OQ));
+    hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_loadu_ps(&s.minY[first]), _mm256_set1_ps(qMaxY), _CMP_LE_OQ));
+    hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_loadu_ps(&s.maxY[first]), _mm256_set1_ps(qMinY), _CMP_GE_OQ));
+    return (uint32_t)_mm256_movemask_ps(hit);
+#elif defined(SIMDAABB_SSE)
+    const __m128 qx0 = _mm_set1_ps(qMinX), qy0 = _mm_set1_ps(qMinY);
+    const __m128 qx1 = _mm_set1_ps(qMaxX), qy1 = _mm_set1_ps(qMaxY);
+    uint32_t mask = 0;
+    for (size_t h = 0; h < kBatch; h += 4) {
+        size_t i = first + h;
+        __m128 hit = _mm_cmple_ps(_mm_loadu_ps(&s.minX[i]), qx1);
+        hit = _mm_and_ps(hit, _mm_cmpge_ps(_mm_loadu_ps(&s.maxX[i]), qx0));
+        hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_loadu_ps(&s.minY[i]), qy1));
+        hit = _mm_and_ps(hit, _mm_cmpge_ps(_mm_loadu_ps(&s.maxY[i]), qy0));
+        mask |= (uint32_t)_mm_movemask_ps(hit) << h;
+    }
+    return mask;
+#else
+    return OverlapMask8Scalar(s, first, qMinX, qMinY, qMaxX, qMaxY);
+#endif
+}
+
+// Index of the lowest set bit (mask must be non-zero)
+inline unsigned LowestBit(uint32_t mask) {
+    unsigned k = 0;
+    while (((mask >> k) & 1u) == 0) ++k;
+    return k;
+}
+
+// Call fn(index) for every box in [0, Size()) that contains the point (px, py)
+template<typename Fn>
+inline void QueryPoint(const AABBSoA& s, float px, float py, Fn&& fn) {
+    for (size_t first = 0; first < s.Size(); first += kBatch) {
+        uint32_t mask = OverlapMask8(s, first, px, py, px, py);
+        while (mask) {
+            unsigned k = LowestBit(mask);
+            mask &= mask - 1;
+            fn(first + k);
+        }
+    }
+}
+
+} // namespace SimdAABB
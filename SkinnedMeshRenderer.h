@@ -1,11 +1,16 @@
 #pragma once
 #include "Component.h"
 #include "Mesh.h"
-#include "DxLib.h"
+#include "VectorMath.h"
 #include <memory>
 #include <string>
 #include <vector>
 #include "ObjSequenceLoader.h"
+#include "MeshCache.h"
+#include "MeshPacking.h"
+#include "JobSystem.h"
+#include "VertexTransform.h"
+#include "RenderBackend.h"
 
 // SkinnedMeshRenderer: performs CPU skinning and simple animation playback
 struct SkinnedMeshRenderer : public Component {
@@ -16,8 +21,8 @@ struct SkinnedMeshRenderer : public Component {
 
     void Awake() override {
         if (!meshPath_.empty()) {
-            // try ModelLoader first
-            mesh_ = ModelLoader::LoadModel(meshPath_);
+            // try the model importer first (shared through the MeshCache)
+            mesh_ = MeshCache::Instance().Get(meshPath_);
             if (!mesh_) {
                 // maybe it's an OBJ sequence: not loaded here
             }
@@ -40,14 +45,24 @@ struct SkinnedMeshRenderer : public Component {
             int fc = morphSeq_->FrameCount();
             f0 = ((f0 % fc) + fc) % fc;
             f1 = ((f1 % fc) + fc) % fc;
-            morphVertices_.resize(morphSeq_->VertexCount());
-            for (size_t i = 0; i < morphSeq_->VertexCount(); ++i) {
-                VECTOR a = morphSeq_->frames[f0][i];
-                VECTOR b = morphSeq_->frames[f1][i];
-                morphVertices_[i].x = (float)(a.x * (1.0 - alpha) + b.x * alpha);
-                morphVertices_[i].y = (float)(a.y * (1.0 - alpha) + b.y * alpha);
-                morphVertices_[i].z = (float)(a.z * (1.0 - alpha) + b.z * alpha);
+            // decoded on demand from the compressed frames, or read ahead of f0 when streamed
+            morphSeq_->SetCursor(f0);
+            const VECTOR* frame0 = morphSeq_->GetFrame(f0);
+            const VECTOR* frame1 = morphSeq_->GetFrame(f1);
+            if (!frame0) {
+                // still streaming in: hold the last pose (and the clock) until it arrives; skip unreadable frames
+                if (!morphSeq_->IsPending(f0)) time += Time::deltaTime;
+                return;
             }
+            if (!frame1) { frame1 = frame0; alpha = 0.0; }
+            // fp32 SIMD blend into the persistent buffer, split across the job pool for large meshes
+            const size_t n = morphSeq_->VertexCount();
+            if (morphVertices_.size() != n) morphVertices_.resize(n);
+            const float blend = (float)alpha;
+            VECTOR* out = morphVertices_.data();
+            JobSystem::Instance().ParallelFor(n, VertexTransform::kVerticesPerJob, [&](size_t begin, size_t end, int) {
+                VertexTransform::LerpPositions(frame0 + begin, frame1 + begin, blend, end - begin, out + begin);
+            });
             time += Time::deltaTime;
         }
         // skinning mode left as-is (placeholder)
@@ -55,36 +70,46 @@ struct SkinnedMeshRenderer : public Component {
 
     void Render() override {
         if (!owner) return;
-        const auto* vertsPtr = (mode == Mode::Morph && !morphVertices_.empty()) ? &morphVertices_ : nullptr;
-        if (mode == Mode::Skinning) {
-            // not implemented fully here
-            vertsPtr = &mesh_->vertices;
+        ScratchArena& arena = ScratchArena::ForThread();
+        ScratchArena::Scope scope(arena);
+        const VECTOR* verts = nullptr;
+        const int* indices = nullptr;
+        size_t indexCount = 0;
+        if (mode == Mode::Morph && morphSeq_ && !morphVertices_.empty()) {
+            verts = morphVertices_.data();
+            indices = morphSeq_->indices.data();
+            indexCount = morphSeq_->indices.size();
+        } else if (mode == Mode::Skinning && mesh_) {
+            // not implemented fully here: draws the bind pose. Packed meshes are decoded into the arena
+            verts = MeshPacking::GetPositions(*mesh_, arena);
+            indices = MeshPacking::GetIndices(*mesh_, arena);
+            indexCount = mesh_->TriangleCount() * 3;
         }
-        if (!vertsPtr) return;
-        const auto& verts = *vertsPtr;
-        float tx = owner->transform().x;
-        float ty = owner->transform().y;
-        float tz = owner->transform().z;
-        float sx = owner->transform().scaleX;
-        float sy = owner->transform().scaleY;
-        float sz = owner->transform().scaleZ;
-        for (size_t i = 0; i + 2 < morphSeq_->indices.size(); i += 3) {
-            VECTOR v0 = verts[morphSeq_->indices[i + 0]];
-            VECTOR v1 = verts[morphSeq_->indices[i + 1]];
-            VECTOR v2 = verts[morphSeq_->indices[i + 2]];
-            v0.x = v0.x * sx + tx; v0.y = v0.y * sy + ty; v0.z = v0.z * sz + tz;
-            v1.x = v1.x * sx + tx; v1.y = v1.y * sy + ty; v1.z = v1.z * sz + tz;
-            v2.x = v2.x * sx + tx; v2.y = v2.y * sy + ty; v2.z = v2.z * sz + tz;
-            DrawLine3D(v0, v1, GetColor(200,200,200));
-            DrawLine3D(v1, v2, GetColor(200,200,200));
-            DrawLine3D(v2, v0, GetColor(200,200,200));
+        if (!verts || !indices) return;
+        float tx = owner->ctransform().x;
+        float ty = owner->ctransform().y;
+        float tz = owner->ctransform().z;
+        float sx = owner->ctransform().scaleX;
+        float sy = owner->ctransform().scaleY;
+        float sz = owner->ctransform().scaleZ;
+        RenderBackend& gfx = RenderBackend::Current();
+        const unsigned int color = 0xC8C8C8;
+        for (size_t i = 0; i + 2 < indexCount; i += 3) {
+            float v[3][3];
+            for (int k = 0; k < 3; ++k) {
+                const VECTOR& p = verts[indices[i + k]];
+                v[k][0] = p.x * sx + tx; v[k][1] = p.y * sy + ty; v[k][2] = p.z * sz + tz;
+            }
+            gfx.DrawLine3D(v[0], v[1], color);
+            gfx.DrawLine3D(v[1], v[2], color);
+            gfx.DrawLine3D(v[2], v[0], color);
         }
     }
 
     void PlayMorph(float startTime = 0.0f) { time = startTime; }
 
     std::string meshPath_;
-    std::shared_ptr<Mesh> mesh_;
+    std::shared_ptr<const Mesh> mesh_;
     int currentAnim;
     double time;
     Mode mode;
@@ -0,0 +1,663 @@
+#include "SoftwareRasterizer.h"
+#include "JobSystem.h"
+#include "FrustumCulling.h"
+#include "third_party/miniz/miniz.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+    const size_t kSetupBatch = 2048;  // triangles per setup job
+    const size_t kBinBatch = 4096;    // primitives per binning job
+
+    int64_t NowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    double MsSince(int64_t start) { return (NowNs() - start) / 1.0e6; }
+
+    int ClampByte(float v) {
+        int i = (int)(v + 0.5f);
+        return i < 0 ? 0 : (i > 255 ? 255 : i);
+    }
+
+    // 0xRRGGBB source over destination with coverage a (0-255)
+    unsigned int Blend(unsigned int s, unsigned int d, unsigned int a) {
+        unsigned int r = (((s >> 16) & 0xFF) * a + ((d >> 16) & 0xFF) * (255 - a)) / 255;
+        unsigned int g = (((s >> 8) & 0xFF) * a + ((d >> 8) & 0xFF) * (255 - a)) / 255;
+        unsigned int b = ((s & 0xFF) * a + (d & 0xFF) * (255 - a)) / 255;
+        return (r << 16) | (g << 8) | b;
+    }
+
+    void PutBE32(std::vector<unsigned char>& out, uint32_t v) {
+        out.push_back((unsigned char)(v >> 24));
+        out.push_back((unsigned char)(v >> 16));
+        out.push_back((unsigned char)(v >> 8));
+        out.push_back((unsigned char)v);
+    }
+
+    void PutChunk(std::vector<unsigned char>& png, const char type[4], const std::vector<unsigned char>& data) {
+        PutBE32(png, (uint32_t)data.size());
+        size_t start = png.size();
+        png.insert(png.end(), type, type + 4);
+        png.insert(png.end(), data.begin(), data.end());
+        PutBE32(png, (uint32_t)mz_crc32(MZ_CRC32_INIT, &png[start], png.size() - start));
+    }
+
+    uint32_t GetBE32(const unsigned char* p) {
+        return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+    }
+
+    bool ReadToken(std::istream& in, std::string& tok) {
+        tok.clear();
+        int c;
+        while ((c = in.get()) != EOF) {
+            if (c == '#') { while ((c = in.get()) != EOF && c != '\n') {} continue; }
+            if (isspace(c)) { if (!tok.empty()) return true; continue; }
+            tok.push_back((char)c);
+        }
+        return !tok.empty();
+    }
+}
+
+SoftwareRasterizer::SoftwareRasterizer(int tileSize) : tileSize_(tileSize < 8 ? 8 : tileSize) {}
+
+int SoftwareRasterizer::BeginTarget(int width, int height) {
+    if (width <= 0 || height <= 0) return 0;
+    frameStart_ = NowNs();
+    width_ = width;
+    height_ = height;
+    tilesX_ = (width + tileSize_ - 1) / tileSize_;
+    tilesY_ = (height + tileSize_ - 1) / tileSize_;
+    color_.resize((size_t)width * height);
+    depth_.resize((size_t)width * height);
+    tris_.clear();
+    lines_.clear();
+    prims2D_.clear();
+    order_.clear();
+    stats_ = Stats();
+    stats_.tiles = tilesX_ * tilesY_;
+    blendAlpha_ = 255;
+    inTarget_ = true;
+    return 1;
+}
+
+void SoftwareRasterizer::SetCamera(float eyeX, float eyeY, float eyeZ, float targetX, float targetY, float targetZ, float fovY) {
+    float aspect = height_ > 0 ? (float)width_ / (float)height_ : 1.0f;
+    FrustumCulling::BuildViewProjection(viewProj_, eyeX, eyeY, eyeZ, targetX, targetY, targetZ, fovY, aspect, near_, far_);
+}
+
+SoftwareRasterizer::ClipVertex SoftwareRasterizer::Transform(float x, float y, float z, unsigned int color) const {
+    const float (*m)[4] = viewProj_;
+    ClipVertex v;
+    v.x = m[0][0] * x + m[0][1] * y + m[0][2] * z + m[0][3];
+    v.y = m[1][0] * x + m[1][1] * y + m[1][2] * z + m[1][3];
+    v.z = m[2][0] * x + m[2][1] * y + m[2][2] * z + m[2][3];
+    v.w = m[3][0] * x + m[3][1] * y + m[3][2] * z + m[3][3];
+    v.r = (float)((color >> 16) & 0xFF);
+    v.g = (float)((color >> 8) & 0xFF);
+    v.b = (float)(color & 0xFF);
+    return v;
+}
+
+bool SoftwareRasterizer::FinishTri(const ClipVertex& a, const ClipVertex& b, const ClipVertex& c, Tri& t) const {
+    const ClipVertex* v[3] = { &a, &b, &c };
+    for (int i = 0; i < 3; ++i) {
+        float iw = 1.0f / v[i]->w;
+        t.x[i] = (v[i]->x * iw * 0.5f + 0.5f) * width_;
+        t.y[i] = (0.5f - v[i]->y * iw * 0.5f) * height_;
+        t.z[i] = v[i]->z * iw;
+        t.iw[i] = iw;
+        t.rgb[i][0] = v[i]->r * iw;
+        t.rgb[i][1] = v[i]->g * iw;
+        t.rgb[i][2] = v[i]->b * iw;
+    }
+    if (t.z[0] > 1.0f && t.z[1] > 1.0f && t.z[2] > 1.0f) return false; // beyond the far plane
+    float area = (t.x[1] - t.x[0]) * (t.y[2] - t.y[0]) - (t.y[1] - t.y[0]) * (t.x[2] - t.x[0]);
+    if (area == 0.0f || !std::isfinite(area)) return false;
+    if (area < 0.0f) {
+        // keep one winding so the edge functions are positive inside
+        std::swap(t.x[1], t.x[2]); std::swap(t.y[1], t.y[2]); std::swap(t.z[1], t.z[2]);
+        std::swap(t.iw[1], t.iw[2]);
+        for (int k = 0; k < 3; ++k) std::swap(t.rgb[1][k], t.rgb[2][k]);
+    }
+    float minX = std::min(t.x[0], std::min(t.x[1], t.x[2]));
+    float maxX = std::max(t.x[0], std::max(t.x[1], t.x[2]));
+    float minY = std::min(t.y[0], std::min(t.y[1], t.y[2]));
+    float maxY = std::max(t.y[0], std::max(t.y[1], t.y[2]));
+    // pixels whose centers can be covered
+    t.minX = std::max(0, (int)ceilf(minX - 0.5f));
+    t.minY = std::max(0, (int)ceilf(minY - 0.5f));
+    t.maxX = std::min(width_ - 1, (int)floorf(maxX - 0.5f));
+    t.maxY = std::min(height_ - 1, (int)floorf(maxY - 0.5f));
+    return t.minX <= t.maxX && t.minY <= t.maxY;
+}
+
+void SoftwareRasterizer::SetupTriangle(const ClipVertex in[3], std::vector<Tri>& out) const {
+    // clip against the near plane (z >= 0 in clip space); the far plane is left to the depth test
+    bool inside0 = in[0].z >= 0.0f, inside1 = in[1].z >= 0.0f, inside2 = in[2].z >= 0.0f;
+    Tri t;
+    if (inside0 && inside1 && inside2) {
+        if (FinishTri(in[0], in[1], in[2], t)) out.push_back(t);
+        return;
+    }
+    if (!inside0 && !inside1 && !inside2) return;
+    ClipVertex poly[4];
+    int n = 0;
+    for (int i = 0; i < 3; ++i) {
+        const ClipVertex& a = in[i];
+        const ClipVertex& b = in[(i + 1) % 3];
+        bool ia = a.z >= 0.0f, ib = b.z >= 0.0f;
+        if (ia) poly[n++] = a;
+        if (ia != ib) {
+            float s = a.z / (a.z - b.z);
+            ClipVertex m;
+            m.x = a.x + (b.x - a.x) * s;
+            m.y = a.y + (b.y - a.y) * s;
+            m.z = 0.0f;
+            m.w = a.w + (b.w - a.w) * s;
+            m.r = a.r + (b.r - a.r) * s;
+            m.g = a.g + (b.g - a.g) * s;
+            m.b = a.b + (b.b - a.b) * s;
+            poly[n++] = m;
+        }
+    }
+    for (int i = 1; i + 1 < n; ++i)
+        if (FinishTri(poly[0], poly[i], poly[i + 1], t)) out.push_back(t);
+}
+
+bool SoftwareRasterizer::ToScreen(const ClipVertex& a0, const ClipVertex& b0, Line& l) const {
+    ClipVertex a = a0, b = b0;
+    if (a.z < 0.0f && b.z < 0.0f) return false;
+    if (a.z < 0.0f || b.z < 0.0f) {
+        float s = a.z / (a.z - b.z);
+        ClipVertex m;
+        m.x = a.x + (b.x - a.x) * s;
+        m.y = a.y + (b.y - a.y) * s;
+        m.z = 0.0f;
+        m.w = a.w + (b.w - a.w) * s;
+        if (a.z < 0.0f) a = m; else b = m;
+    }
+    float ia = 1.0f / a.w, ib = 1.0f / b.w;
+    l.x0 = (a.x * ia * 0.5f + 0.5f) * width_;
+    l.y0 = (0.5f - a.y * ia * 0.5f) * height_;
+    l.z0 = a.z * ia;
+    l.x1 = (b.x * ib * 0.5f + 0.5f) * width_;
+    l.y1 = (0.5f - b.y * ib * 0.5f) * height_;
+    l.z1 = b.z * ib;
+    if (!std::isfinite(l.x0 + l.y0 + l.x1 + l.y1)) return false;
+    l.minX = std::max(0, (int)floorf(std::min(l.x0, l.x1)));
+    l.minY = std::max(0, (int)floorf(std::min(l.y0, l.y1)));
+    l.maxX = std::min(width_ - 1, (int)floorf(std::max(l.x0, l.x1)));
+    l.maxY = std::min(height_ - 1, (int)floorf(std::max(l.y0, l.y1)));
+    return l.minX <= l.maxX && l.minY <= l.maxY;
+}
+
+void SoftwareRasterizer::AddLine(const float a[3], const float b[3], unsigned int color) {
+    Line l;
+    l.color = color & 0xFFFFFF;
+    l.alpha = blendAlpha_;
+    if (ToScreen(Transform(a[0], a[1], a[2], 0), Transform(b[0], b[1], b[2], 0), l)) {
+        order_.push_back(kLine | (uint32_t)lines_.size());
+        lines_.push_back(l);
+    }
+    stats_.lines++;
+}
+
+void SoftwareRasterizer::SetBlendAlpha(int alpha) {
+    blendAlpha_ = std::min(255, std::max(0, alpha));
+}
+
+void SoftwareRasterizer::DrawLine3D(const float a[3], const float b[3], unsigned int color) {
+    if (!inTarget_) return;
+    int64_t start = NowNs();
+    AddLine(a, b, color);
+    stats_.setupMs += MsSince(start);
+}
+
+void SoftwareRasterizer::DrawLines3D(const RenderVertex* vertices, size_t count) {
+    if (!inTarget_) return;
+    int64_t start = NowNs();
+    for (size_t i = 0; i + 1 < count; i += 2) {
+        const RenderVertex* v = vertices + i;
+        float a[3] = { v[0].x, v[0].y, v[0].z }, b[3] = { v[1].x, v[1].y, v[1].z };
+        AddLine(a, b, v[0].color);
+    }
+    stats_.setupMs += MsSince(start);
+}
+
+void SoftwareRasterizer::DrawInstances3D(const InstanceGeometry& geometry, const InstanceData* instances, size_t count, const InstanceLight& light) {
+    if (!inTarget_) return;
+    stats_.instancedDraws++;
+    stats_.instances += count;
+    // expanded on the CPU like the DxLib path; the lines / triangles land in the stats above
+    RenderBackend::DrawInstances3D(geometry, instances, count, light);
+}
+
+void SoftwareRasterizer::DrawTriangles3D(const RenderVertex* vertices, size_t count, bool wireframe) {
+    if (!inTarget_) return;
+    size_t triCount = count / 3;
+    int64_t start = NowNs();
+    stats_.trianglesSubmitted += triCount;
+    if (wireframe) {
+        for (size_t i = 0; i < triCount; ++i) {
+            const RenderVertex* v = vertices + i * 3;
+            float p[3][3] = { { v[0].x, v[0].y, v[0].z }, { v[1].x, v[1].y, v[1].z }, { v[2].x, v[2].y, v[2].z } };
+            AddLine(p[0], p[1], v[0].color);
+            AddLine(p[1], p[2], v[0].color);
+            AddLine(p[2], p[0], v[0].color);
+        }
+        stats_.setupMs += MsSince(start);
+        return;
+    }
+    JobSystem& jobs = JobSystem::Instance();
+    int chunks = jobs.ChunkCount(triCount, kSetupBatch);
+    if ((int)setupChunks_.size() < chunks) setupChunks_.resize(chunks);
+    jobs.ParallelFor(triCount, kSetupBatch, [&](size_t begin, size_t end, int chunk) {
+        std::vector<Tri>& out = setupChunks_[chunk];
+        out.clear();
+        for (size_t i = begin; i < end; ++i) {
+            const RenderVertex* v = vertices + i * 3;
+            ClipVertex c[3] = { Transform(v[0].x, v[0].y, v[0].z, v[0].color),
+                                Transform(v[1].x, v[1].y, v[1].z, v[1].color),
+                                Transform(v[2].x, v[2].y, v[2].z, v[2].color) };
+            SetupTriangle(c, out);
+        }
+    });
+    // append in chunk order so primitive order matches submission order
+    for (int c = 0; c < chunks; ++c) {
+        for (const Tri& t : setupChunks_[c]) {
+            order_.push_back(kTri | (uint32_t)tris_.size());
+            tris_.push_back(t);
+            tris_.back().alpha = blendAlpha_;
+        }
+    }
+    stats_.setupMs += MsSince(start);
+}
+
+void SoftwareRasterizer::AddPrim2D(const Prim2D& p) {
+    stats_.primitives2D++;
+    if (p.minX > p.maxX || p.minY > p.maxY) return;
+    order_.push_back(kPrim2D | (uint32_t)prims2D_.size());
+    prims2D_.push_back(p);
+}
+
+void SoftwareRasterizer::DrawBox(int x0, int y0, int x1, int y1, unsigned int color, bool fill) {
+    if (!inTarget_) return;
+    Prim2D p;
+    p.kind = Prim2D::Kind::Box;
+    p.x0 = std::min(x0, x1); p.y0 = std::min(y0, y1);
+    p.x1 = std::max(x0, x1); p.y1 = std::max(y0, y1);
+    p.color = color & 0xFFFFFF;
+    p.fill = fill;
+    p.texture = -1;
+    p.minX = std::max(0, p.x0); p.minY = std::max(0, p.y0);
+    p.maxX = std::min(width_ - 1, p.x1 - 1); p.maxY = std::min(height_ - 1, p.y1 - 1);
+    AddPrim2D(p);
+}
+
+void SoftwareRasterizer::DrawCircle(int x, int y, int r, unsigned int color, bool fill) {
+    if (!inTarget_ || r < 0) return;
+    Prim2D p;
+    p.kind = Prim2D::Kind::Circle;
+    p.x0 = x; p.y0 = y; p.x1 = r; p.y1 = 0;
+    p.color = color & 0xFFFFFF;
+    p.fill = fill;
+    p.texture = -1;
+    p.minX = std::max(0, x - r); p.minY = std::max(0, y - r);
+    p.maxX = std::min(width_ - 1, x + r); p.maxY = std::min(height_ - 1, y + r);
+    AddPrim2D(p);
+}
+
+int SoftwareRasterizer::LoadTexture(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return -1;
+    Texture tex;
+    std::string magic, tw, th, tmax;
+    if (ReadToken(in, magic) && (magic == "P6" || magic == "P5") &&
+        ReadToken(in, tw) && ReadToken(in, th) && ReadToken(in, tmax)) {
+        int w = atoi(tw.c_str()), h = atoi(th.c_str()), maxv = atoi(tmax.c_str());
+        int channels = magic == "P6" ? 3 : 1;
+        if (w <= 0 || h <= 0 || maxv <= 0 || maxv > 255) return -1;
+        std::vector<unsigned char> data((size_t)w * h * channels);
+        if (!in.read((char*)data.data(), data.size())) return -1;
+        tex.width = w;
+        tex.height = h;
+        tex.argb.resize((size_t)w * h);
+        for (size_t i = 0; i < tex.argb.size(); ++i) {
+            const unsigned char* p = &data[i * channels];
+            unsigned int r = p[0] * 255 / maxv;
+            unsigned int g = p[channels == 3 ? 1 : 0] * 255 / maxv;
+            unsigned int b = p[channels == 3 ? 2 : 0] * 255 / maxv;
+            tex.argb[i] = 0xFF000000u | (r << 16) | (g << 8) | b;
+        }
+    } else {
+        // no decoder for this format here: placeholder checker keeps the sprite's footprint visible
+        tex.width = tex.height = 32;
+        tex.argb.resize(32 * 32);
+        for (int y = 0; y < 32; ++y)
+            for (int x = 0; x < 32; ++x)
+                tex.argb[y * 32 + x] = ((x / 8 + y / 8) & 1) ? 0xFFFF00FFu : 0xFF000000u;
+    }
+    tex.alive = true;
+    for (size_t i = 0; i < textures_.size(); ++i) {
+        if (!textures_[i].alive) { textures_[i] = std::move(tex); return (int)i; }
+    }
+    textures_.push_back(std::move(tex));
+    return (int)textures_.size() - 1;
+}
+
+void SoftwareRasterizer::DeleteTexture(int handle) {
+    if (handle < 0 || handle >= (int)textures_.size()) return;
+    textures_[handle] = Texture();
+}
+
+void SoftwareRasterizer::DrawTexture(int x, int y, int handle) {
+    if (!inTarget_ || handle < 0 || handle >= (int)textures_.size() || !textures_[handle].alive) return;
+    const Texture& tex = textures_[handle];
+    Prim2D p;
+    p.kind = Prim2D::Kind::Texture;
+    p.x0 = x; p.y0 = y; p.x1 = x + tex.width; p.y1 = y + tex.height;
+    p.color = 0;
+    p.fill = true;
+    p.texture = handle;
+    p.minX = std::max(0, x); p.minY = std::max(0, y);
+    p.maxX = std::min(width_ - 1, p.x1 - 1); p.maxY = std::min(height_ - 1, p.y1 - 1);
+    AddPrim2D(p);
+}
+
+void SoftwareRasterizer::EndTarget() {
+    if (!inTarget_) return;
+    inTarget_ = false;
+    JobSystem& jobs = JobSystem::Instance();
+    const int tileCount = tilesX_ * tilesY_;
+
+    // bin: each job walks a contiguous slice of order_ and fills its own row of bins,
+    // so concatenating the rows per tile restores submission order
+    int64_t start = NowNs();
+    binChunks_ = std::max(1, jobs.ChunkCount(order_.size(), kBinBatch));
+    if (bins_.size() < (size_t)binChunks_ * tileCount) bins_.resize((size_t)binChunks_ * tileCount);
+    for (size_t i = 0; i < (size_t)binChunks_ * tileCount; ++i) bins_[i].clear();
+    const int ts = tileSize_;
+    jobs.ParallelFor(order_.size(), kBinBatch, [&](size_t begin, size_t end, int chunk) {
+        std::vector<uint32_t>* row = &bins_[(size_t)chunk * tileCount];
+        for (size_t i = begin; i < end; ++i) {
+            uint32_t id = order_[i];
+            uint32_t index = id & ~kKindMask;
+            int minX, minY, maxX, maxY;
+            switch (id & kKindMask) {
+            case kTri: { const Tri& t = tris_[index]; minX = t.minX; minY = t.minY; maxX = t.maxX; maxY = t.maxY; break; }
+            case kLine: { const Line& l = lines_[index]; minX = l.minX; minY = l.minY; maxX = l.maxX; maxY = l.maxY; break; }
+            default: { const Prim2D& p = prims2D_[index]; minX = p.minX; minY = p.minY; maxX = p.maxX; maxY = p.maxY; break; }
+            }
+            for (int ty = minY / ts; ty <= maxY / ts; ++ty)
+                for (int tx = minX / ts; tx <= maxX / ts; ++tx)
+                    row[ty * tilesX_ + tx].push_back(id);
+        }
+    });
+    stats_.binMs = MsSince(start);
+
+    start = NowNs();
+    tilePixels_.assign(tileCount, 0);
+    jobs.ParallelFor(tileCount, 1, [&](size_t begin, size_t end, int) {
+        for (size_t t = begin; t < end; ++t) RasterTile((int)t, tilePixels_[t]);
+    });
+    stats_.rasterMs = MsSince(start);
+
+    stats_.trianglesRasterized = tris_.size();
+    for (size_t px : tilePixels_) stats_.pixelsWritten += px;
+    stats_.frameMs = MsSince(frameStart_);
+}
+
+void SoftwareRasterizer::RasterTile(int tile, size_t& written) {
+    int x0 = (tile % tilesX_) * tileSize_;
+    int y0 = (tile / tilesX_) * tileSize_;
+    int x1 = std::min(width_, x0 + tileSize_);
+    int y1 = std::min(height_, y0 + tileSize_);
+    for (int y = y0; y < y1; ++y) {
+        std::fill(color_.begin() + (size_t)y * width_ + x0, color_.begin() + (size_t)y * width_ + x1, clearColor_);
+        std::fill(depth_.begin() + (size_t)y * width_ + x0, depth_.begin() + (size_t)y * width_ + x1, 1.0f);
+    }
+    const int tileCount = tilesX_ * tilesY_;
+    for (int c = 0; c < binChunks_; ++c) {
+        for (uint32_t id : bins_[(size_t)c * tileCount + tile]) {
+            uint32_t index = id & ~kKindMask;
+            switch (id & kKindMask) {
+            case kTri: RasterTri(tris_[index], x0, y0, x1, y1, written); break;
+            case kLine: RasterLine(lines_[index], x0, y0, x1, y1, written); break;
+            default: Raster2D(prims2D_[index], x0, y0, x1, y1, written); break;
+            }
+        }
+    }
+}
+
+void SoftwareRasterizer::RasterTri(const Tri& t, int tx0, int ty0, int tx1, int ty1, size_t& written) {
+    int bx0 = std::max(t.minX, tx0), bx1 = std::min(t.maxX, tx1 - 1);
+    int by0 = std::max(t.minY, ty0), by1 = std::min(t.maxY, ty1 - 1);
+    if (bx0 > bx1 || by0 > by1) return;
+
+    // edge i is opposite vertex i; E(p) = (b - a) x (p - a), positive inside
+    float ex[3], ey[3], ax[3], ay[3];
+    bool topLeft[3];
+    for (int i = 0; i < 3; ++i) {
+        int a = (i + 1) % 3, b = (i + 2) % 3;
+        ax[i] = t.x[a]; ay[i] = t.y[a];
+        ex[i] = t.x[b] - t.x[a];
+        ey[i] = t.y[b] - t.y[a];
+        topLeft[i] = ey[i] < 0.0f || (ey[i] == 0.0f && ex[i] > 0.0f);
+    }
+    float area = ex[2] * (t.y[2] - ay[2]) - ey[2] * (t.x[2] - ax[2]);
+    float invArea = 1.0f / area;
+    const bool opaque = t.alpha >= 255; // blended triangles are depth-tested only
+
+    for (int y = by0; y <= by1; ++y) {
+        float py = y + 0.5f;
+        float px = bx0 + 0.5f;
+        float w[3];
+        for (int i = 0; i < 3; ++i) w[i] = ex[i] * (py - ay[i]) - ey[i] * (px - ax[i]);
+        unsigned int* crow = &color_[(size_t)y * width_];
+        float* drow = &depth_[(size_t)y * width_];
+        for (int x = bx0; x <= bx1; ++x, w[0] -= ey[0], w[1] -= ey[1], w[2] -= ey[2]) {
+            bool in0 = w[0] > 0.0f || (w[0] == 0.0f && topLeft[0]);
+            bool in1 = w[1] > 0.0f || (w[1] == 0.0f && topLeft[1]);
+            bool in2 = w[2] > 0.0f || (w[2] == 0.0f && topLeft[2]);
+            if (!(in0 && in1 && in2)) continue;
+            float b0 = w[0] * invArea, b1 = w[1] * invArea, b2 = w[2] * invArea;
+            float z = b0 * t.z[0] + b1 * t.z[1] + b2 * t.z[2];
+            if (z < 0.0f || z > 1.0f || z >= drow[x]) continue;
+            if (opaque) drow[x] = z;
+            float iw = 1.0f / (b0 * t.iw[0] + b1 * t.iw[1] + b2 * t.iw[2]);
+            int r = ClampByte((b0 * t.rgb[0][0] + b1 * t.rgb[1][0] + b2 * t.rgb[2][0]) * iw);
+            int g = ClampByte((b0 * t.rgb[0][1] + b1 * t.rgb[1][1] + b2 * t.rgb[2][1]) * iw);
+            int b = ClampByte((b0 * t.rgb[0][2] + b1 * t.rgb[1][2] + b2 * t.rgb[2][2]) * iw);
+            unsigned int c = (unsigned int)((r << 16) | (g << 8) | b);
+            crow[x] = opaque ? c : Blend(c, crow[x], (unsigned int)t.alpha);
+            ++written;
+        }
+    }
+}
+
+void SoftwareRasterizer::RasterLine(const Line& l, int tx0, int ty0, int tx1, int ty1, size_t& written) {
+    float dx = l.x1 - l.x0, dy = l.y1 - l.y0;
+    auto plot = [&](int x, int y, float z) {
+        if (x < tx0 || x >= tx1 || y < ty0 || y >= ty1) return;
+        if (z < 0.0f || z > 1.0f) return;
+        size_t i = (size_t)y * width_ + x;
+        if (z > depth_[i]) return;
+        if (l.alpha >= 255) {
+            depth_[i] = z;
+            color_[i] = l.color;
+        } else {
+            color_[i] = Blend(l.color, color_[i], (unsigned int)l.alpha);
+        }
+        ++written;
+    };
+    // one pixel per column (x-major) or row (y-major), visiting only this tile's span
+    if (fabsf(dx) >= fabsf(dy)) {
+        if (dx == 0.0f) { plot((int)floorf(l.x0), (int)floorf(l.y0), l.z0); return; }
+        int c0 = std::max(tx0, (int)ceilf(std::min(l.x0, l.x1) - 0.5f));
+        int c1 = std::min(tx1 - 1, (int)floorf(std::max(l.x0, l.x1) - 0.5f));
+        for (int x = c0; x <= c1; ++x) {
+            float s = (x + 0.5f - l.x0) / dx;
+            plot(x, (int)floorf(l.y0 + dy * s), l.z0 + (l.z1 - l.z0) * s);
+        }
+    } else {
+        int r0 = std::max(ty0, (int)ceilf(std::min(l.y0, l.y1) - 0.5f));
+        int r1 = std::min(ty1 - 1, (int)floorf(std::max(l.y0, l.y1) - 0.5f));
+        for (int y = r0; y <= r1; ++y) {
+            float s = (y + 0.5f - l.y0) / dy;
+            plot((int)floorf(l.x0 + dx * s), y, l.z0 + (l.z1 - l.z0) * s);
+        }
+    }
+}
+
+void SoftwareRasterizer::Raster2D(const Prim2D& p, int tx0, int ty0, int tx1, int ty1, size_t& written) {
+    int bx0 = std::max(p.minX, tx0), bx1 = std::min(p.maxX, tx1 - 1);
+    int by0 = std::max(p.minY, ty0), by1 = std::min(p.maxY, ty1 - 1);
+    if (bx0 > bx1 || by0 > by1) return;
+    // 2D overlays ignore and keep the depth buffer
+    for (int y = by0; y <= by1; ++y) {
+        unsigned int* row = &color_[(size_t)y * width_];
+        for (int x = bx0; x <= bx1; ++x) {
+            switch (p.kind) {
+            case Prim2D::Kind::Box:
+                if (!p.fill && x != p.x0 && x != p.x1 - 1 && y != p.y0 && y != p.y1 - 1) continue;
+                row[x] = p.color;
+                break;
+            case Prim2D::Kind::Circle: {
+                int dx = x - p.x0, dy = y - p.y0, d2 = dx * dx + dy * dy, r = p.x1;
+                if (d2 > r * r) continue;
+                if (!p.fill && r > 0 && d2 <= (r - 1) * (r - 1)) continue;
+                row[x] = p.color;
+                break;
+            }
+            case Prim2D::Kind::Texture: {
+                const Texture& tex = textures_[p.texture];
+                unsigned int s = tex.argb[(size_t)(y - p.y0) * tex.width + (x - p.x0)];
+                unsigned int a = s >> 24;
+                if (a == 0) continue;
+                if (a < 255) s = Blend(s, row[x], a);
+                row[x] = s & 0xFFFFFF;
+                break;
+            }
+            }
+            ++written;
+        }
+    }
+}
+
+bool SoftwareRasterizer::SavePPM(const std::string& path) const {
+    if (color_.empty()) return false;
+    FILE* fp = fopen(path.c_str(), "wb");
+    if (!fp) return false;
+    fprintf(fp, "P6\n%d %d\n255\n", width_, height_);
+    std::vector<unsigned char> rgb((size_t)width_ * 3);
+    for (int y = 0; y < height_; ++y) {
+        for (int x = 0; x < width_; ++x) {
+            unsigned int c = color_[(size_t)y * width_ + x];
+            rgb[x * 3 + 0] = (unsigned char)(c >> 16);
+            rgb[x * 3 + 1] = (unsigned char)(c >> 8);
+            rgb[x * 3 + 2] = (unsigned char)c;
+        }
+        fwrite(rgb.data(), 1, rgb.size(), fp);
+    }
+    fclose(fp);
+    return true;
+}
+
+bool SoftwareRasterizer::SavePNG(const std::string& path) const {
+    if (color_.empty()) return false;
+    // scanlines with filter byte 0
+    std::vector<unsigned char> raw;
+    raw.reserve((size_t)height_ * (width_ * 3 + 1));
+    for (int y = 0; y < height_; ++y) {
+        raw.push_back(0);
+        for (int x = 0; x < width_; ++x) {
+            unsigned int c = color_[(size_t)y * width_ + x];
+            raw.push_back((unsigned char)(c >> 16));
+            raw.push_back((unsigned char)(c >> 8));
+            raw.push_back((unsigned char)c);
+        }
+    }
+    // zlib stream of stored deflate blocks (the embedded miniz has no compressor)
+    std::vector<unsigned char> z;
+    z.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    z.push_back(0x78); z.push_back(0x01);
+    size_t pos = 0;
+    do {
+        size_t len = std::min<size_t>(65535, raw.size() - pos);
+        z.push_back(pos + len == raw.size() ? 1 : 0);
+        z.push_back((unsigned char)len); z.push_back((unsigned char)(len >> 8));
+        z.push_back((unsigned char)~len); z.push_back((unsigned char)(~len >> 8));
+        z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+    } while (pos < raw.size());
+    PutBE32(z, (uint32_t)mz_adler32(MZ_ADLER32_INIT, raw.data(), raw.size()));
+
+    std::vector<unsigned char> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    std::vector<unsigned char> ihdr;
+    PutBE32(ihdr, (uint32_t)width_);
+    PutBE32(ihdr, (uint32_t)height_);
+    ihdr.push_back(8); // bit depth
+    ihdr.push_back(2); // RGB
+    ihdr.push_back(0); ihdr.push_back(0); ihdr.push_back(0);
+    PutChunk(png, "IHDR", ihdr);
+    PutChunk(png, "IDAT", z);
+    PutChunk(png, "IEND", std::vector<unsigned char>());
+
+    FILE* fp = fopen(path.c_str(), "wb");
+    if (!fp) return false;
+    bool ok = fwrite(png.data(), 1, png.size(), fp) == png.size();
+    fclose(fp);
+    return ok;
+}
+
+bool SoftwareRasterizer::LoadPNG(const std::string& path, int& width, int& height, std::vector<unsigned int>& pixels) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::vector<unsigned char> png((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    static const unsigned char kSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    if (png.size() < 8 || memcmp(png.data(), kSignature, 8) != 0) return false;
+
+    width = height = 0;
+    std::vector<unsigned char> z;
+    for (size_t pos = 8; pos + 12 <= png.size();) {
+        const uint32_t len = GetBE32(&png[pos]);
+        if (len > png.size() - pos - 12) return false;
+        const unsigned char* type = &png[pos + 4];
+        const unsigned char* data = &png[pos + 8];
+        if (memcmp(type, "IHDR", 4) == 0) {
+            if (len < 13 || data[8] != 8 || data[9] != 2 || data[12] != 0) return false; // 8-bit RGB, not interlaced
+            width = (int)GetBE32(data);
+            height = (int)GetBE32(data + 4);
+        } else if (memcmp(type, "IDAT", 4) == 0) {
+            z.insert(z.end(), data, data + len);
+        } else if (memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+        pos += 12 + len;
+    }
+    if (width <= 0 || height <= 0 || z.size() < 6) return false;
+
+    // the deflate stream sits between the 2-byte zlib header and the adler32 trailer
+    const size_t stride = (size_t)width * 3 + 1;
+    std::vector<unsigned char> raw(stride * height);
+    size_t rawSize = raw.size();
+    if (tinfl_uncompress(raw.data(), &rawSize, z.data() + 2, z.size() - 6) != 0 || rawSize != raw.size()) return false;
+
+    pixels.resize((size_t)width * height);
+    for (int y = 0; y < height; ++y) {
+        const unsigned char* row = &raw[y * stride];
+        if (row[0] != 0) return false; // filtered rows are not supported
+        for (int x = 0; x < width; ++x) {
+            const unsigned char* c = row + 1 + x * 3;
+            pixels[(size_t)y * width + x] = ((unsigned int)c[0] << 16) | ((unsigned int)c[1] << 8) | c[2];
+        }
+    }
+    return true;
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include "RenderBackend.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// SoftwareRasterizer: headless RenderBackend for Linux/CI builds, benchmarks and golden-image tests.
+// Draw calls are transformed, near-clipped and set up as they arrive; EndTarget bins every primitive
+// into screen tiles and rasterizes the tiles in parallel on the JobSystem (depth buffer, per-vertex
+// colour with perspective-correct interpolation, SetBlendAlpha blending). Primitives keep submission
+// order inside a tile, so output is identical for any thread count.
+class SoftwareRasterizer : public RenderBackend {
+public:
+    struct Stats {
+        size_t trianglesSubmitted = 0;
+        size_t trianglesRasterized = 0; // filled triangles left after near clipping and off-screen rejection
+        size_t lines = 0;               // 3D lines, including wireframe edges
+        size_t instancedDraws = 0;      // DrawInstances3D calls
+        size_t instances = 0;
+        size_t primitives2D = 0;
+        size_t pixelsWritten = 0;
+        int tiles = 0;
+        double setupMs = 0.0;  // transform + clipping + triangle setup
+        double binMs = 0.0;
+        double rasterMs = 0.0;
+        double frameMs = 0.0;  // BeginTarget to EndTarget
+    };
+
+    explicit SoftwareRasterizer(int tileSize = 64);
+
+    int BeginTarget(int width, int height) override;
+    void EndTarget() override;
+    void SetCamera(float eyeX, float eyeY, float eyeZ, float targetX, float targetY, float targetZ, float fovY) override;
+    void DrawLine3D(const float a[3], const float b[3], unsigned int color) override;
+    void DrawTriangles3D(const RenderVertex* vertices, size_t count, bool wireframe) override;
+    void DrawLines3D(const RenderVertex* vertices, size_t count) override;
+    void DrawInstances3D(const InstanceGeometry& geometry, const InstanceData* instances, size_t count, const InstanceLight& light) override;
+    void SetBlendAlpha(int alpha) override;
+    void DrawBox(int x0, int y0, int x1, int y1, unsigned int color, bool fill) override;
+    void DrawCircle(int x, int y, int r, unsigned int color, bool fill) override;
+    // Binary PPM/PGM load as-is; other existing files get a 32x32 checker placeholder so sprites
+    // still show up in headless frames.
+    int LoadTexture(const std::string& path) override;
+    void DeleteTexture(int handle) override;
+    void DrawTexture(int x, int y, int handle) override;
+
+    // Clip planes used by SetCamera (kNearZ / kFarZ by default)
+    void SetNearFar(float nearZ, float farZ) { near_ = nearZ; far_ = farZ; }
+    void SetClearColor(unsigned int color) { clearColor_ = color; }
+
+    // Results of the last EndTarget: 0xRRGGBB pixels and [0,1] depth (1 = empty), top row first
+    int GetWidth() const { return width_; }
+    int GetHeight() const { return height_; }
+    const std::vector<unsigned int>& GetColorBuffer() const { return color_; }
+    const std::vector<float>& GetDepthBuffer() const { return depth_; }
+    unsigned int GetPixel(int x, int y) const { return color_[(size_t)y * width_ + x]; }
+    const Stats& GetStats() const { return stats_; }
+
+    bool SavePPM(const std::string& path) const;
+    bool SavePNG(const std::string& path) const;
+    // Reads back a PNG as SavePNG writes it (8-bit RGB, stored deflate blocks, unfiltered rows) into
+    // 0xRRGGBB pixels, top row first; other PNGs are rejected (the embedded miniz only inflates stored blocks)
+    static bool LoadPNG(const std::string& path, int& width, int& height, std::vector<unsigned int>& pixels);
+
+private:
+    struct ClipVertex { float x, y, z, w, r, g, b; };
+    struct Tri {
+        float x[3], y[3], z[3];
+        float iw[3];          // 1 / w
+        float rgb[3][3];      // colour / w
+        int minX, minY, maxX, maxY;
+        int alpha;            // SetBlendAlpha at submission
+    };
+    struct Line {
+        float x0, y0, z0, x1, y1, z1;
+        unsigned int color;
+        int minX, minY, maxX, maxY;
+        int alpha;
+    };
+    struct Prim2D {
+        enum class Kind { Box, Circle, Texture } kind;
+        int x0, y0, x1, y1;   // box / circle center + radius in x1 / texture origin
+        unsigned int color;
+        bool fill;
+        int texture;
+        int minX, minY, maxX, maxY;
+    };
+    struct Texture {
+        int width = 0, height = 0;
+        std::vector<unsigned int> argb;
+        bool alive = false;
+    };
+
+    // primitive ids: kind in the top two bits, index below
+    enum : uint32_t { kTri = 0u << 30, kLine = 1u << 30, kPrim2D = 2u << 30, kKindMask = 3u << 30 };
+
+    ClipVertex Transform(float x, float y, float z, unsigned int color) const;
+    void SetupTriangle(const ClipVertex in[3], std::vector<Tri>& out) const;
+    bool ToScreen(const ClipVertex& a, const ClipVertex& b, Line& out) const;
+    void AddLine(const float a[3], const float b[3], unsigned int color);
+    bool FinishTri(const ClipVertex& a, const ClipVertex& b, const ClipVertex& c, Tri& t) const;
+    void AddPrim2D(const Prim2D& p);
+
+    void RasterTile(int tile, size_t& written);
+    void RasterTri(const Tri& t, int x0, int y0, int x1, int y1, size_t& written);
+    void RasterLine(const Line& l, int x0, int y0, int x1, int y1, size_t& written);
+    void Raster2D(const Prim2D& p, int x0, int y0, int x1, int y1, size_t& written);
+
+    int tileSize_;
+    int width_ = 0, height_ = 0;
+    int tilesX_ = 0, tilesY_ = 0;
+    float near_ = kNearZ, far_ = kFarZ;
+    unsigned int clearColor_ = 0;
+    float viewProj_[4][4] = {};
+    bool inTarget_ = false;
+    int blendAlpha_ = 255;
+
+    std::vector<unsigned int> color_;
+    std::vector<float> depth_;
+
+    std::vector<Tri> tris_;
+    std::vector<Line> lines_;
+    std::vector<Prim2D> prims2D_;
+    std::vector<uint32_t> order_;                 // every primitive id in submission order
+    std::vector<std::vector<Tri>> setupChunks_;   // per-job output of parallel triangle setup
+    std::vector<std::vector<uint32_t>> bins_;     // [binChunk * tileCount + tile]
+    int binChunks_ = 0;
+    std::vector<size_t> tilePixels_;
+
+    std::vector<Texture> textures_;
+
+    Stats stats_;
+    int64_t frameStart_ = 0;
+};
@@ -1,25 +1,39 @@
 #pragma once
 #include "Component.h"
-#include "DxLib.h"
+#include "RenderBackend.h"
 #include <string>
 
 // SpriteRenderer: 摜`悷R|[lgiȈՁj
 struct SpriteRenderer : public Component {
     SpriteRenderer() : handle_(-1) {}
     SpriteRenderer(const std::string& path) : handle_(-1), path_(path) {}
-    ~SpriteRenderer() { if (handle_ != -1) DeleteGraph(handle_); }
+    ~SpriteRenderer() { Release(); }
 
     void Awake() override {
-        if (!path_.empty()) {
-            handle_ = LoadGraph(path_.c_str());
-        }
+        if (!path_.empty()) Load();
     }
 
     void Render() override {
         if (handle_ == -1 || !owner) return;
-        int x = static_cast<int>(owner->transform().x);
-        int y = static_cast<int>(owner->transform().y);
-        DrawGraph(x, y, handle_, TRUE);
+        // handles belong to the backend that loaded them; reload after a backend switch
+        if (backendLifetime_.expired() || backend_ != &RenderBackend::Current()) Load();
+        if (handle_ == -1) return;
+        int x = static_cast<int>(owner->ctransform().x);
+        int y = static_cast<int>(owner->ctransform().y);
+        backend_->DrawTexture(x, y, handle_);
+    }
+
+    void Load() {
+        Release();
+        backend_ = &RenderBackend::Current();
+        backendLifetime_ = backend_->Lifetime();
+        handle_ = backend_->LoadTexture(path_);
+    }
+
+    // A destroyed backend already released its textures
+    void Release() {
+        if (handle_ != -1 && !backendLifetime_.expired()) backend_->DeleteTexture(handle_);
+        handle_ = -1;
     }
 
     std::shared_ptr<Component> Clone() const override {
@@ -28,4 +42,6 @@ struct SpriteRenderer : public Component {
 
     std::string path_;
     int handle_;
+    RenderBackend* backend_ = nullptr;
+    std::weak_ptr<void> backendLifetime_;
 };
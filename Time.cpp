@@ -2,6 +2,7 @@
 
 float Time::deltaTime = 0.0f;
 float Time::time = 0.0f;
+float Time::fixedDeltaTime = 1.0f / 60.0f;
 
 void Time::Update(float dt) {
     deltaTime = dt;
@@ -5,5 +5,7 @@ struct Time {
     static float deltaTime; // Ot[̌oߎ(b)
     static float time;      // N̗݌v(b)
 
+    static float fixedDeltaTime; // fixed physics step (seconds), set by Scene from its step rate
+
     static void Update(float dt);
 };
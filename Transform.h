@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <cmath>
 
 // Transform: ʒuE]EXP[ێȈՍ\
 struct Transform {
@@ -46,4 +47,30 @@ struct Transform {
             outZ = z;
         }
     }
+
+    // World-space directions of the local X/Y/Z axes (rows of Rx*Ry*Rz, DxLib row-vector order)
+    void GetAxes3D(float axes[3][3]) const {
+        const float deg = 3.14159265f / 180.0f;
+        float cx = cosf(rotationX * deg), sx = sinf(rotationX * deg);
+        float cy = cosf(rotationY * deg), sy = sinf(rotationY * deg);
+        float cz = cosf(rotationZ * deg), sz = sinf(rotationZ * deg);
+        for (int i = 0; i < 3; ++i) {
+            float v[3] = { i == 0 ? 1.0f : 0.0f, i == 1 ? 1.0f : 0.0f, i == 2 ? 1.0f : 0.0f };
+            float y1 = v[1] * cx - v[2] * sx, z1 = v[1] * sx + v[2] * cx;
+            float x2 = v[0] * cy + z1 * sy, z2 = -v[0] * sy + z1 * cy;
+            axes[i][0] = x2 * cz - y1 * sz;
+            axes[i][1] = x2 * sz + y1 * cz;
+            axes[i][2] = z2;
+        }
+    }
+
+    // Local-to-world matrix of what a MeshRenderer draws: m * (v, 1) = axes * (scale * v) + (x, y, z)
+    void GetMatrix3D(float m[3][4]) const {
+        float axes[3][3];
+        GetAxes3D(axes);
+        const float s[3] = { scaleX, scaleY, scaleZ };
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 3; ++c) m[r][c] = axes[c][r] * s[c];
+        m[0][3] = x; m[1][3] = y; m[2][3] = z;
+    }
 };
@@ -0,0 +1,31 @@
+#pragma once
+
+// VectorMath: the DxLib value types the engine core uses (VECTOR, MATRIX, VGet, GetColor), so scenes,
+// meshes and the software renderer also build without DxLib (headless tools, Linux CI). With DxLib the
+// real definitions are used; the fallbacks have the same layout, so mesh artifacts read the same.
+// ENGINE_DXLIB is 1 when DxLib is available; define ENGINE_HEADLESS to build without it regardless.
+#if !defined(ENGINE_HEADLESS) && (!defined(__has_include) || __has_include("DxLib.h"))
+#include "DxLib.h"
+#define ENGINE_DXLIB 1
+#else
+#define ENGINE_DXLIB 0
+
+struct VECTOR {
+    float x, y, z;
+};
+
+struct MATRIX {
+    float m[4][4];
+};
+
+inline VECTOR VGet(float x, float y, float z) {
+    VECTOR v;
+    v.x = x; v.y = y; v.z = z;
+    return v;
+}
+
+// 0xRRGGBB, what DxLib's GetColor returns for 32-bit screens (the RenderBackend colour layout)
+inline unsigned int GetColor(int r, int g, int b) {
+    return ((unsigned int)(r & 0xFF) << 16) | ((unsigned int)(g & 0xFF) << 8) | (unsigned int)(b & 0xFF);
+}
+#endif
@@ -0,0 +1,431 @@
+#pragma once
+#include <cstddef>
+#include <cmath>
+#include "VectorMath.h"
+#include "RenderBackend.h"
+#include "Transform.h"
+#include "ScratchArena.h"
+#include "JobSystem.h"
+#include "MeshPacking.h"
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VERTEXTRANSFORM_SSE 1
+#endif
+#if defined(__AVX__)
+#include <immintrin.h>
+#define VERTEXTRANSFORM_AVX 1
+#endif
+
+// VertexTransform: the CPU side of mesh drawing. Kernels for the 4x4 affine transform and per-vertex
+// Lambert lighting over a mesh's unique vertices and flat (per-face) lighting over the expanded triangle
+// list, bit-identical to the scalar reference functions; ExpandInstances runs them for a whole
+// DrawInstances3D call (MeshRenderer draws are one instance).
+namespace VertexTransform {
+
+// Matrix for normals. Uniform scale only rotates (exactly the input when unrotated);
+// non-uniform scale uses the inverse scale so normals stay perpendicular to the surface.
+inline void NormalMatrix(const Transform& t, float n[3][3]) {
+    float axes[3][3];
+    t.GetAxes3D(axes);
+    float inv[3] = { 1.0f, 1.0f, 1.0f };
+    bool uniform = t.scaleX == t.scaleY && t.scaleY == t.scaleZ;
+    if (!uniform && t.scaleX != 0.0f && t.scaleY != 0.0f && t.scaleZ != 0.0f) {
+        inv[0] = 1.0f / t.scaleX; inv[1] = 1.0f / t.scaleY; inv[2] = 1.0f / t.scaleZ;
+    }
+    for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 3; ++c) n[r][c] = axes[c][r] * inv[c];
+}
+
+// Lambert blend of a base colour towards base * light colour (the MeshRenderer::ApplyLightingToColor formula)
+struct Light {
+    float dir[3];    // towards the light (-light direction)
+    float intensity;
+    float base[3];   // base colour channels
+    float tinted[3]; // base * light colour / 255
+};
+
+inline Light MakeLight(int baseColor, const VECTOR& ldir, float intensity, int lightColor) {
+    Light l;
+    l.dir[0] = -ldir.x; l.dir[1] = -ldir.y; l.dir[2] = -ldir.z;
+    l.intensity = intensity;
+    for (int c = 0; c < 3; ++c) {
+        int shift = 16 - 8 * c;
+        int b = (baseColor >> shift) & 0xFF;
+        l.base[c] = (float)b;
+        l.tinted[c] = b * (((lightColor >> shift) & 0xFF) / 255.0f);
+    }
+    return l;
+}
+
+inline unsigned int ShadeScalar(const Light& l, float nx, float ny, float nz) {
+    float ndotl = 0.0f;
+    float nl = sqrtf(nx * nx + ny * ny + nz * nz);
+    if (nl > 0.0001f) {
+        ndotl = (nx / nl) * l.dir[0] + (ny / nl) * l.dir[1] + (nz / nl) * l.dir[2];
+        if (ndotl < 0.0f) ndotl = 0.0f;
+    }
+    float factor = l.intensity * ndotl;
+    unsigned int rgb = 0;
+    for (int c = 0; c < 3; ++c) {
+        int v = (int)(l.base[c] * (1.0f - factor) + l.tinted[c] * factor);
+        v = v < 0 ? 0 : (v > 255 ? 255 : v);
+        rgb = (rgb << 8) | (unsigned int)v;
+    }
+    return rgb;
+}
+
+// out[i].xyz = m * (in[i], 1). The colour field is overwritten; fill it afterwards.
+inline void TransformPositionsScalar(const float m[3][4], const VECTOR* in, size_t count, RenderVertex* out) {
+    for (size_t i = 0; i < count; ++i) {
+        const VECTOR& v = in[i];
+        out[i].x = m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z + m[0][3];
+        out[i].y = m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z + m[1][3];
+        out[i].z = m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z + m[2][3];
+    }
+}
+
+// out[i].color = lit colour of normal n * normals[i]
+inline void LightVerticesScalar(const Light& l, const float n[3][3], const VECTOR* normals, size_t count, RenderVertex* out) {
+    for (size_t i = 0; i < count; ++i) {
+        const VECTOR& v = normals[i];
+        out[i].color = ShadeScalar(l,
+            n[0][0] * v.x + n[0][1] * v.y + n[0][2] * v.z,
+            n[1][0] * v.x + n[1][1] * v.y + n[1][2] * v.z,
+            n[2][0] * v.x + n[2][1] * v.y + n[2][2] * v.z);
+    }
+}
+
+// Flat shading of a triangle list in place: all three colours of triangle f become the lit colour of
+// its face normal (v1 - v0) x (v2 - v0)
+inline void LightTrianglesScalar(const Light& l, RenderVertex* tris, size_t faceCount) {
+    for (size_t f = 0; f < faceCount; ++f) {
+        RenderVertex* t = tris + f * 3;
+        float e1x = t[1].x - t[0].x, e1y = t[1].y - t[0].y, e1z = t[1].z - t[0].z;
+        float e2x = t[2].x - t[0].x, e2y = t[2].y - t[0].y, e2z = t[2].z - t[0].z;
+        t[0].color = t[1].color = t[2].color =
+            ShadeScalar(l, e1y * e2z - e1z * e2y, e1z * e2x - e1x * e2z, e1x * e2y - e1y * e2x);
+    }
+}
+
+// Unit face normals (v1 - v0) x (v2 - v0), 3 floats per triangle; zero for degenerate triangles
+template <typename Index>
+inline void FaceNormals(const RenderVertex* positions, const Index* indices, size_t faceCount, float* normals) {
+    for (size_t f = 0; f < faceCount; ++f) {
+        const RenderVertex& a = positions[indices[f * 3]];
+        const RenderVertex& b = positions[indices[f * 3 + 1]];
+        const RenderVertex& c = positions[indices[f * 3 + 2]];
+        float e1x = b.x - a.x, e1y = b.y - a.y, e1z = b.z - a.z;
+        float e2x = c.x - a.x, e2y = c.y - a.y, e2z = c.z - a.z;
+        float n[3] = { e1y * e2z - e1z * e2y, e1z * e2x - e1x * e2z, e1x * e2y - e1y * e2x };
+        float len = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        float inv = len > 0.0f ? 1.0f / len : 0.0f;
+        normals[f * 3] = n[0] * inv; normals[f * 3 + 1] = n[1] * inv; normals[f * 3 + 2] = n[2] * inv;
+    }
+}
+
+#if defined(VERTEXTRANSFORM_SSE)
+// VECTOR is 12 bytes: a 16-byte load is fine except on the last element of an array
+inline __m128 LoadVector(const VECTOR* v, bool last) {
+    return last ? _mm_setr_ps(v->x, v->y, v->z, 0.0f) : _mm_loadu_ps(&v->x);
+}
+
+// Column-broadcast multiply, summed in the same order as the scalar code
+inline __m128 MulColumns(const __m128 col[4], __m128 v) {
+    __m128 r = _mm_add_ps(_mm_mul_ps(col[0], _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0))),
+                          _mm_mul_ps(col[1], _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+    r = _mm_add_ps(r, _mm_mul_ps(col[2], _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+    return _mm_add_ps(r, col[3]);
+}
+
+// Four normals (SoA) to packed colours
+inline __m128i Shade4(const Light& l, __m128 nx, __m128 ny, __m128 nz) {
+    __m128 nl = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz)));
+    __m128 valid = _mm_cmpgt_ps(nl, _mm_set1_ps(0.0001f));
+    __m128 ndotl = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_div_ps(nx, nl), _mm_set1_ps(l.dir[0])),
+                                         _mm_mul_ps(_mm_div_ps(ny, nl), _mm_set1_ps(l.dir[1]))),
+                              _mm_mul_ps(_mm_div_ps(nz, nl), _mm_set1_ps(l.dir[2])));
+    ndotl = _mm_and_ps(valid, _mm_max_ps(ndotl, _mm_setzero_ps()));
+    __m128 factor = _mm_mul_ps(_mm_set1_ps(l.intensity), ndotl);
+    __m128 keep = _mm_sub_ps(_mm_set1_ps(1.0f), factor);
+    __m128i rgb = _mm_setzero_si128();
+    for (int c = 0; c < 3; ++c) {
+        __m128 v = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(l.base[c]), keep), _mm_mul_ps(_mm_set1_ps(l.tinted[c]), factor));
+        // clamping before truncation gives the same result as truncate-then-clamp
+        v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(255.0f));
+        rgb = _mm_or_si128(_mm_slli_epi32(rgb, 8), _mm_cvttps_epi32(v));
+    }
+    return rgb;
+}
+#endif
+
+inline void TransformPositions(const float m[3][4], const VECTOR* in, size_t count, RenderVertex* out) {
+#if defined(VERTEXTRANSFORM_SSE)
+    const __m128 col[4] = {
+        _mm_setr_ps(m[0][0], m[1][0], m[2][0], 0.0f), _mm_setr_ps(m[0][1], m[1][1], m[2][1], 0.0f),
+        _mm_setr_ps(m[0][2], m[1][2], m[2][2], 0.0f), _mm_setr_ps(m[0][3], m[1][3], m[2][3], 0.0f),
+    };
+    for (size_t i = 0; i < count; ++i)
+        _mm_storeu_ps(&out[i].x, MulColumns(col, LoadVector(in + i, i + 1 == count)));
+#else
+    TransformPositionsScalar(m, in, count, out);
+#endif
+}
+
+// Morph blend a + (b - a) * t. VECTORs are packed floats, so the arrays are blended as 3 * count floats
+// (8 or 4 at a time); every path rounds the same way.
+inline void LerpPositions(const VECTOR* a, const VECTOR* b, float t, size_t count, VECTOR* out) {
+    if (count == 0) return; // empty arrays may be null
+    const float* fa = &a->x;
+    const float* fb = &b->x;
+    float* fo = &out->x;
+    const size_t n = count * 3;
+    size_t i = 0;
+#if defined(VERTEXTRANSFORM_AVX)
+    const __m256 t8 = _mm256_set1_ps(t);
+    for (; i + 8 <= n; i += 8) {
+        __m256 va = _mm256_loadu_ps(fa + i);
+        _mm256_storeu_ps(fo + i, _mm256_add_ps(va, _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(fb + i), va), t8)));
+    }
+#endif
+#if defined(VERTEXTRANSFORM_SSE)
+    const __m128 t4 = _mm_set1_ps(t);
+    for (; i + 4 <= n; i += 4) {
+        __m128 va = _mm_loadu_ps(fa + i);
+        _mm_storeu_ps(fo + i, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(fb + i), va), t4)));
+    }
+#endif
+    for (; i < n; ++i) fo[i] = fa[i] + (fb[i] - fa[i]) * t;
+}
+
+inline void LightVertices(const Light& l, const float n[3][3], const VECTOR* normals, size_t count, RenderVertex* out) {
+#if defined(VERTEXTRANSFORM_SSE)
+    const __m128 col[4] = {
+        _mm_setr_ps(n[0][0], n[1][0], n[2][0], 0.0f), _mm_setr_ps(n[0][1], n[1][1], n[2][1], 0.0f),
+        _mm_setr_ps(n[0][2], n[1][2], n[2][2], 0.0f), _mm_setzero_ps(),
+    };
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        // the zero fourth column adds nothing, so sums match the scalar code
+        __m128 a = MulColumns(col, LoadVector(normals + i, false));
+        __m128 b = MulColumns(col, LoadVector(normals + i + 1, false));
+        __m128 c = MulColumns(col, LoadVector(normals + i + 2, false));
+        __m128 d = MulColumns(col, LoadVector(normals + i + 3, i + 4 == count));
+        _MM_TRANSPOSE4_PS(a, b, c, d);
+        alignas(16) unsigned int rgb[4];
+        _mm_store_si128((__m128i*)rgb, Shade4(l, a, b, c));
+        for (int k = 0; k < 4; ++k) out[i + k].color = rgb[k];
+    }
+    LightVerticesScalar(l, n, normals + i, count - i, out + i);
+#else
+    LightVerticesScalar(l, n, normals, count, out);
+#endif
+}
+
+inline void LightTriangles(const Light& l, RenderVertex* tris, size_t faceCount) {
+#if defined(VERTEXTRANSFORM_SSE)
+    size_t f = 0;
+    for (; f + 4 <= faceCount; f += 4) {
+        // 4 triangles = 12 consecutive vertices; gather corner k of each into x/y/z lanes
+        RenderVertex* t = tris + f * 3;
+        __m128 p[3][3];
+        for (int k = 0; k < 3; ++k) {
+            __m128 a = _mm_loadu_ps(&t[k].x);
+            __m128 b = _mm_loadu_ps(&t[3 + k].x);
+            __m128 c = _mm_loadu_ps(&t[6 + k].x);
+            __m128 d = _mm_loadu_ps(&t[9 + k].x);
+            _MM_TRANSPOSE4_PS(a, b, c, d); // d: colour bits, unused
+            p[k][0] = a; p[k][1] = b; p[k][2] = c;
+        }
+        __m128 e1x = _mm_sub_ps(p[1][0], p[0][0]), e1y = _mm_sub_ps(p[1][1], p[0][1]), e1z = _mm_sub_ps(p[1][2], p[0][2]);
+        __m128 e2x = _mm_sub_ps(p[2][0], p[0][0]), e2y = _mm_sub_ps(p[2][1], p[0][1]), e2z = _mm_sub_ps(p[2][2], p[0][2]);
+        __m128 nx = _mm_sub_ps(_mm_mul_ps(e1y, e2z), _mm_mul_ps(e1z, e2y));
+        __m128 ny = _mm_sub_ps(_mm_mul_ps(e1z, e2x), _mm_mul_ps(e1x, e2z));
+        __m128 nz = _mm_sub_ps(_mm_mul_ps(e1x, e2y), _mm_mul_ps(e1y, e2x));
+        alignas(16) unsigned int rgb[4];
+        _mm_store_si128((__m128i*)rgb, Shade4(l, nx, ny, nz));
+        for (int k = 0; k < 4; ++k) t[k * 3].color = t[k * 3 + 1].color = t[k * 3 + 2].color = rgb[k];
+    }
+    LightTrianglesScalar(l, tris + f * 3, faceCount - f);
+#else
+    LightTrianglesScalar(l, tris, faceCount);
+#endif
+}
+
+// Work smaller than this many vertices stays on the calling thread
+const size_t kVerticesPerJob = 16384;
+
+// Vertices one instance expands to: 2 per unique edge for wireframes, 3 per triangle otherwise
+inline size_t ExpandedVertexCount(const InstanceGeometry& g) {
+    return g.wireframe ? g.edgeCount * 2 : g.indexCount / 3 * 3;
+}
+
+// Quantized positions go through the float transform with the dequantization folded into the matrix:
+// m * (offset + q * scale) = m' * q
+inline void FoldDequantize(const float m[3][4], const float offset[3], const float scale[3], float out[3][4]) {
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) out[r][c] = m[r][c] * scale[c];
+        out[r][3] = m[r][0] * offset[0] + m[r][1] * offset[1] + m[r][2] * offset[2] + m[r][3];
+    }
+}
+
+// Packed streams are widened to floats this many vertices at a time, on the stack
+const size_t kDecodeBlock = 256;
+
+// Transform (and with normals, light) vertices [begin, end) of one instance
+inline void ShadeVertices(const InstanceGeometry& g, const InstanceData& inst, const Light& l, size_t begin, size_t end, RenderVertex* transformed) {
+    if (!g.quantizedPositions && !g.octNormals) {
+        TransformPositions(inst.model, reinterpret_cast<const VECTOR*>(g.positions) + begin, end - begin, transformed + begin);
+        if (g.normals) LightVertices(l, inst.normal, reinterpret_cast<const VECTOR*>(g.normals) + begin, end - begin, transformed + begin);
+        return;
+    }
+    float qm[3][4];
+    if (g.quantizedPositions) FoldDequantize(inst.model, g.positionOffset, g.positionScale, qm);
+    VECTOR block[kDecodeBlock];
+    for (size_t b = begin; b < end; b += kDecodeBlock) {
+        const size_t n = std::min(end - b, kDecodeBlock);
+        if (g.quantizedPositions) {
+            const uint16_t* q = g.quantizedPositions + b * 3;
+            for (size_t i = 0; i < n; ++i) {
+                block[i].x = (float)q[i * 3]; block[i].y = (float)q[i * 3 + 1]; block[i].z = (float)q[i * 3 + 2];
+            }
+            TransformPositions(qm, block, n, transformed + b);
+        } else {
+            TransformPositions(inst.model, reinterpret_cast<const VECTOR*>(g.positions) + b, n, transformed + b);
+        }
+        if (g.octNormals) {
+            for (size_t i = 0; i < n; ++i) MeshPacking::DecodeOctahedral(g.octNormals[b + i], block[i].x, block[i].y, block[i].z);
+            LightVertices(l, inst.normal, block, n, transformed + b);
+        } else if (g.normals) {
+            LightVertices(l, inst.normal, reinterpret_cast<const VECTOR*>(g.normals) + b, n, transformed + b);
+        }
+    }
+}
+
+inline bool HasNormals(const InstanceGeometry& g) { return g.normals || g.octNormals; }
+
+// Triangles [begin, end) into out (3 vertices each, indexed from triangle 0); flat-shaded without normals
+template <typename Index>
+inline void EmitTriangles(const InstanceGeometry& g, const Index* idx, const Light& l, const RenderVertex* transformed, size_t begin, size_t end, RenderVertex* out) {
+    // small blocks so flat shading reads the triangles while they are still in cache
+    for (size_t block = begin; block < end; block += 64) {
+        size_t blockEnd = std::min(end, block + 64);
+        for (size_t f = block; f < blockEnd; ++f) {
+            RenderVertex* t = out + f * 3;
+            t[0] = transformed[idx[f * 3]];
+            t[1] = transformed[idx[f * 3 + 1]];
+            t[2] = transformed[idx[f * 3 + 2]];
+        }
+        if (!HasNormals(g)) LightTriangles(l, out + block * 3, blockEnd - block);
+    }
+}
+
+inline void EmitTriangles(const InstanceGeometry& g, const Light& l, const RenderVertex* transformed, size_t begin, size_t end, RenderVertex* out) {
+    if (g.indices16) EmitTriangles(g, g.indices16, l, transformed, begin, end, out);
+    else EmitTriangles(g, g.indices, l, transformed, begin, end, out);
+}
+
+inline void FaceNormals(const InstanceGeometry& g, const RenderVertex* transformed, size_t begin, size_t end, float* normals) {
+    if (g.indices16) FaceNormals(transformed, g.indices16 + begin * 3, end - begin, normals + begin * 3);
+    else FaceNormals(transformed, g.indices + begin * 3, end - begin, normals + begin * 3);
+}
+
+inline int EdgeFace(int f) { return f; }
+inline int EdgeFace(uint16_t f) { return f == 0xFFFF ? -1 : (int)f; }
+
+// Edges [begin, end) into out (2 vertices each). Without normals an edge is lit by the sum of its
+// triangles' unit face normals (faceNormals, from FaceNormals); otherwise it keeps its first vertex's colour.
+template <typename Index>
+inline void EmitEdges(const Index* edges, const Light& l, const RenderVertex* transformed, const float* faceNormals,
+                      size_t begin, size_t end, RenderVertex* out) {
+    for (size_t i = begin; i < end; ++i) {
+        const Index* e = edges + i * 4;
+        RenderVertex* t = out + i * 2;
+        t[0] = transformed[e[0]];
+        t[1] = transformed[e[1]];
+        if (faceNormals) {
+            const float* n0 = faceNormals + e[2] * 3;
+            float n[3] = { n0[0], n0[1], n0[2] };
+            const int face1 = EdgeFace(e[3]);
+            if (face1 >= 0) {
+                const float* n1 = faceNormals + face1 * 3;
+                n[0] += n1[0]; n[1] += n1[1]; n[2] += n1[2];
+            }
+            t[0].color = ShadeScalar(l, n[0], n[1], n[2]);
+        }
+    }
+}
+
+inline void EmitEdges(const InstanceGeometry& g, const Light& l, const RenderVertex* transformed, const float* faceNormals,
+                      size_t begin, size_t end, RenderVertex* out) {
+    if (g.edges16) {
+        EmitEdges(g.edges16, l, transformed, faceNormals, begin, end, out);
+    } else if (g.edgeVertices) {
+        for (size_t i = begin; i < end; ++i) {
+            out[i * 2] = transformed[g.edgeVertices[i * 2]];
+            out[i * 2 + 1] = transformed[g.edgeVertices[i * 2 + 1]];
+        }
+    } else {
+        EmitEdges(g.edges, l, transformed, faceNormals, begin, end, out);
+    }
+}
+
+// Transform, light and expand `count` instances into out (ExpandedVertexCount(g) vertices per instance).
+// A single instance is split over vertex / triangle ranges on the JobSystem; many instances are split
+// by instance, each job using its own thread's scratch arena.
+inline void ExpandInstances(const InstanceGeometry& g, const InstanceData* instances, size_t count, const InstanceLight& il, RenderVertex* out) {
+    const VECTOR ldir = VGet(il.dirX, il.dirY, il.dirZ);
+    const size_t faces = g.indexCount / 3;
+    const size_t perInstance = ExpandedVertexCount(g);
+    const bool flatEdges = g.wireframe && !HasNormals(g);
+    JobSystem& jobs = JobSystem::Instance();
+
+    if (count == 1) {
+        const InstanceData& inst = instances[0];
+        const Light l = MakeLight((int)inst.color, ldir, il.intensity, (int)il.color);
+        ScratchArena& arena = ScratchArena::ForThread();
+        ScratchArena::Scope scope(arena);
+        RenderVertex* transformed = arena.Allocate<RenderVertex>(g.vertexCount);
+        jobs.ParallelFor(g.vertexCount, kVerticesPerJob, [&](size_t begin, size_t end, int) {
+            ShadeVertices(g, inst, l, begin, end, transformed);
+        });
+        if (!g.wireframe) {
+            jobs.ParallelFor(faces, kVerticesPerJob / 3, [&](size_t begin, size_t end, int) {
+                EmitTriangles(g, l, transformed, begin, end, out);
+            });
+            return;
+        }
+        float* faceNormals = flatEdges ? arena.Allocate<float>(faces * 3) : nullptr;
+        if (faceNormals) {
+            jobs.ParallelFor(faces, kVerticesPerJob / 3, [&](size_t begin, size_t end, int) {
+                FaceNormals(g, transformed, begin, end, faceNormals);
+            });
+        }
+        jobs.ParallelFor(g.edgeCount, kVerticesPerJob / 2, [&](size_t begin, size_t end, int) {
+            EmitEdges(g, l, transformed, faceNormals, begin, end, out);
+        });
+        return;
+    }
+
+    const size_t perJob = std::max<size_t>(1, kVerticesPerJob / std::max<size_t>(1, perInstance));
+    jobs.ParallelFor(count, perJob, [&](size_t begin, size_t end, int) {
+        ScratchArena& arena = ScratchArena::ForThread();
+        ScratchArena::Scope scope(arena);
+        RenderVertex* transformed = arena.Allocate<RenderVertex>(g.vertexCount);
+        float* faceNormals = flatEdges ? arena.Allocate<float>(faces * 3) : nullptr;
+        for (size_t i = begin; i < end; ++i) {
+            const Light l = MakeLight((int)instances[i].color, ldir, il.intensity, (int)il.color);
+            RenderVertex* dst = out + i * perInstance;
+            ShadeVertices(g, instances[i], l, 0, g.vertexCount, transformed);
+            if (!g.wireframe) {
+                EmitTriangles(g, l, transformed, 0, faces, dst);
+            } else {
+                if (faceNormals) FaceNormals(g, transformed, 0, faces, faceNormals);
+                EmitEdges(g, l, transformed, faceNormals, 0, g.edgeCount, dst);
+            }
+        }
+    });
+}
+
+} // namespace VertexTransform
@@ -16,6 +16,7 @@
 #include "MeshRenderer.h"
 #include "CameraComponent.h"
 #include "LightComponent.h"
+#include "Benchmarks.h"
 
 #include <memory>
 #include <string>
@@ -24,17 +25,22 @@
 struct MoveComponent : public Component {
     float vx, vy, vz;
     MoveComponent(float _vx = 0, float _vy = 0, float _vz = 0) : vx(_vx), vy(_vy), vz(_vz) {}
-    void Update() override {
+    // moved on the fixed physics step so collisions don't depend on frame rate
+    void FixedUpdate() override {
         if (!owner) return;
-        owner->transform().x += vx * Time::deltaTime;
-        owner->transform().y += vy * Time::deltaTime;
-        owner->transform().z += vz * Time::deltaTime;
+        owner->transform().x += vx * Time::fixedDeltaTime;
+        owner->transform().y += vy * Time::fixedDeltaTime;
+        owner->transform().z += vz * Time::fixedDeltaTime;
     }
     std::shared_ptr<Component> Clone() const override { return std::make_shared<MoveComponent>(vx, vy, vz); }
 };
 
-int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
+int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR cmdLine, int)
 {
+    // benchmark / self-check flags run without opening the editor (see Benchmarks.h)
+    int benchResult = Benchmarks::Run(cmdLine ? cmdLine : "");
+    if (benchResult >= 0) return benchResult;
+
     // EBhETCYݒiKvȂvj
     const int screenW = 1280;
     const int screenH = 720;
@@ -1,4 +1,5 @@
 #include "ModelLoader.h"
+#include "../MeshOptimizer.h"
 #include <iostream>
 
 #if __has_include(<assimp/Importer.hpp>)
@@ -183,6 +184,9 @@ std::shared_ptr<Mesh> ModelLoader::LoadModel(const std::string& path) {
         }
     }
 
+    MeshOptimizer::Optimize(*outMesh);
+    outMesh->ComputeBounds();
+    outMesh->BuildEdges();
     return outMesh;
 }
 
@@ -223,7 +223,8 @@ static int tinfl_decompress_mem_to_mem(void *pOut_buf, size_t *pOut_buf_len, con
             if (out_ofs + len > out_cap) return TINFL_DECOMPRESS_MEM_TO_MEM_FAILED;
             memcpy(out + out_ofs, br.src + br.src_ofs, len);
             out_ofs += len;
-            src_ofs += br.src_ofs; // advance original
+            br.src_ofs += len;
+            src_ofs += br.src_ofs; // advance original past the block data
             if (final) break;
             continue;
         } else {